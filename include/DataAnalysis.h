@@ -20,6 +20,7 @@ class TGeoMatrix;
 class RunConfig;
 class Track;
 class ParticleManifest;
+class SpinData;
 class Point;
 
 namespace Analysis {
@@ -86,6 +87,14 @@ namespace Analysis {
       //_____________________________________________________________________________
       bool CalculateT2(TFile& dataFile, std::vector<std::string> states, double& t2, double& t2error);
       //_____________________________________________________________________________
+      bool CalculateT2(const std::vector<const SpinData*>& spinData, const double runTime, const double spinMeasInterval, double& t2, double& t2error);
+      //_____________________________________________________________________________
+      void CalculatePhases(const SpinData& data, std::vector<Analysis::Polarisation::Coords>& phases);
+      //_____________________________________________________________________________
+      void FillAlphaGraph(TGraph& alphaT2, std::vector<std::vector<Analysis::Polarisation::Coords> >& phase_data, const std::vector<double>& times);
+      //_____________________________________________________________________________
+      bool FitT2(TGraph& alphaT2, const double runTime, double& t2, double& t2error);
+      //_____________________________________________________________________________
       TGraph* CreateT2AlphaGraph(std::vector<TDirectory*> stateDirs, double runTime, unsigned int intervals);
       //_____________________________________________________________________________
       void PlotPhaseAngleSnapShots(std::vector<std::vector<Analysis::Polarisation::Coords> >& phase_data, const unsigned int intervals);
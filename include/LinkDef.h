@@ -56,9 +56,11 @@
 #pragma link C++ class Track+;
 #pragma link C++ class Point+;
 #pragma link C++ class FieldMap+;
-#pragma link C++ class MagFieldMap+;
+#pragma link C++ class MagFieldMap-;
+#pragma link C++ class GridMagFieldMap+;
 #pragma link C++ class KDTree+;
 #pragma link C++ class KDTreeNode+;
+#pragma link C++ class FlatKDTree+;
 #pragma link C++ class FieldVertex+;
 #pragma link C++ class VertexStack+;
 #pragma link C++ class FieldObserver+;
@@ -69,10 +71,13 @@
 #pragma link C++ class Listing+;
 #pragma link C++ class TRandom3a;
 #pragma link C++ class TRandom3State+;
+#pragma link C++ class TRandomPhilox+;
 #pragma link C++ class PopulationObserver+;
 #pragma link C++ class PopulationData+;
 #pragma link C++ class MagFieldDipole+;
 #pragma link C++ class MagFieldLoop+;
+#pragma link C++ class TrajectoryObserver+;
+#pragma link C++ class Trajectory+;
 
 // ----------------------------------------------------------------------
 // -- Elements and Materials Namespaces are used for defining common material properties
@@ -135,6 +140,10 @@
 #pragma link C++ function Analysis::Polarisation::PlotSpinPolarisation(const std::string, const std::vector<int>, TTree*, const RunConfig&);
 #pragma link C++ function Analysis::Polarisation::PlotField(const std::string, const std::vector<int>, TTree*, const RunConfig&);
 #pragma link C++ function Analysis::Polarisation::CalculateT2(TFile&, std::vector<std::string>, double&, double&);
+#pragma link C++ function Analysis::Polarisation::CalculateT2(const std::vector<const SpinData*>&, const double, const double, double&, double&);
+#pragma link C++ function Analysis::Polarisation::CalculatePhases(const SpinData&, std::vector<Analysis::Polarisation::Coords>&);
+#pragma link C++ function Analysis::Polarisation::FillAlphaGraph(TGraph&, std::vector<std::vector<Analysis::Polarisation::Coords> >&, const std::vector<double>&);
+#pragma link C++ function Analysis::Polarisation::FitT2(TGraph&, const double, double&, double&);
 #pragma link C++ function Analysis::Polarisation::CreateT2AlphaGraph(std::vector<TDirectory*>, double, unsigned int);
 #pragma link C++ function Analysis::Polarisation::PlotPhaseAngleSnapShots(std::vector<std::vector<Analysis::Polarisation::Coords> >& , const unsigned int );
 #pragma link C++ function Analysis::Polarisation::PlotT2_vs_Runs(const std::string, const std::string);
@@ -13,6 +13,18 @@ namespace States
    const std::string decayed = "decayed";
    const std::string lost = "lost";
    const std::string anomalous = "anomalous";   
+   
+   // -- Numeric code for each state, for storing in plain columns of the output tree
+   enum Code {kUnknown = 0, kPropagating, kAbsorbed, kDetected, kDecayed, kLost, kAnomalous};
+   inline int StateCode(const std::string& state) {
+      if (state == propagating) return kPropagating;
+      if (state == absorbed) return kAbsorbed;
+      if (state == detected) return kDetected;
+      if (state == decayed) return kDecayed;
+      if (state == lost) return kLost;
+      if (state == anomalous) return kAnomalous;
+      return kUnknown;
+   }
 }
 
 #endif
@@ -19,6 +19,7 @@ protected:
    static Double_t TimeFromOutsideS(const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t dx, const Double_t dy, const Double_t dz, const Double_t *origin, const Bool_t onBoundary);
    
    
+   static Bool_t ReachesBoxS(const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t dx, const Double_t dy, const Double_t dz, const Double_t *origin, const Double_t stepTime);
    static Bool_t IsNextPointOnBox(const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t* boundary, const Double_t t);
    static Double_t SmallestInsideTime(const Int_t solutions, Double_t* roots, const Bool_t onBoundary);
    static Double_t SmallestOutsideTime(const Int_t solutions, Double_t* roots, const Bool_t onBoundary, const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t* boundary);
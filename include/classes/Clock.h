@@ -4,17 +4,17 @@
 #ifndef CLOCK_H
 #define CLOCK_H
 
-#include <string>
-#include <vector>
-
 class RunConfig;
 
 class Clock
 {
+public:
+   // -- Maximum number of external events that a single clock can schedule
+   static const int kMaxEvents = 16;
+   
 private:
    // -- Members
-   static Clock* fgClock;
-   
+   // (Each particle is given its own Clock, which is passed down through its propagation)
    
    // -- Times
    double fTime;
@@ -22,38 +22,34 @@ private:
    double fMaxStepInterval;
    
    // -- Event intervals
-   typedef struct EventTimer {
+   struct EventTimer {
       // EventTimer struct is just a convenient way to encapsulate the information
       // about any external events (think an Observer's periodic measurements)
       // needed by the clock to schedule them
-      std::string fEventName;
       double fMeasInterval;
       double fPreviousMeas;
-      // Constuctor
-      EventTimer(std::string name, double interval, double prevMeas) : fEventName(name), fMeasInterval(interval), fPreviousMeas(prevMeas) { }
    };
-   // List of all External Events
-   std::vector<EventTimer> fExternalEvents;
+   // List of all External Events. Held in a fixed array so that copying or
+   // resetting a clock never allocates
+   EventTimer fExternalEvents[kMaxEvents];
+   int fNumEvents;
    
-   // -- Hidden Constructor
+public:
+   // -- Constructors
    Clock();
+   explicit Clock(const RunConfig& runConfig);
    Clock(const Clock&);
    Clock& operator=(const Clock&);
-   
-public:
-   // -- Singleton
-   static Clock* 	Instance();
-   
-   // -- Destructor
-   virtual ~Clock();
+   ~Clock();
    
    // -- Methods
    bool     Initialise(const RunConfig& runConfig);
-   void     ScheduleEvent(const std::string name, const double measFrequency, const double prevMeasureTime = 0.0);
-   bool     CancelEvent(const std::string name);
+   bool     ScheduleEvent(const double measInterval, const double prevMeasureTime = 0.0);
    void     Tick(double interval) {fTime += interval;}
-   double   GetTimeToNextEvent();
+   double   GetTimeToNextEvent() {return this->GetTimeToNextEventWithin(fMaxStepInterval);}
+   double   GetTimeToNextEventWithin(const double maxInterval);
    double   GetTime() const {return fTime;}
+   int      GetNumEvents() const {return fNumEvents;}
    void     Reset();
    
 };
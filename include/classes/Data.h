@@ -16,8 +16,20 @@ class TGeoManager;
 class Experiment;
 class RunConfig;
 class Particle;
+class Clock;
+class ParticleReader;
 
 class Data : public TNamed {
+public:
+   // -- Output buffering. Worker threads cannot write to the output tree themselves, so they
+   // -- hold copies of their output in a buffer that the Data owning the output file writes out
+   struct BufferedObject {
+      std::string fBranchName;
+      std::string fState;      // Manifest listing to add a particle to (empty if not a particle)
+      TObject* fObject;
+   };
+   typedef std::vector<BufferedObject> ObjectBuffer;
+   
 private:
    // -- Data Files
    TFile *fInputFile;
@@ -26,7 +38,12 @@ private:
    TTree *fOutputTree;
    TBranch* fInputBranch;
    Particle* fCurrentParticle;
+   ParticleReader* fReader; //! Hands out the particles selected for propagation
+   std::vector<int> fCompletedIndexes; //! Input indexes already propagated by a run being resumed
    ParticleManifest* fOutputManifest;
+   ObjectBuffer* fOutputBuffer; //! If set, tree output is copied here instead of the tree
+   Bool_t fColumnarOutput; //! Whether to write each particle's plain columns next to its object
+   Bool_t fWriteNewCycles; //! Whether objects written to file keep their previous cycles, while checkpointing
    
    // -- Observers
    typedef std::multimap<std::string, Observer*> ObserverList;
@@ -35,11 +52,13 @@ private:
    
    void           PurgeObservers();
    void           AddObserver(const std::string category, const std::string subject, Observer* observer);
-   void           AttachObservers(ObserverList& observerList, Particle* particle);
+   void           AttachObservers(ObserverList& observerList, Particle* particle, Clock& clock);
+   void           WriteParticleToTree(Particle* particle, const std::string& branchName, const std::string& state);
       
          
    ParticleManifest* ReadInParticleManifest(TFile* file) const;
    TTree*            ReadInParticleTree(TFile* file) const;
+   Bool_t            ReopenOutput(const std::string& outputFileName);
    
    bool  CheckSelectedIndexList(std::vector<int>& selectedIndexes, std::vector<int>& availableIndexes) const;
    bool  CopyAllParticles(TBranch* inputBranch, TBranch* outputBranch);
@@ -51,7 +70,7 @@ public:
    Data(const Data& other);
    virtual ~Data(void);
    
-   Bool_t               Initialise(const RunConfig& runConfig);
+   Bool_t               Initialise(const RunConfig& runConfig, const Bool_t resume = kFALSE);
    void                 CreateObservers(const RunConfig& runConfig, Experiment& experiment);
    std::vector<int>     GetSelectedParticleIndexes(const ParticleManifest& manifest, const RunConfig& runConfig) const;
    
@@ -62,10 +81,16 @@ public:
    // Get a Particle
    std::vector<int>     GetListOfParticlesToLoad(const RunConfig& runConfig);
    Particle* const      RetrieveParticle(unsigned int index);
+   Bool_t               PrefetchParticles(const std::vector<int>& indexes);
+   Particle*            NextParticle();
    
    // Observers
-   void                 RegisterObservers(Particle* particle);
+   void                 RegisterObservers(Particle* particle, Clock& clock);
    void                 ResetObservers();
+   void                 MergeObservers(const Data& other);
+   void                 ResetRunObservers();
+   void                 WriteRunObservers();
+   void                 RestoreRunObservers();
    
    // Particle Counters
    Bool_t               ChecksOut() const;
@@ -81,7 +106,14 @@ public:
    // Saving
    void                 Export();
    int                  WriteObjectToFile(TObject* object);
+   TObject*             ReadObjectFromFile(const char* name);
    int                  WriteObjectToTree(TObject* object, const char* branchName);
+   void                 SetOutputBuffer(ObjectBuffer* buffer) {fOutputBuffer = buffer;}
+   
+   // Checkpoints
+   Bool_t               Checkpoint(const std::vector<int>& completedIndexes);
+   const std::vector<int>& CompletedIndexes() const {return fCompletedIndexes;}
+   Bool_t               WriteBufferToTree(ObjectBuffer& buffer);
    
    ClassDef(Data, 1) // UCN Data Object
 };
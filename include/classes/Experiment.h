@@ -4,10 +4,14 @@
 #ifndef ROOT_Experiment
 #define ROOT_Experiment
 
+#include <map>
+
 #include "TNamed.h"
 #include "Observable.h"
 #include "TGeoManager.h"
 #include "FieldManager.h"
+#include "VolumeTree.h"
+#include "VolumeGravity.h"
 
 ////////////////////////////////////////////////////////////////////////////
 //                                                                        //
@@ -22,9 +26,14 @@ class Experiment : public TNamed
 protected:
    FieldManager     fFieldManager;
    TGeoManager*     fGeoManager;
+   std::map<const TGeoVolume*, VolumeTree> fVolumeTrees; //! Daughter search tree of each volume
+   std::map<const TGeoVolume*, VolumeGravity> fVolumeGravity; //! Gravity in each volume's frame
    
    // Geometry Building
    Bool_t               BuildGeometry(const RunConfig& runConfig);
+   void                 BuildVolumeTrees();
+   void                 BuildVolumeGravity();
+   void                 AddVolumeGravity(const TGeoVolume& volume, const Double_t* field);
    
 public:
    // -- constructors
@@ -42,6 +51,8 @@ public:
    void                 ClearManager() {fGeoManager = 0;}
    TGeoManager*         GetGeoManager() const {return fGeoManager;}
    TGeoNavigator*       GetNavigator() const  {return fGeoManager->GetCurrentNavigator();}
+   const VolumeTree*    GetVolumeTree(const TGeoVolume* volume) const;
+   const VolumeGravity* GetVolumeGravity(const TGeoVolume* volume) const;
    
    // FieldManager Interface
    const FieldManager&     GetFieldManager() const {return fFieldManager;}
@@ -26,8 +26,6 @@ private:
    const TGeoMatrix* fFieldMatrix;
    
 protected:
-   const TGeoMatrix& GetMatrix() const {return *fFieldMatrix;}
-    
    FieldVertex ConvertToGlobalFrame(const FieldVertex& point) const;
    FieldVertex ConvertToLocalFrame(const FieldVertex& point) const;
    
@@ -37,7 +35,12 @@ public:
    Field(const Field&);
    virtual ~Field();
    
+   const TGeoShape& GetShape() const {return *fFieldShape;}
+   const TGeoMatrix& GetMatrix() const {return *fFieldMatrix;}
+   
+   virtual Bool_t Initialise();
    virtual Bool_t Contains(const TVector3& point) const;
+   void BoundingBox(Double_t* lower, Double_t* upper) const;
    virtual const TVector3 GetField(const Point& point) const = 0;
    
    ClassDef(Field, 1)              // Abstract base field class
@@ -7,6 +7,7 @@
 #include "TNamed.h"
 #include <string>
 #include <map>
+#include <vector>
 #include <iostream>
 #include "TVector3.h"
 
@@ -22,16 +23,22 @@ using std::string;
 using std::map;
 
 class Point;
+class VolumeTree;
 
 class FieldArray : public TNamed, public Observable
 {
 protected:
    typedef map<string, Field*> FieldContainer;
    FieldContainer fFieldList;
+   Bool_t fSumOverlapping;                // Whether a point in several fields sees their sum, or just the first
+   std::vector<Field*> fRegionFields;     //! Fields in the order of fFieldList, as indexed by fRegionTree
+   VolumeTree* fRegionTree;               //! Bounding volume hierarchy over the fields' bounding boxes
    
    // Don't allow copy construction - otherwise we run into problems with ownership of pointers
    FieldArray(const FieldArray&);
    
+   void BuildRegionIndex();
+   
 private:
    void PurgeFields();
    
@@ -44,10 +51,12 @@ public:
    
    // -- methods
    void AddField(Field* field);
+   Bool_t Initialise();
+   void SetSumOverlapping(const Bool_t sum) {fSumOverlapping = sum;}
    const TVector3 GetField(const Point& point, const string = "") const;
    virtual const TVector3 GetMagField(const Point& point, const TVector3& velocity, const std::string = "") const = 0;
    
-   ClassDef(FieldArray, 1)
+   ClassDef(FieldArray, 2)
 };
 
 #endif /* FIELDARRAY_H */
@@ -0,0 +1,44 @@
+// FieldLookupContext class
+// Per-thread record of a track's recent lookups in each field map
+
+#ifndef __FIELD_LOOKUP_CONTEXT_H
+#define __FIELD_LOOKUP_CONTEXT_H
+
+#include "TVector3.h"
+
+//--------------------------------------------------------------------------
+//--
+//--  FieldLookupContext
+//--  What a field map remembers of the last lookup a track made in it: the
+//--  reading itself, the kd-tree leaf that held the lookup point and the grid
+//--  values around the last grid cell. Consecutive lookups along a trajectory
+//--  fall in the same leaf or cell, so a map starts its next search from there.
+//--  Each thread keeps one context per field map, and forgets them all as it
+//--  begins a new track, and frees them as it exits. Lookups served from the
+//--  context are counted in the thread's RunStatistics.
+//--
+//--------------------------------------------------------------------------
+
+struct FieldLookupContext
+{
+   // -- Grid values held for the last cell: 3 components of 4x4x4 points, for tricubic interpolation
+   static const Int_t kMaxCellValues = 3*64;
+   
+   const void* fMap;                      // Field map the context belongs to
+   Bool_t fHasReading;                    // Whether fPosition and fField hold the last reading
+   Double_t fPosition[3];
+   TVector3 fField;
+   Int_t fLeaf;                           // kd-tree leaf that held the last lookup point, or -1
+   Long64_t fCell;                        // Grid cell whose values are held in fCellValues, or -1
+   Double_t fCellValues[kMaxCellValues];
+   
+   FieldLookupContext(const void* map = NULL);
+   void Forget();
+   
+   // -- The calling thread's context for the field map
+   static FieldLookupContext& ForMap(const void* map);
+   // -- Forget every lookup made by the calling thread, as it begins a new track
+   static void BeginTrack();
+};
+
+#endif
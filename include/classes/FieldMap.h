@@ -5,11 +5,13 @@
 #define ROOT_FieldMap
 
 #include <string>
+#include <vector>
+#include <ostream>
 
 #include "TNamed.h"
 #include "TVector3.h"
 #include "MagField.h"
-#include "KDTree.h"
+#include "FlatKDTree.h"
 #include "FieldVertex.h"
 
 ////////////////////////////////////////////////////////////////////////////
@@ -39,10 +41,21 @@ public:
 ////////////////////////////////////////////////////////////////////////////
 class Particle;
 class Run;
+struct FieldLookupContext;
 
 class MagFieldMap : public FieldMap, public MagField {
 private:
-   KDTree* fTree;
+   FlatKDTree* fTree;      // Written with the map, unless it is mapped from fMapFile
+   std::string fMapFile;   // Binary map the tree is mapped from, if any
+   
+protected:
+   // Number of vertices weighted by each interpolation
+   static const Int_t kNumInterpolatePoints = 6;
+   
+   virtual Bool_t BuildFromVertices(const std::vector<FieldVertex*>& vertices);
+   virtual TVector3 LookUp(const TVector3& position, FieldLookupContext& context) const;
+   const FlatKDTree* GetTree() const {return fTree;}
+   void GetPlacement(Double_t* placement) const;
    
 public:
    MagFieldMap();
@@ -52,10 +65,71 @@ public:
    
    virtual const TVector3 GetField(const Point& point) const;
    virtual Bool_t BuildMap(const std::string& filename);
+   virtual Bool_t Initialise();
+   Bool_t WriteBinaryMap(const std::string& filename) const;
    
    TVector3 Interpolate(const TVector3& position, const Int_t numInterpolatePoints) const;
+   TVector3 Interpolate(const TVector3& position, const Int_t numInterpolatePoints, Int_t& leafHint, Bool_t& hintSufficed) const;
+   
+   ClassDef(MagFieldMap, 2)   // Mag Field Map class
+};
+
+
+////////////////////////////////////////////////////////////////////////////
+//                                                                        //
+// GridMagFieldMap - Field map whose vertices lie on a regular grid in    //
+// the field's local frame. The field is stored in one contiguous array   //
+// and LookUp locates the enclosing cell by index arithmetic, then      //
+// interpolates trilinearly or tricubically. Maps that are not on a grid, //
+// and points outside the grid, fall back to MagFieldMap's kd-tree.       //
+// Baked maps hold only the grid.                                         //
+//                                                                        //
+////////////////////////////////////////////////////////////////////////////
+
+class GridMagFieldMap : public MagFieldMap {
+public:
+   enum Interpolation {kTrilinear, kTricubic};
+   // -- Most grid points a field is baked onto
+   static const Int_t kMaxBakePoints = 4000000;
+   
+private:
+   Int_t fInterpolation;
+   Bool_t fGridDeclared;             // Whether the grid was declared rather than detected
+   Bool_t fIsGrid;                   // Whether the vertices were successfully placed on the grid
+   Double_t fGridLower[3];           // Local coordinates of the first grid point
+   Double_t fGridSpacing[3];
+   Int_t fGridPoints[3];             // Number of grid points along each axis
+   std::vector<Double_t> fGridField; // Bx,By,Bz of point (i,j,k) at 3*((i*ny + j)*nz + k)
+   
+   Bool_t DetectGrid(const std::vector<FieldVertex*>& vertices);
+   Bool_t FillGrid(const std::vector<FieldVertex*>& vertices);
+   void BuildGrid(const std::vector<FieldVertex*>& vertices);
+   void PrintGrid(std::ostream& out) const;
+   Bool_t InterpolateGrid(const Double_t* local, TVector3& field, FieldLookupContext& context) const;
+   const Double_t* GridField(const Int_t i, const Int_t j, const Int_t k) const;
+   
+protected:
+   virtual Bool_t BuildFromVertices(const std::vector<FieldVertex*>& vertices);
+   virtual TVector3 LookUp(const TVector3& position, FieldLookupContext& context) const;
+   
+public:
+   GridMagFieldMap();
+   GridMagFieldMap(const std::string& name, const TGeoShape* fieldShape, const TGeoMatrix* fieldPosition,
+                   const Interpolation interpolation = kTrilinear);
+   GridMagFieldMap(const GridMagFieldMap&);
+   virtual ~GridMagFieldMap();
+   
+   virtual Bool_t Initialise();
+   
+   void DeclareGrid(const Double_t* lower, const Double_t* spacing, const Int_t* numPoints);
+   Bool_t IsGrid() const {return fIsGrid;}
+   void ReportInterpolationError(std::ostream& out) const;
+   
+   static GridMagFieldMap* Bake(const MagField& field, const Double_t tolerance,
+                                const Interpolation interpolation = kTricubic,
+                                const Int_t maxPoints = kMaxBakePoints);
    
-   ClassDef(MagFieldMap, 1)   // Mag Field Map class
+   ClassDef(GridMagFieldMap, 1)   // Regular Grid Mag Field Map class
 };
 
 #endif
@@ -0,0 +1,108 @@
+// FlatKDTree class
+// Array-backed kd-tree over field vertices, with bucketed leaves
+
+#ifndef __FLAT_KD_TREE_H
+#define __FLAT_KD_TREE_H
+
+#include <vector>
+#include <string>
+
+#include "FieldVertex.h"
+#include "NeighbourHeap.h"
+
+class MappedFile;
+
+//--------------------------------------------------------------------------
+//--
+//--  FlatKDTree
+//--  An implicit kd-tree: node i has children 2i+1 and 2i+2, so no pointers are
+//--  stored. Every leaf sits at the same depth and holds a bucket of up to
+//--  'bucketSize' vertices. The vertices' coordinates and field components are
+//--  copied into contiguous arrays (one per component), ordered so that each
+//--  leaf's bucket is a single run of every array. A search therefore touches a
+//--  handful of cache lines per leaf rather than one heap allocation per vertex.
+//--
+//--  The arrays can be written to a binary file, and a tree mapped from such a
+//--  file reads them in place, without parsing or copying them. The file holds,
+//--  in native byte order: a 128 byte header, then the split values, the six
+//--  vertex arrays, the leaf offsets and finally the split axes. The header
+//--  records the placement (rotation and translation) by which the vertices
+//--  were moved into the frame they are stored in, so that a user of the file
+//--  can check it expects the same one. A mapped file's arrays are checked for
+//--  consistency before they are used.
+//--
+//--  The region of space each node covers (its cell) is bounded by the
+//--  splitting planes of the nodes above it, so it is not stored. A search given
+//--  the leaf of a nearby point works up from that leaf, and stops at the first
+//--  subtree whose cell holds both the point and the ball of neighbours found so
+//--  far, checking the planes above each node it passes.
+//--
+//--------------------------------------------------------------------------
+
+class FlatKDTree {
+   public:
+      // -- Default number of vertices held in each leaf
+      static const int kDefaultBucketSize = 8;
+      
+      FlatKDTree();
+      FlatKDTree(const std::vector<const FieldVertex*>& vertices, const int bucketSize = kDefaultBucketSize);
+      virtual ~FlatKDTree();
+      
+      // -- Binary files
+      static bool IsBinaryFile(const std::string& filename);
+      static FlatKDTree* Map(const std::string& filename);
+      bool Write(const std::string& filename) const;
+      bool IsMapped() const {return fMapping != NULL;}
+      void SetPlacement(const double* placement);
+      const double* GetPlacement() const {return fPlacement;}
+      
+      int Size() const {return fNumVertices;}
+      int NumLeaves() const {return fNumLeaves;}
+      
+      // -- Vertex i, in the tree's own order
+      double X(const int i) const {return (fMapping ? fMapped.fX : &fX[0])[i];}
+      double Y(const int i) const {return (fMapping ? fMapped.fY : &fY[0])[i];}
+      double Z(const int i) const {return (fMapping ? fMapped.fZ : &fZ[0])[i];}
+      double Fx(const int i) const {return (fMapping ? fMapped.fFx : &fFx[0])[i];}
+      double Fy(const int i) const {return (fMapping ? fMapped.fFy : &fFy[0])[i];}
+      double Fz(const int i) const {return (fMapping ? fMapped.fFz : &fFz[0])[i];}
+      
+      int NearestNeighbours(const double* point, NeighbourHeap& neighbours) const;
+      int NearestNeighbours(const double* point, NeighbourHeap& neighbours, int& leaf, bool& hintSufficed) const;
+      
+   private:
+      // -- Where the tree's arrays are, whether held by the tree or mapped from a file
+      struct Arrays {
+         const double* fSplitValue;
+         const char* fSplitAxis;
+         const int* fLeafBegin;
+         const double *fX, *fY, *fZ;
+         const double *fFx, *fFy, *fFz;
+      };
+      
+      int fNumVertices;
+      int fNumLeaves;
+      std::vector<double> fSplitValue;    // Splitting coordinate of each internal node
+      std::vector<char> fSplitAxis;       // Splitting axis (0,1,2) of each internal node
+      std::vector<int> fLeafBegin;        // Leaf j holds vertices [fLeafBegin[j], fLeafBegin[j+1])
+      std::vector<double> fX, fY, fZ;
+      std::vector<double> fFx, fFy, fFz;
+      double fPlacement[12];              // Rotation (row by row) then translation of the vertices
+      MappedFile* fMapping;               //! File the arrays are mapped from, if any
+      Arrays fMapped;                     //! Arrays within the mapped file
+      
+      // -- Hidden copy
+      FlatKDTree(const FlatKDTree&);
+      FlatKDTree& operator=(const FlatKDTree&);
+      
+      Arrays GetArrays() const;
+      bool HasValidArrays() const;
+      void BuildNode(const std::vector<const FieldVertex*>& vertices, std::vector<int>& order,
+                     const int node, const int begin, const int end);
+      bool CellHolds(const double* point, const Arrays& arrays, const int node, const double boundSquared) const;
+      int SearchNode(const double* point, const Arrays& arrays, const int node, NeighbourHeap& neighbours) const;
+      int SearchLeaf(const double* point, const Arrays& arrays, const int leaf, NeighbourHeap& neighbours) const;
+      int LeafContaining(const double* point, const Arrays& arrays, const int startNode) const;
+};
+
+#endif
@@ -29,6 +29,7 @@ public:
 
    // -- methods
    const TVector3 GetMagField(const Point& point, const TVector3& velocity, const std::string = "") const;
+   Bool_t BakeFields(const Double_t tolerance);
    
    ClassDef(MagFieldArray, 1)
 };
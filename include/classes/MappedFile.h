@@ -0,0 +1,42 @@
+// MappedFile class
+// Read-only memory mapping of a whole file
+
+#ifndef __MAPPED_FILE_H
+#define __MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+//--------------------------------------------------------------------------
+//--
+//--  MappedFile
+//--  Maps a file read-only and shared, so that every process mapping the same
+//--  file reads it from a single copy in the page cache. The mapping lasts
+//--  until Close() or destruction.
+//--
+//--------------------------------------------------------------------------
+
+class MappedFile {
+   public:
+      MappedFile();
+      virtual ~MappedFile();
+      
+      bool Open(const std::string& filename);
+      void Close();
+      
+      bool IsOpen() const {return fData != NULL;}
+      const char* Data() const {return fData;}
+      size_t Size() const {return fSize;}
+      const std::string& FileName() const {return fFileName;}
+      
+   private:
+      std::string fFileName;
+      const char* fData;
+      size_t fSize;
+      
+      // -- Hidden copy
+      MappedFile(const MappedFile&);
+      MappedFile& operator=(const MappedFile&);
+};
+
+#endif
@@ -0,0 +1,52 @@
+// NavigationCursor class
+// Saved position of a navigator in the geometry tree, that can be returned to cheaply
+
+#ifndef NAVIGATIONCURSOR_H
+#define NAVIGATIONCURSOR_H
+
+#include <vector>
+
+#include "TGeoMatrix.h"
+
+class TGeoNode;
+class TGeoNavigator;
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    NavigationCursor - Records the branch of nodes leading to the        //
+//    navigator's current node, the index of each in its mother, and the   //
+//    node's global matrix. Restoring it walks straight back down the      //
+//    branch, instead of parsing a path string as TGeoNavigator::cd does.  //
+//    Saving it again from the same node does no work at all, so a single //
+//    cursor is reused for every step of a track. Its storage only grows   //
+//    when the track reaches a deeper level of the geometry than before.   //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+class NavigationCursor
+{
+private:
+   Int_t fLevel;                          // Level of the saved node, or -1 if nothing is saved
+   std::vector<const TGeoNode*> fNodes;   // fNodes[i] is the node at level i of the branch
+   std::vector<Int_t> fIndices;           // fIndices[i] is the index of fNodes[i] in its mother
+   TGeoHMatrix fMatrix;                   // Global matrix of the saved node
+   
+   Bool_t      IsOnBranch(const TGeoNavigator* navigator, const Int_t up) const;
+   
+public:
+   // -- Constructors
+   NavigationCursor();
+   NavigationCursor(const NavigationCursor&);
+   NavigationCursor& operator=(const NavigationCursor&);
+   
+   // -- Methods
+   void                 Save(const TGeoNavigator* navigator);
+   Bool_t               Restore(TGeoNavigator* navigator) const;
+   void                 Clear() {fLevel = -1;}
+   
+   Int_t                GetLevel() const {return fLevel;}
+   const TGeoNode*      GetNode() const {return (fLevel < 0 ? NULL : fNodes[fLevel]);}
+   const TGeoHMatrix*   GetMatrix() const {return &fMatrix;}
+};
+
+#endif /*NAVIGATIONCURSOR_H*/
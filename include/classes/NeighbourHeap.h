@@ -0,0 +1,51 @@
+// NeighbourHeap class
+// Fixed-capacity store of the nearest vertices found by a kd-tree search
+
+#ifndef __NEIGHBOUR_HEAP_H
+#define __NEIGHBOUR_HEAP_H
+
+//--------------------------------------------------------------------------
+//--
+//--  NeighbourHeap
+//--  A bounded max-heap of (vertex index, squared distance) pairs, keyed on the
+//--  squared distance, so that the furthest of the neighbours found so far is
+//--  always at the top and can be replaced in log(n). Storage is a fixed array
+//--  held by value, so a heap declared on the stack lets a search run without
+//--  touching the free store. Callers reuse a heap across searches with Clear().
+//--
+//--------------------------------------------------------------------------
+
+class NeighbourHeap {
+   public:
+      // -- Most neighbours any heap can hold
+      static const int kMaxNeighbours = 32;
+      
+      explicit NeighbourHeap(const int capacity);
+      
+      int Capacity() const {return fCapacity;}
+      int Size() const {return fSize;}
+      bool IsFull() const {return fSize == fCapacity;}
+      void Clear() {fSize = 0;}
+      
+      // -- Squared distance a vertex must beat to enter the heap
+      double BoundSquared() const;
+      // -- Consider a vertex, keeping it if it is among the 'capacity' nearest seen so far
+      void Offer(const int index, const double squaredDistance);
+      // -- Reorder the neighbours nearest first. Offer() must not be called again until Clear()
+      void Sort();
+      
+      // -- Neighbour i, in heap order (the furthest first) or, after Sort(), nearest first
+      int Index(const int i) const {return fIndices[i];}
+      double SquaredDistance(const int i) const {return fSquaredDistances[i];}
+      
+   private:
+      int fCapacity;
+      int fSize;
+      int fIndices[kMaxNeighbours];
+      double fSquaredDistances[kMaxNeighbours];
+      
+      void SiftDown(const int position, const int size);
+      void Swap(const int a, const int b);
+};
+
+#endif
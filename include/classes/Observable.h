@@ -14,6 +14,7 @@
 //                                                                        //
 ////////////////////////////////////////////////////////////////////////////
 class Point;
+class Clock;
 
 class Observable {
 private:
@@ -31,7 +32,7 @@ public:
    void      DetachAll();
    Observer* GetObserver(int index) {return fObservers[index];}
    
-   void NotifyObservers(const Point& point, const TVector3& velocity, const std::string& context);
+   void NotifyObservers(const Point& point, const TVector3& velocity, const std::string& context, const Clock& clock);
 
 };
 
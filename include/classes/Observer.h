@@ -23,6 +23,7 @@
 #include "FieldData.h"
 #include "Track.h"
 #include "PopulationData.h"
+#include "Trajectory.h"
 
 namespace Categories {
    // -- Define List of Observer categories. These define a "type" of observer
@@ -56,6 +57,7 @@ namespace Context {
 /////////////////////////////////////////////////////////////////////////////
 class Point;
 class Data;
+class Clock;
 
 class Observer : public TNamed
 {
@@ -79,10 +81,13 @@ public:
    
    void DefineSubject(const TObject* subject) {fSubject = subject;}
    
-   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context) = 0;
+   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context, const Clock& clock) = 0;
+   void         ScheduleMeasurements(Clock& clock) const;
    virtual void ResetInternalClock() {fPreviousMeasTime = 0.0;}
    virtual void ResetData() = 0;
    virtual void WriteToFile(Data& data) = 0;
+   virtual void Merge(const Observer& other);
+   virtual void RestoreFromFile(Data& data);
    
    ClassDef(Observer, 1)
 };
@@ -105,7 +110,7 @@ public:
    SpinObserver& operator=(const SpinObserver&);
    virtual ~SpinObserver();
    
-   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context);
+   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context, const Clock& clock);
    virtual void ResetData();
    virtual void WriteToFile(Data& data);
    
@@ -130,7 +135,7 @@ public:
    BounceObserver& operator=(const BounceObserver&);
    virtual ~BounceObserver();
    
-   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context);
+   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context, const Clock& clock);
    virtual void ResetData();
    virtual void WriteToFile(Data& data);
    
@@ -155,7 +160,7 @@ public:
    TrackObserver& operator=(const TrackObserver&);
    virtual ~TrackObserver();
    
-   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context);
+   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context, const Clock& clock);
    virtual void ResetData();
    virtual void WriteToFile(Data& data);
    
@@ -180,7 +185,7 @@ public:
    FieldObserver& operator=(const FieldObserver&);
    virtual ~FieldObserver();
    
-   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context);
+   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context, const Clock& clock);
    virtual void ResetData();
    virtual void WriteToFile(Data& data);
    
@@ -205,11 +210,39 @@ public:
    PopulationObserver& operator=(const PopulationObserver&);
    virtual ~PopulationObserver();
    
-   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context);
+   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context, const Clock& clock);
    virtual void ResetData();
    virtual void WriteToFile(Data& data);
+   virtual void Merge(const Observer& other);
+   virtual void RestoreFromFile(Data& data);
    
    ClassDef(PopulationObserver, 1)
 };
 
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    TrajectoryObserver - Records where each segment of free fall         //
+//    begins, so the particle's path can be reconstructed exactly later    //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+class TrajectoryObserver : public Observer
+{
+private:
+   Trajectory* fTrajectory;
+   
+public:
+   // -- Constructors
+   TrajectoryObserver(const std::string name, const TVector3& gravity);
+   TrajectoryObserver(const TrajectoryObserver&);
+   TrajectoryObserver& operator=(const TrajectoryObserver&);
+   virtual ~TrajectoryObserver();
+   
+   virtual void RecordEvent(const Point& point, const TVector3& velocity, const std::string& context, const Clock& clock);
+   virtual void ResetData();
+   virtual void WriteToFile(Data& data);
+   
+   ClassDef(TrajectoryObserver, 1)
+};
+
 #endif /* OBSERVER_H */
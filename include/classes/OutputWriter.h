@@ -0,0 +1,84 @@
+// OutputWriter class
+// Writes finished tracks to the data tree on a thread of its own
+
+#ifndef OUTPUTWRITER_H
+#define OUTPUTWRITER_H
+
+#include <deque>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "TStopwatch.h"
+
+#include "Data.h"
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    OutputWriter - Streaming and compressing a track's output into the   //
+//    data tree takes time that would otherwise hold up propagation.       //
+//    Finished tracks' output buffers are handed to the writer in order,   //
+//    and written out by its thread exactly as Data::WriteBufferToTree     //
+//    would on the propagating thread. The queue is bounded, so a run      //
+//    that outpaces its disk waits rather than holding the rest of its     //
+//    output in memory.                                                    //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+class OutputWriter
+{
+private:
+   Data& fData;
+   const size_t fCapacity;
+   
+   boost::thread fThread;
+   boost::mutex fMutex;
+   boost::mutex fFileMutex;                     // Held whenever the writer is using ROOT I/O
+   boost::condition_variable fOutputAvailable;
+   boost::condition_variable fSpaceAvailable;
+   boost::condition_variable fAllWritten;
+   std::deque<Data::ObjectBuffer*> fQueue;
+   bool fWriting;                               // Whether the writer is part way through a track
+   bool fStopping;
+   
+   // -- Statistics
+   ULong64_t fSubmitted;
+   ULong64_t fTotalDepth;                       // Sum of the queue depth seen by each submission
+   size_t fMaxDepth;
+   ULong64_t fStalls;                           // Submissions that had to wait for space
+   TStopwatch fBusyTime;                        // Time the writer spent writing
+   TStopwatch fStallTime;                       // Time submissions spent waiting for space
+   
+   void        WriterLoop();
+   
+   // -- Hidden copy
+   OutputWriter(const OutputWriter&);
+   OutputWriter& operator=(const OutputWriter&);
+   
+public:
+   // -- Holds the writer's lock on ROOT I/O for its lifetime, so that the owner can read from
+   // -- its input file safely while the writer is running. Does nothing if there is no writer.
+   class FileLock {
+   private:
+      OutputWriter* fWriter;
+      FileLock(const FileLock&);
+      FileLock& operator=(const FileLock&);
+   public:
+      explicit FileLock(OutputWriter* writer) : fWriter(writer) {if (fWriter) fWriter->fFileMutex.lock();}
+      ~FileLock() {if (fWriter) fWriter->fFileMutex.unlock();}
+   };
+   
+   // -- Constructors
+   OutputWriter(Data& data, const size_t capacity);
+   virtual ~OutputWriter();
+   
+   // -- Methods
+   void        Start();
+   void        Submit(Data::ObjectBuffer& buffer);
+   void        Flush();
+   void        Stop();
+   void        PrintStatistics();
+};
+
+#endif  /*OUTPUTWRITER_H*/
@@ -33,6 +33,8 @@ public:
 	static Parabola* 	Instance();
 	
 	virtual Double_t			ArcLength(const Double_t* velocity, const Double_t* field, const Double_t steptime)	const;
+	virtual void				BoundingBox(const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t steptime,
+															Double_t* lower, Double_t* upper) const;
 	
 	 
    ClassDef(Parabola, 1)          // parabola singleton
@@ -16,7 +16,7 @@
 #include "Spin.h"
 #include "State.h"
 #include "Observable.h"
-#include "TRandom3a.h"
+#include "TRandom.h"
 
 #include "Constants.h"
 
@@ -39,6 +39,8 @@ class GravField;
 class Run;
 class Data;
 class Boundary;
+class Clock;
+class NavigationCursor;
 
 class TGeoNode;
 class TGeoMatrix;
@@ -61,9 +63,12 @@ private:
    
    // Spin
    Spin         fSpin;
+   Double_t     fSpinStep; //! Spin step suggested by the adaptive integrator's last step (0 if none)
    
    // Random Generator State
-   TRandom3State* fRndState; // State of random generator at the beginning of particle's propagation
+   UInt_t fRndSeed;          // Seed of the random stream the particle was propagated with (0 if not saved)
+   ULong64_t fRndDrawIndex;  // Position in its random stream at the beginning of particle's propagation
+   TRandom* fRandom; //! Generator for the particle's random processes (gRandom if not set)
    
    // State Change
    void     ChangeState(State* state);
@@ -120,8 +125,13 @@ public:
    // Random Seed Storage 
    // (Used for setting the random number generator to the exact point
    // when simulation was started)
-   void                 SaveRandomGeneratorState(const TRandom3State& rndState);
-   const TRandom3State* GetRandomGeneratorState() const {return fRndState;}
+   // (The particle's Id selects its stream, so only the seed and position need to be kept)
+   void                 SaveRandomGeneratorState(const UInt_t seed, const ULong64_t drawIndex);
+   Bool_t               HasRandomGeneratorState() const {return fRndSeed != 0;}
+   UInt_t               GetRandomSeed() const {return fRndSeed;}
+   ULong64_t            GetRandomDrawIndex() const {return fRndDrawIndex;}
+   void                 SetRandomGenerator(TRandom* generator) {fRandom = generator;}
+   TRandom*             GetRandomGenerator() const {return (fRandom != NULL ? fRandom : gRandom);}
    
    // -- State
    const State&         GetState() const {return *fState;}
@@ -129,14 +139,14 @@ public:
    // -- Spin
    const Spin&          GetSpin() const {return fSpin;}
    void                 Polarise(const TVector3& axis, const Bool_t up);
-   void                 PrecessSpin(const TVector3& field, const Double_t precessTime);
+   void                 PrecessSpin(const TVector3& field, const Double_t precessTime, const Clock& clock);
    Bool_t               IsSpinUp(const TVector3& axis) const;
    
    // -- Propagation
-   Bool_t               Propagate(Run* run);
-   void                 Move(const Double_t stepTime, const Run* run);
+   Bool_t               Propagate(Run* run, Clock& clock);
+   void                 Move(const Double_t stepTime, const Run* run, Clock& clock);
    void                 UpdateCoordinates(const TGeoNavigator* navigator);
-   Bool_t               Reflect(const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const char* initialPath);
+   Bool_t               Reflect(const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const NavigationCursor& initialCursor, const Clock& clock);
    
    Bool_t               WillDecay(const Double_t timeInterval);
    
@@ -145,7 +155,7 @@ public:
    void                 IsAbsorbed();
    void                 IsAnomalous();
    
-   ClassDef(Particle,1)   // Ultra-Cold Neutron
+   ClassDef(Particle,2)   // Ultra-Cold Neutron
 };
 
 #endif  /*PARTICLE_H*/
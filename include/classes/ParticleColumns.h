@@ -0,0 +1,79 @@
+// ParticleColumns class
+// A particle's state as plain numbers, written to and read from one branch per number
+
+#ifndef PARTICLECOLUMNS_H
+#define PARTICLECOLUMNS_H
+
+#include <string>
+#include <vector>
+
+#include "TVector3.h"
+
+class TTree;
+class TBranch;
+class Particle;
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    ParticleColumns - The Particle branches of the data tree hold each   //
+//    particle as a single streamed object, which must be read whole.      //
+//    Alongside them, the columnar output writes the numbers an analysis   //
+//    usually needs to branches of their own, named <prefix>_<column>      //
+//    (eg: final_t, final_vz), which can be read one at a time and which   //
+//    compress far better. Each column has one entry for every entry of    //
+//    the Particle branch it accompanies, so the tree indexes held in the  //
+//    ParticleManifest apply to both.                                      //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+class ParticleColumns
+{
+private:
+   struct Column {
+      const char* fName;
+      void* fAddress;
+      char fType;          // Leaf type code: 'I' for Int_t, 'D' for Double_t
+   };
+   
+   Int_t fId;
+   Double_t fX, fY, fZ, fT;
+   Double_t fVx, fVy, fVz;
+   Double_t fUpRe, fUpIm, fDownRe, fDownIm;
+   Int_t fState;                          // States::Code of the particle's state
+   std::vector<TBranch*> fBranches;       // Branches attached for reading
+   
+   std::vector<Column> Columns();
+   
+   // -- Hidden copy, as the attached branches point at our members
+   ParticleColumns(const ParticleColumns&);
+   ParticleColumns& operator=(const ParticleColumns&);
+   
+public:
+   // -- Constructors
+   ParticleColumns();
+   
+   // -- Writing
+   void        Set(const Particle& particle);
+   Int_t       Fill(TTree& tree, const std::string& prefix);
+   
+   // -- Reading. 'selection' is a comma separated list of the columns to read, or empty for all
+   Bool_t      Attach(TTree& tree, const std::string& prefix, const std::string& selection = "");
+   Int_t       GetEntry(const Long64_t entry);
+   
+   Int_t       Id() const {return fId;}
+   Double_t    X() const {return fX;}
+   Double_t    Y() const {return fY;}
+   Double_t    Z() const {return fZ;}
+   Double_t    T() const {return fT;}
+   Double_t    Vx() const {return fVx;}
+   Double_t    Vy() const {return fVy;}
+   Double_t    Vz() const {return fVz;}
+   TVector3    GetVelocity() const {return TVector3(fVx, fVy, fVz);}
+   Double_t    UpRe() const {return fUpRe;}
+   Double_t    UpIm() const {return fUpIm;}
+   Double_t    DownRe() const {return fDownRe;}
+   Double_t    DownIm() const {return fDownIm;}
+   Int_t       State() const {return fState;}
+};
+
+#endif  /*PARTICLECOLUMNS_H*/
@@ -46,6 +46,7 @@ public:
    void AddEntry(const std::string state, const int id, const int index);
    Listing GetListing(const std::string state) const;
    Listing GetListing(const std::vector<std::string> states) const;
+   void Append(const ParticleManifest& other, const int indexOffset);
    void Print() const;
    
 
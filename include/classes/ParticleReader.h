@@ -0,0 +1,59 @@
+// ParticleReader class
+// Reads the particles to be propagated from the input tree in batches
+
+#ifndef PARTICLEREADER_H
+#define PARTICLEREADER_H
+
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include "Particle.h"
+
+class TTree;
+class TBranch;
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    ParticleReader - Hands out the selected particles of an input        //
+//    branch in order, each as a new Particle owned by the caller, so      //
+//    that any number of threads can take work from it. Particles are      //
+//    decoded a batch at a time into a contiguous array, and the tree's    //
+//    cache is set to read only the input branch over the selected         //
+//    entries, so its baskets are fetched in a few large reads rather      //
+//    than one small read per particle.                                    //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+class ParticleReader
+{
+private:
+   TTree& fTree;
+   TBranch& fBranch;
+   const std::vector<int> fIndexes;     // Tree entries of the particles, in the order to hand out
+   const size_t fBatchSize;
+   std::vector<Particle> fBatch;        // Decoded particles of the current batch
+   size_t fBatchStart;                  // Position in fIndexes of the first particle in fBatch
+   size_t fNext;                        // Position in fIndexes of the next particle to hand out
+   boost::mutex fMutex;
+   
+   Bool_t      ReadBatch();
+   
+   // -- Hidden copy
+   ParticleReader(const ParticleReader&);
+   ParticleReader& operator=(const ParticleReader&);
+   
+public:
+   static const size_t kDefaultBatchSize = 256;
+   static const Long64_t kCacheSize = 10000000;   // Bytes
+   
+   // -- Constructors
+   ParticleReader(TTree& tree, TBranch& branch, const std::vector<int>& indexes, const size_t batchSize = kDefaultBatchSize);
+   virtual ~ParticleReader();
+   
+   // -- Methods
+   Particle*   Next();
+   size_t      Remaining();
+};
+
+#endif  /*PARTICLEREADER_H*/
@@ -24,6 +24,16 @@ private:
    Polynomial();
    Polynomial(const Polynomial&); 
    Polynomial& operator=(const Polynomial&);
+   
+   // Helpers for the closed-form quartic solver
+   Int_t          RealQuadraticRoots(const Double_t b, const Double_t c, Double_t* roots) const;
+   Double_t       PolishQuarticRoot(const Double_t* coeffs, const Double_t root) const;
+   
+   // Helpers for the bounded root search
+   Bool_t         ExcludesRoots(const Double_t* params, const Int_t degree, const Double_t tmin, const Double_t tmax) const;
+   Bool_t         SearchInterval(const Double_t* params, const Int_t degree, const Double_t tmin, const Double_t tmax, const Bool_t refine, Double_t& root) const;
+   Bool_t         IsolateFirstRoot(const Double_t* p, const Double_t* dp, const Int_t n, const Double_t lo, const Double_t hi, const Int_t depth, const Bool_t refine, Double_t& root) const;
+   Double_t       RefineBracketedRoot(const Double_t* p, const Int_t n, const Double_t lo, const Double_t hi, const Double_t flo) const;
 
 public:
    virtual ~Polynomial();
@@ -32,6 +42,10 @@ public:
    virtual Int_t  QuadraticRootFinder(const Double_t* params, Double_t* roots);
    virtual Int_t  QuarticRootFinder(const Double_t* params, Double_t* roots);
    virtual Int_t  CubicRootFinder(const Double_t* params, Double_t* roots);
+   virtual Int_t  ComplexQuarticRootFinder(const Double_t* params, Double_t* roots);
+   
+   virtual Bool_t HasRootInInterval(const Double_t* params, const Int_t degree, const Double_t tmin, const Double_t tmax);
+   virtual Bool_t FirstRootInInterval(const Double_t* params, const Int_t degree, const Double_t tmin, const Double_t tmax, Double_t& root);
    
    virtual Int_t  AnalyticQuadraticAlgorithm(const Double_t a, const Double_t b, const Double_t c, Double_t* roots);
    virtual Int_t  AnalyticCubicAlgorithm(const Double_t p, const Double_t q, const Double_t a2, Double_t* roots);
@@ -13,6 +13,7 @@ class PopulationData : public std::map<double, std::map<std::string, int> >,  pu
       virtual ~PopulationData() {Info("PopulationData","Destructor");}
       
       void Fill(double t, std::string statename);
+      void Add(const PopulationData& other);
       
    ClassDef(PopulationData, 1)
 };
@@ -4,6 +4,8 @@
 #ifndef ROOT_Run
 #define ROOT_Run
 
+#include <ctime>
+
 #include "TNamed.h"
 #include "Data.h"
 #include "Experiment.h"
@@ -17,6 +19,9 @@
 class TGeoManager;
 class ConfigFile;
 class Particle;
+class TRandomPhilox;
+class OutputWriter;
+class RunStatistics;
 
 class Run : public TNamed 
 {
@@ -25,6 +30,13 @@ private:
    Data             fData;
    Experiment*      fExperiment;
    
+   // Propagation of the selected particles
+   Bool_t               PropagateInSerial(const std::vector<int>& selectedParticles, const size_t firstParticle, TRandomPhilox& rndGenerator, OutputWriter* writer);
+   Bool_t               PropagateInParallel(const std::vector<int>& selectedParticles, const size_t firstParticle, const Int_t threads, OutputWriter* writer, RunStatistics& statistics);
+   void                 PrepareROOTForThreads() const;
+   Bool_t               CheckpointDue(const size_t completed, const size_t lastCheckpoint, const time_t lastCheckpointTime) const;
+   void                 SaveCheckpoint(const std::vector<int>& selectedParticles, const size_t completed, OutputWriter* writer, size_t& lastCheckpoint, time_t& lastCheckpointTime);
+   
 public:
    // -- constructors
    Run();
@@ -46,9 +58,12 @@ public:
    const RunConfig&     GetRunConfig() const  {return fRunConfig;}
    
    // Run Procedures
-   Bool_t               Initialise();
+   Bool_t               Initialise(const Bool_t resume = kFALSE);
    Bool_t               Start();
    Bool_t               Finish();
+   
+   // Propagate a single particle, recording its output to data
+   Bool_t               PropagateParticle(Particle* particle, Data& data, TRandomPhilox& rndGenerator);
       
    ClassDef(Run, 1)
 };
@@ -30,19 +30,36 @@ namespace RunParams {
    static const std::string elecField = "ElecFields";
    static const std::string wallLosses = "WallLosses";
    static const std::string betaDecay = "BetaDecay";
+   static const std::string safetySteps = "SafetySteps";
+   static const std::string bakeFields = "BakeFields";
+   static const std::string sumOverlappingFields = "SumOverlappingFields";
    static const std::string recordSpin = "RecordSpin";
    static const std::string recordBounces = "RecordBounces";
    static const std::string recordTracks = "RecordTracks";
    static const std::string recordField = "RecordField";
    static const std::string recordPopulation = "RecordPopulation";
+   static const std::string recordTrajectory = "RecordTrajectory";
+   static const std::string columnarOutput = "ColumnarOutput";
    // -- Parameters (Allows values to be set by user)
    static const std::string runTime = "RunTime(s)";
    static const std::string maxStepTime = "MaxStepTime(s)";
    static const std::string spinStepTime = "SpinStepTime(s)";
+   static const std::string spinTolerance = "SpinTolerance";
    static const std::string trackMeasFreq = "TrackMeasureFrequency(Hz)";
    static const std::string spinMeasFreq = "SpinMeasureFrequency(Hz)";
    static const std::string fieldMeasFreq = "FieldMeasureFrequency(Hz)";
    static const std::string populationMeasFreq = "PopulationMeasureFrequency(Hz)";
+   static const std::string threads = "Threads";
+   static const std::string outputQueueSize = "OutputQueueSize";
+   static const std::string checkpointParticles = "CheckpointParticles";
+   static const std::string checkpointMinutes = "CheckpointMinutes";
+   static const std::string randomSeed = "RandomSeed";
+   static const std::string bakeTolerance = "BakeTolerance";
+   // -- Shard of the selected particles to propagate (Set from the command line)
+   static const std::string shard = "Shard";
+   static const std::string shards = "Shards";
+   static const std::string firstParticle = "FirstParticle";
+   static const std::string lastParticle = "LastParticle";
 }
 
 class ConfigFile;
@@ -83,21 +100,40 @@ public:
    double RunTime() const;
    double MaxStepTime() const;
    double SpinStepTime() const;
+   double SpinTolerance() const;
    bool GravFieldOn() const;
    bool MagFieldOn() const;
    bool ElecFieldOn() const;
    bool WallLossesOn() const;
    bool BetaDecayOn() const;
+   bool SafetyStepsOn() const;
+   bool BakeFieldsOn() const;
+   double BakeTolerance() const;
+   bool SumOverlappingFields() const;
    bool ObserveSpin() const;
    bool ObserveBounces() const;
    bool ObserveTracks() const;
    bool ObserveField() const;
    bool ObservePopulation() const;
+   bool ObserveTrajectory() const;
+   bool ColumnarOutput() const;
    double TrackMeasureInterval() const;
    double SpinMeasureInterval() const;
    double FieldMeasureInterval() const;
    double PopulationMeasureInterval() const;
+   int Threads() const;
+   int OutputQueueSize() const;
+   int CheckpointParticles() const;
+   double CheckpointMinutes() const;
+   unsigned int RandomSeed() const;
    std::vector<int> SelectedParticleIDs() const {return fSelectedParticleIDs;}
+   // Sharding
+   void SelectShard(const int shard, const int shards);
+   void SelectParticleRange(const int first, const int last);
+   void ClearShard();
+   bool IsSharded() const;
+   bool ShardRange(const size_t totalParticles, size_t& first, size_t& last) const;
+   std::string ShardName() const;
    virtual void Print(Option_t* option = "") const;
 
    ClassDef(RunConfig,1);
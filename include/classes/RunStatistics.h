@@ -0,0 +1,56 @@
+// RunStatistics class
+// Counts of the work saved while propagating, kept by each propagating thread
+
+#ifndef __RUN_STATISTICS_H
+#define __RUN_STATISTICS_H
+
+#include "Rtypes.h"
+
+//--------------------------------------------------------------------------
+//--
+//--  RunStatistics
+//--  How often the propagation's shortcuts paid off: shapes skipped as out of
+//--  reach of a step, field lookups falling outside every field, and field map
+//--  lookups answered from the previous lookup. Each thread that propagates
+//--  owns one and records into it as its current statistics, so counting needs
+//--  no lock. The ThreadPool sums its workers' statistics at the end of the
+//--  run, as it does their observers.
+//--
+//--------------------------------------------------------------------------
+
+class RunStatistics
+{
+   public:
+      // -- Makes the statistics the calling thread's current ones for its lifetime
+      class Recording {
+         private:
+            RunStatistics* fPrevious;
+            Recording(const Recording&);
+            Recording& operator=(const Recording&);
+         public:
+            explicit Recording(RunStatistics& statistics);
+            ~Recording();
+      };
+      
+      ULong64_t fShapesTested;      // Shapes tested for whether a step can reach them
+      ULong64_t fShapesCulled;      // Shapes skipped as out of reach, without solving for them
+      ULong64_t fFieldLookups;      // Lookups in a field array
+      ULong64_t fFieldMisses;       // Field array lookups outside every field
+      ULong64_t fMapLookups;        // Lookups in a field map
+      ULong64_t fMapRepeatHits;     // Map lookups of the same point as the previous lookup
+      ULong64_t fMapHintHits;       // Map lookups answered below the root from the previous lookup's leaf, or from its grid cell
+      
+      RunStatistics();
+      void Reset();
+      void Add(const RunStatistics& other);
+      void Print() const;
+      
+      // -- The calling thread's current statistics, or NULL if it is not recording any
+      static RunStatistics* Current();
+      
+   private:
+      friend class Recording;
+      static void SetCurrent(RunStatistics* statistics);
+};
+
+#endif
@@ -22,6 +22,8 @@ private:
    Double_t fUpRe, fUpIm;  // Spinor components for Spin 'Up'
    Double_t fDownRe, fDownIm; // Spinor components for Spin 'Down'
    
+   friend class SpinorBatch;
+   
 public:
    // -- Constructors
    Spinor();
@@ -34,8 +36,14 @@ public:
    void PolariseDown(const TVector3& axis);
    
    Bool_t Precess(const TVector3& avgMagField, const Double_t precessTime);
+   Bool_t Rotate(const TVector3& angle);
    Double_t CalculateProbSpinUp(const TVector3& axis) const;
    
+   Double_t UpRe() const {return fUpRe;}
+   Double_t UpIm() const {return fUpIm;}
+   Double_t DownRe() const {return fDownRe;}
+   Double_t DownIm() const {return fDownIm;}
+   
    virtual void Print(Option_t* option = "") const;
    
    ClassDef(Spinor, 1)
@@ -53,6 +61,8 @@ class Spin : public TObject
 private:
    Spinor fSpinor;
    
+   friend class SpinorBatch;
+   
 public:
    // -- Constructors
    Spin();
@@ -62,8 +72,10 @@ public:
    
    // -- Methods
    Bool_t Precess(const TVector3& avgMagField, const Double_t precessTime);
+   Bool_t Rotate(const TVector3& angle);
    Bool_t IsSpinUp(const TVector3& axis) const;
    Double_t CalculateProbSpinUp(const TVector3& axis) const;
+   const Spinor& GetSpinor() const {return fSpinor;}
    
    // -- Set initial polarisation
    Bool_t Polarise(const TVector3& axis, const Bool_t up);
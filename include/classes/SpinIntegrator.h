@@ -0,0 +1,61 @@
+// SpinIntegrator class
+// Adaptive fourth-order Magnus integration of spin precession along a step
+
+#ifndef SPININTEGRATOR_H
+#define SPININTEGRATOR_H
+
+#include "TVector3.h"
+
+class Spin;
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    SpinIntegrator - Precesses a spin through a field that varies in     //
+//    time, in steps chosen from how quickly the field turns against the   //
+//    precession. Each step samples the field at the two Gauss-Legendre    //
+//    points and applies the fourth-order Magnus rotation                  //
+//       h/2 (w1 + w2) + sqrt(3)/12 h^2 (w2 x w1),                         //
+//    which is exact in any field of fixed direction, up to the accuracy   //
+//    of the quadrature. The commutator term, the part that any lower      //
+//    order method misses, is kept below the tolerance. It grows with the  //
+//    square of the precession rate times the turn of the field over the   //
+//    step, so steps grow in slowly turning fields and shrink in strong    //
+//    ones that turn quickly. It is not an estimate of the step's own      //
+//    error, and where the field is weak, as near a zero crossing, it      //
+//    stays small and the steps are not shortened, however quickly the     //
+//    field turns there.                                                   //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+class SpinIntegrator
+{
+public:
+   // -- The field seen by the particle at any time within the interval being integrated
+   class FieldSource
+   {
+   public:
+      virtual ~FieldSource() {}
+      virtual TVector3 GetField(const Double_t time) = 0;
+   };
+   
+private:
+   Double_t fTolerance;   // Largest commutator term accepted in a step's rotation (radians)
+   Int_t fEvaluations;    // Number of times the field has been sampled
+   Int_t fSteps;          // Number of steps taken
+   Int_t fRejections;     // Number of steps retried with a shorter interval
+   
+public:
+   // -- Constructors
+   explicit SpinIntegrator(const Double_t tolerance);
+   
+   // -- Methods
+   Double_t Step(Spin& spin, FieldSource& source, const Double_t time, const Double_t maxInterval,
+                 Double_t& trialStep);
+   
+   Double_t Tolerance() const {return fTolerance;}
+   Int_t NumEvaluations() const {return fEvaluations;}
+   Int_t NumSteps() const {return fSteps;}
+   Int_t NumRejections() const {return fRejections;}
+};
+
+#endif  /*SPININTEGRATOR_H*/
@@ -0,0 +1,61 @@
+// SpinReplay class
+// Precesses the spin along a recorded trajectory in many field configurations at once
+
+#ifndef SPINREPLAY_H
+#define SPINREPLAY_H
+
+#include <vector>
+
+#include "SpinorBatch.h"
+
+class MagFieldArray;
+class ElecFieldArray;
+class Trajectory;
+class Spin;
+class SpinData;
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    SpinReplay - A particle's path does not depend on the magnetic       //
+//    field, so a trajectory recorded once can be replayed in any number   //
+//    of field configurations without tracking it through the geometry     //
+//    again. Each configuration's spinor is held in one SpinorBatch, and   //
+//    each step samples every configuration's field at the midpoint of     //
+//    the step, as Particle::Move does, and precesses them all together.   //
+//    Steps never cross a bounce, so every sample lies on a parabola.      //
+//    A configuration's field is that of its magnetic fields plus the      //
+//    motional field of its electric fields, as FieldManager sums them.    //
+//    Either may be absent. Steps are of fixed length, so runs that chose  //
+//    their spin steps adaptively (SpinTolerance) cannot be replayed.      //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+class SpinReplay
+{
+private:
+   std::vector<const MagFieldArray*> fMagFields;     // Each configuration's magnetic fields, or NULL (not owned)
+   std::vector<const ElecFieldArray*> fElecFields;   // Each configuration's electric fields, or NULL (not owned)
+   Double_t fSpinStepTime;
+   Double_t fMeasureInterval;
+   SpinorBatch fBatch;
+   std::vector<Double_t> fFieldX, fFieldY, fFieldZ;
+   
+   void        Measure(const Double_t time, std::vector<SpinData*>& results) const;
+   
+   // -- Hidden copy
+   SpinReplay(const SpinReplay&);
+   SpinReplay& operator=(const SpinReplay&);
+   
+public:
+   // -- Constructors
+   SpinReplay(const std::vector<const MagFieldArray*>& magFields, const std::vector<const ElecFieldArray*>& elecFields,
+              const Double_t spinStepTime, const Double_t measureInterval);
+   
+   // -- Methods
+   Int_t       Configurations() const {return static_cast<Int_t>(fMagFields.size());}
+   // -- Precess 'initialSpin' along 'trajectory' in each configuration, adding the spin at the
+   // -- start and at every measurement interval after it to the matching SpinData in 'results'
+   Bool_t      Replay(const Trajectory& trajectory, const Spin& initialSpin, std::vector<SpinData*>& results);
+};
+
+#endif  /*SPINREPLAY_H*/
@@ -0,0 +1,54 @@
+// SpinorBatch class
+// Spinors of many particles held as arrays, precessed together
+
+#ifndef SPINORBATCH_H
+#define SPINORBATCH_H
+
+#include <vector>
+
+#include "TVector3.h"
+
+class Spin;
+class Spinor;
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    SpinorBatch - The components of N spinors stored as four arrays,     //
+//    so that precessing them all about their own fields is a single       //
+//    loop with no branches or calls to libm, which the compiler           //
+//    vectorises to the width of the target (AVX2, AVX-512) when built     //
+//    with the corresponding -march flags, and runs as plain scalar code   //
+//    otherwise. Spins are copied in with Load and back out with Store.    //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+class SpinorBatch
+{
+private:
+   std::vector<Double_t> fUpRe, fUpIm;       // Spin 'Up' components of each spinor
+   std::vector<Double_t> fDownRe, fDownIm;   // Spin 'Down' components of each spinor
+   
+public:
+   // -- Constructors
+   explicit SpinorBatch(const Int_t size = 0);
+   
+   // -- Methods
+   Int_t Size() const {return static_cast<Int_t>(fUpRe.size());}
+   void Resize(const Int_t size);
+   
+   void Load(const Int_t index, const Spinor& spinor);
+   void Load(const Int_t index, const Spin& spin);
+   void Store(const Int_t index, Spinor& spinor) const;
+   void Store(const Int_t index, Spin& spin) const;
+   
+   // -- Precess spinor i about field (fieldX[i], fieldY[i], fieldZ[i]), for precessTime[i]
+   // -- or for a time common to all of them
+   void Precess(const Double_t* fieldX, const Double_t* fieldY, const Double_t* fieldZ,
+                const Double_t* precessTime);
+   void Precess(const Double_t* fieldX, const Double_t* fieldY, const Double_t* fieldZ,
+                const Double_t precessTime);
+   
+   Double_t CalculateProbSpinUp(const Int_t index, const TVector3& axis) const;
+};
+
+#endif  /*SPINORBATCH_H*/
@@ -6,9 +6,11 @@
 #define STATE_H
 
 #include <string>
+#include <vector>
 
 #include "TObject.h"
 #include "ValidStates.h"
+#include "NavigationCursor.h"
 
 /////////////////////////////////////////////////////////////////////////////
 //                                                                         //
@@ -23,6 +25,10 @@ class Particle;
 class FieldManager;
 class GravField;
 class Run;
+class Experiment;
+class VolumeTree;
+class VolumeGravity;
+class Clock;
 class TGeoNode;
 class TGeoMatrix;
 class TGeoNavigator;
@@ -45,7 +51,7 @@ public:
    virtual const char* GetName() const = 0;
    
    // -- Propagation
-   virtual Bool_t    Propagate(Particle* particle, Run* run);
+   virtual Bool_t    Propagate(Particle* particle, Run* run, Clock& clock);
    virtual Bool_t    LocateInGeometry(Particle* particle, TGeoNavigator* navigator,
                            const TGeoNode* initialNode, const TGeoMatrix* initialMatrix,
                            const TGeoNode* crossedNode);
@@ -73,18 +79,25 @@ protected:
    Bool_t      fIsStepEntering;
    Bool_t      fIsStepExiting;
    Bool_t      fIsOnBoundary;     //! flag that current point is on some boundary
+   std::vector<Int_t> fCandidates; //! daughters that may be reached in the current step
+   NavigationCursor fInitialCursor; //! node the current step started from
    
    // Step Time calculation
    virtual Double_t  DetermineNextStepTime(const Particle& particle, const RunConfig& runConfig);
    // Propagation
-   virtual Bool_t    MakeStep(Double_t stepTime, Particle* particle, Run* run);
+   virtual Bool_t    MakeStep(Double_t stepTime, Particle* particle, Run* run, Clock& clock);
    
    // Boundary Finding
+   virtual Double_t  FreeFlightTime(const Particle& particle, TGeoNavigator* navigator,
+                                    const GravField* const field);
+   virtual void      FreeFlight(const Double_t stepTime, const Particle& particle,
+                                    TGeoNavigator* navigator, const GravField* const field);
    virtual TGeoNode* ParabolicBoundaryFinder(Double_t& stepTime, const Particle& particle,
                                           TGeoNavigator* navigator, TGeoNode* crossedNode,
-                                          const GravField* const field);
+                                          const GravField* const field, const Experiment& experiment);
    virtual TGeoNode* ParabolicDaughterBoundaryFinder(Double_t& stepTime, TGeoNavigator* navigator,
                                     Double_t* point, Double_t* velocity, Double_t* field,
+                                    const VolumeTree* daughterTree, const VolumeGravity* daughterGravity,
                                     Int_t &idaughter, Bool_t compmatrix=kFALSE);
    
    // Error checking when moving between volumes
@@ -109,7 +122,7 @@ public:
    virtual const char* GetName() const {return States::propagating.c_str();}
    
    // -- Propagation
-   virtual Bool_t    Propagate(Particle* particle, Run* run);
+   virtual Bool_t    Propagate(Particle* particle, Run* run, Clock& clock);
    virtual Bool_t    LocateInGeometry(Particle* particle, TGeoNavigator* navigator,
                            const TGeoNode* initialNode, const TGeoMatrix* initialMatrix,
                            const TGeoNode* crossedNode);
@@ -0,0 +1,53 @@
+// TRandomPhilox class
+// Counter-based random number generator (Philox4x32-10)
+
+#ifndef ROOT_TRandomPhilox
+#define ROOT_TRandomPhilox
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    TRandomPhilox - Counter-based random number generator, after         //
+//    J. Salmon et al, "Parallel Random Numbers: As Easy as 1, 2, 3",      //
+//    SC11 (2011). Each stream is keyed by the run's seed and a stream     //
+//    number (the particle's Id), and the n'th number drawn from a stream  //
+//    is a pure function of (seed, stream, n). The whole state of a stream //
+//    is therefore just its draw index, and any particle can be replayed   //
+//    on any thread or machine from those three numbers alone.             //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_TRandom
+#include "TRandom.h"
+#endif
+
+class TRandomPhilox : public TRandom {
+private:
+   UInt_t      fKey[2];       // Key of the stream: {seed, stream}
+   ULong64_t   fCounter;      // Index of the next block of four numbers to generate
+   UInt_t      fBlock[4];     // Current block of generated numbers
+   Int_t       fBlockPos;     // Position of the next number to hand out of fBlock
+   
+   void        GenerateBlock();
+   UInt_t      NextInteger();
+
+public:
+   TRandomPhilox(UInt_t seed=4357, UInt_t stream=0);
+   virtual ~TRandomPhilox();
+   virtual  Double_t  Rndm(Int_t i=0);
+   virtual  void      RndmArray(Int_t n, Float_t *array);
+   virtual  void      RndmArray(Int_t n, Double_t *array);
+   virtual  void      SetSeed(UInt_t seed=0);
+   
+   // -- Stream positioning
+   void               SetStream(UInt_t seed, UInt_t stream, ULong64_t drawIndex=0);
+   UInt_t             GetStream() const {return fKey[1];}
+   void               SetDrawIndex(ULong64_t drawIndex);
+   ULong64_t          GetDrawIndex() const {return 4*fCounter - (4 - fBlockPos);}
+   
+   // -- Raw Philox4x32-10 block function
+   static void        Philox4x32(const UInt_t* counter, const UInt_t* key, UInt_t* output);
+   
+   ClassDef(TRandomPhilox,1)  //Random number generator: Philox4x32-10
+};
+
+#endif
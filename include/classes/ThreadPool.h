@@ -0,0 +1,88 @@
+// ThreadPool class
+// Propagates particles concurrently on a set of worker threads
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "Data.h"
+#include "RunStatistics.h"
+
+class Run;
+class Experiment;
+class Particle;
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    TrackJob - A single particle to be propagated by a worker, along     //
+//    with the output of its propagation, waiting to be written out.       //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+struct TrackJob
+{
+   size_t fSequence;             // Position of the track in the order of submission
+   Particle* fParticle;          // Particle to propagate (owned by the job)
+   bool fPropagated;             // Whether the particle's propagation was able to begin
+   Data::ObjectBuffer fOutput;   // Track's output waiting to be written to the data tree
+
+   TrackJob(size_t sequence, Particle* particle);
+   ~TrackJob();
+};
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    ThreadPool - Each worker thread owns its own navigator, random       //
+//    generator, set of observers and run statistics. Completed tracks     //
+//    are handed back in the order they were submitted, so that they can   //
+//    be written to the data tree exactly as a serial run would write      //
+//    them.                                                                //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+class ThreadPool
+{
+private:
+   Run& fRun;
+   Experiment& fExperiment;
+   const int fNumThreads;
+
+   boost::thread_group fThreads;
+   boost::mutex fMutex;
+   boost::condition_variable fJobAvailable;
+   boost::condition_variable fJobCompleted;
+   std::deque<TrackJob*> fPendingJobs;
+   std::map<size_t, TrackJob*> fCompletedJobs;
+   std::vector<Data*> fWorkerData; // Holds each worker's observers
+   std::vector<RunStatistics*> fWorkerStatistics;
+   bool fStopping;
+
+   void        WorkerLoop(const int workerId);
+
+   // -- Hidden copy
+   ThreadPool(const ThreadPool&);
+   ThreadPool& operator=(const ThreadPool&);
+
+public:
+   // -- Constructors
+   ThreadPool(Run& run, Experiment& experiment, const int numThreads);
+   virtual ~ThreadPool();
+
+   // -- Methods
+   int         NumThreads() const {return fNumThreads;}
+   void        Start();
+   void        Submit(TrackJob* job);
+   TrackJob*   WaitForJob(const size_t sequence);
+   void        Stop();
+   void        MergeObservers(Data& data);
+   void        MergeStatistics(RunStatistics& statistics);
+};
+
+#endif  /*THREADPOOL_H*/
@@ -0,0 +1,62 @@
+// Trajectory
+// Compact record of a particle's path, from which its position can be found at any time
+
+#ifndef ROOT_Trajectory
+#define ROOT_Trajectory
+
+#include <vector>
+#include "TObject.h"
+#include "TVector3.h"
+
+////////////////////////////////////////////////////////////////////////////
+//                                                                        //
+//       Trajectory                                                       //
+//                                                                        //
+//    Between boundaries a particle falls freely under gravity, so its    //
+//    whole path is fixed by the point, velocity and time at which each   //
+//    segment begins (the start of the track and each bounce), the time   //
+//    the track ends, and the gravitational field. Unlike Track, which    //
+//    samples the path for drawing, this is exact and does not grow with  //
+//    the length of the track, only with its number of bounces.           //
+//                                                                        //
+////////////////////////////////////////////////////////////////////////////
+
+class Point;
+
+class Trajectory : public TObject
+{
+private:
+   std::vector<Double_t> fT;                  // Time each segment begins
+   std::vector<Double_t> fX, fY, fZ;          // Position at the beginning of each segment
+   std::vector<Double_t> fVx, fVy, fVz;       // Velocity at the beginning of each segment
+   Double_t fEndTime;                         // Time the track ends
+   Double_t fGx, fGy, fGz;                    // Gravitational acceleration along the path
+   
+public:
+   // -- constructors
+   Trajectory();
+   Trajectory(const TVector3& gravity);
+   Trajectory(const Trajectory&); 
+   Trajectory& operator=(const Trajectory&);
+   // -- destructor
+   virtual ~Trajectory();
+   
+   // -- methods
+   void           AddSegment(const Point& point, const TVector3& velocity);
+   void           SetEndTime(const Double_t endTime) {fEndTime = endTime;}
+   virtual void   Clear(Option_t* option = "");
+   
+   Int_t          Segments() const {return static_cast<Int_t>(fT.size());}
+   Double_t       StartTime() const {return (fT.empty() ? 0. : fT.front());}
+   Double_t       EndTime() const {return fEndTime;}
+   Double_t       SegmentStart(const Int_t segment) const {return fT[segment];}
+   Double_t       SegmentEnd(const Int_t segment) const;
+   TVector3       Gravity() const {return TVector3(fGx, fGy, fGz);}
+   
+   Int_t          FindSegment(const Double_t time, const Int_t hint = 0) const;
+   void           GetState(const Double_t time, const Int_t segment, TVector3& position, TVector3& velocity) const;
+   
+   ClassDef(Trajectory, 1)
+};
+
+#endif
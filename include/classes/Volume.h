@@ -18,6 +18,8 @@ class TGeoNavigator;
 class TGeoShape;
 class TGeoMedium;
 class RunConfig;
+class Clock;
+class NavigationCursor;
 
 class Volume : public TGeoVolume
 {   
@@ -33,7 +35,7 @@ public:
    virtual ~Volume();
    
    // -- methods
-   virtual Bool_t  Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const char* initialPath, const RunConfig& runconfig);
+   virtual Bool_t  Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const NavigationCursor& initialCursor, const RunConfig& runconfig, const Clock& clock);
    
    virtual Double_t FermiPotential() const;
    virtual Double_t WPotential() const;
@@ -66,7 +68,7 @@ public:
    // -- destructor
    virtual ~TrackingVolume();
    
-   virtual Bool_t Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const char* initialPath, const RunConfig& runconfig);
+   virtual Bool_t Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const NavigationCursor& initialCursor, const RunConfig& runconfig, const Clock& clock);
    virtual Bool_t IsTrackingVolume() const {return kTRUE;}
    
    ClassDef(TrackingVolume, 1)
@@ -96,7 +98,7 @@ public:
    // -- destructor
    virtual ~Boundary();
    
-   virtual Bool_t Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const char* initialPath, const RunConfig& runconfig);
+   virtual Bool_t Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const NavigationCursor& initialCursor, const RunConfig& runconfig, const Clock& clock);
    
    Double_t GetRoughness() const {return fRoughness;}
    
@@ -126,7 +128,7 @@ public:
    // -- destructor
    virtual ~Detector();
    
-   virtual Bool_t Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const char* initialPath, const RunConfig& runconfig);
+   virtual Bool_t Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const NavigationCursor& initialCursor, const RunConfig& runconfig, const Clock& clock);
    
    ClassDef(Detector, 1)
 };
@@ -155,7 +157,7 @@ public:
    // -- destructor
    virtual ~BlackHole();
    
-   virtual Bool_t Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const char* initialPath, const RunConfig& runconfig);
+   virtual Bool_t Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const NavigationCursor& initialCursor, const RunConfig& runconfig, const Clock& clock);
    
    ClassDef(BlackHole, 1)
 };
@@ -0,0 +1,45 @@
+// VolumeGravity class
+// Gravitational field in the local frame of a volume, and of each of its daughters
+
+#ifndef VOLUMEGRAVITY_H
+#define VOLUMEGRAVITY_H
+
+#include <vector>
+
+#include "TObject.h"
+
+class TGeoVolume;
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    VolumeGravity - Gravity is uniform and the geometry's matrices never //
+//    change, so the field seen in each volume's local frame can be found  //
+//    once, when the experiment is initialised, rather than transformed    //
+//    afresh on every step. Holds the field in the volume's frame along    //
+//    with the field in the frame of each of its daughter placements.      //
+//    Only valid if every placement of the volume sees the same field.     //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+class VolumeGravity
+{
+private:
+   Bool_t fIsUnique;                   // False if placements of the volume disagree on the field
+   Double_t fField[3];                 // Field in the volume's frame
+   std::vector<Double_t> fDaughterFields; // Field in the frame of each daughter, 3 per daughter
+   
+public:
+   // -- Constructors
+   VolumeGravity();
+   VolumeGravity(const TGeoVolume& volume, const Double_t* field);
+   
+   // -- Methods
+   Bool_t            IsUnique() const {return fIsUnique;}
+   Bool_t            Matches(const Double_t* field) const;
+   void              SetAmbiguous() {fIsUnique = kFALSE;}
+   
+   const Double_t*   GetField() const {return fField;}
+   const Double_t*   GetDaughterField(const Int_t daughterIndex) const {return &fDaughterFields[3*daughterIndex];}
+};
+
+#endif /*VOLUMEGRAVITY_H*/
@@ -0,0 +1,60 @@
+// VolumeTree class
+// Bounding volume hierarchy over the daughters of a single geometry volume
+
+#ifndef VOLUMETREE_H
+#define VOLUMETREE_H
+
+#include <vector>
+
+#include "TObject.h"
+
+class TGeoVolume;
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    VolumeTree - Bounding volume hierarchy over the bounding boxes of    //
+//    the daughters of a volume, expressed in the volume's own frame.      //
+//    Used to pick out the few daughters that a step could reach, before   //
+//    solving for the time to each of them. Built once when the geometry   //
+//    is loaded, and only read afterwards, so it can be shared between     //
+//    propagation threads. Can also be built over any list of boxes, such  //
+//    as the regions of a set of fields.                                   //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+class VolumeTree
+{
+public:
+   // -- Largest number of daughters held in a leaf of the tree
+   static const Int_t kLeafSize = 4;
+   
+private:
+   struct TreeNode {
+      Double_t fLower[3];  // Bounding box of all daughters below this node
+      Double_t fUpper[3];
+      Int_t fLeft;         // Index of the children in fNodes, or -1 for a leaf
+      Int_t fRight;
+      Int_t fFirst;        // Leaf's daughters are fDaughters[fFirst, fFirst+fCount)
+      Int_t fCount;
+   };
+   
+   std::vector<TreeNode> fNodes;       // fNodes[0] is the root
+   std::vector<Int_t> fDaughters;      // Daughter indices, grouped by leaf
+   std::vector<Double_t> fBounds;      // Lower and upper corners of each daughter's box
+   
+   void        Build();
+   Int_t       BuildNode(const Int_t first, const Int_t count);
+   
+public:
+   // -- Constructors
+   VolumeTree();
+   explicit VolumeTree(const TGeoVolume& volume);
+   explicit VolumeTree(const std::vector<Double_t>& bounds);
+   
+   // -- Methods
+   Int_t       NumDaughters() const {return static_cast<Int_t>(fDaughters.size());}
+   void        FindCandidates(const Double_t* lower, const Double_t* upper,
+                              std::vector<Int_t>& candidates) const;
+};
+
+#endif /*VOLUMETREE_H*/
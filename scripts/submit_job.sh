@@ -15,12 +15,14 @@
 # -- Fetch arguments from command line
 # -- $# stores the number of comman line arguments passed to shell script
 # -- Arguments accessed by $1, $2, $3...
-if [ "$#" -ne 2 ] ; then
+# -- An optional third argument, k/n, runs only the kth of n shards of the run
+if [ "$#" -ne 2 ] && [ "$#" -ne 3 ] ; then
    echo "Incorrect number of command line arguments: $@ passed to submit_job.sh" 1>&2
    exit 1
 else
    export CONFIG_FILE="$1"
    export RUN_NUM="$2"
+   export SHARD="$3"
 fi
 #
 # -- Setup the required environment variables on machine
@@ -50,7 +52,12 @@ echo "------------------------------------------------------------------------"
 #
 # -- Start Job
 echo "Simulating Run No: $RUN_NUM"
-simulate_ucn $CONFIG_FILE $RUN_NUM
+if [ -n "$SHARD" ] ; then
+   echo "Shard: $SHARD"
+   simulate_ucn $CONFIG_FILE $RUN_NUM --shard $SHARD
+else
+   simulate_ucn $CONFIG_FILE $RUN_NUM
+fi
 #
 echo 'Job Ended Here!'
 exit 0
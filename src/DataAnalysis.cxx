@@ -40,6 +40,7 @@
 #include "BounceData.h"
 #include "FieldData.h"
 #include "ParticleManifest.h"
+#include "ParticleColumns.h"
 
 #include "Algorithms.h"
 #include "ValidStates.h"
@@ -457,24 +458,42 @@ void FinalStates::PlotFinalState(const std::string state, const std::vector<int>
    timeHist->SetXTitle("Time (s)");
    timeHist->SetYTitle("Neutrons");
    //////////////////////////////////////////////////////////////////////////////////////
-   // Fetch the 'final' state branch from the data tree, and prepare to read particles from it 
-   Particle* particle = new Particle();
-   TBranch* particleBranch = DataFile::GetParticleBranch(state, dataTree);
-   dataTree->SetBranchAddress(particleBranch->GetName(), &particle);
-   // Loop over all selected particles 
-   BOOST_FOREACH(int particleIndex, particleIndexes) {
-      // Extract Final Particle State Data
-      particleBranch->GetEntry(particleIndex);
-      // Fill Histograms
-      thetaHist->Fill((particle->Theta()*180.0)/TMath::Pi());
-      phiHist->Fill((particle->Phi()*180.0)/TMath::Pi());
-      energyHist->Fill(particle->V());
-      vxHist->Fill(particle->Vx());
-      vyHist->Fill(particle->Vy());
-      vzHist->Fill(particle->Vz());
-      timeHist->Fill(particle->T());
+   // If the file has columnar output, read just the time and velocity of each particle
+   const string branchName = (state == States::initial ? States::initial : States::final);
+   ParticleColumns columns;
+   if (columns.Attach(*dataTree, branchName, "t,vx,vy,vz") == kTRUE) {
+      BOOST_FOREACH(int particleIndex, particleIndexes) {
+         columns.GetEntry(particleIndex);
+         const TVector3 vel = columns.GetVelocity();
+         // Fill Histograms
+         thetaHist->Fill((vel.Theta()*180.0)/TMath::Pi());
+         phiHist->Fill((vel.Phi()*180.0)/TMath::Pi());
+         energyHist->Fill(vel.Mag());
+         vxHist->Fill(vel.X());
+         vyHist->Fill(vel.Y());
+         vzHist->Fill(vel.Z());
+         timeHist->Fill(columns.T());
+      }
+   } else {
+      // Otherwise fetch the 'final' state branch from the data tree, and read whole particles from it 
+      Particle* particle = new Particle();
+      TBranch* particleBranch = DataFile::GetParticleBranch(state, dataTree);
+      dataTree->SetBranchAddress(particleBranch->GetName(), &particle);
+      // Loop over all selected particles 
+      BOOST_FOREACH(int particleIndex, particleIndexes) {
+         // Extract Final Particle State Data
+         particleBranch->GetEntry(particleIndex);
+         // Fill Histograms
+         thetaHist->Fill((particle->Theta()*180.0)/TMath::Pi());
+         phiHist->Fill((particle->Phi()*180.0)/TMath::Pi());
+         energyHist->Fill(particle->V());
+         vxHist->Fill(particle->Vx());
+         vyHist->Fill(particle->Vy());
+         vzHist->Fill(particle->Vz());
+         timeHist->Fill(particle->T());
+      }
+      delete particle; particle = NULL;
    }
-   delete particle; particle = NULL;
    //////////////////////////////////////////////////////////////////////////////////////
    // -- Draw Histograms
    // Time Distribution
@@ -1108,15 +1127,7 @@ bool Polarisation::CalculateT2(TFile& dataFile, std::vector<std::string> stateNa
       cout << "Written graph: " << alphaT2->GetName() << " to file" << endl;
    }
    // Fit exponential to Graph
-   int numParams = 2;
-   TF1* expo = new TF1("Exponential", FitFunctions::ExponentialDecay, 0.0, runTime, numParams);
-   expo->SetParNames("Amplitude","Decay lifetime");
-   expo->SetParameters(1.0,1.0);
-   alphaT2->Fit(expo, "RQ");
-   // Extract T2
-   t2 = expo->GetParameter(1);
-   t2error = expo->GetParError(1);
-   cout << "T2: " << t2 << "\t Error: " << t2error << endl;
+   Polarisation::FitT2(*alphaT2, runTime, t2, t2error);
    // Clean up
    delete alphaT2;
    delete alphaT2canvas;
@@ -1130,11 +1141,6 @@ TGraph* Polarisation::CreateT2AlphaGraph(vector<TDirectory*> stateDirs, double r
    string stateName = "";//DataFile::ConcatenateStateNames(stateDirs);
    //////////////////////////////////////////////////////////////////////////////////////
    // -- Define Histograms
-   // Define axes of coordinate system
-   const TVector3 xAxis(1.0,0.0,0.0);
-   const TVector3 yAxis(0.0,1.0,0.0);
-   const TVector3 zAxis(0.0,0.0,1.0);      
-   //////////////////////////////////////////////////////////////////////////////////////
    TH1F time_data("T2 Time Data","T2 Time Data", intervals, 0.0, runTime);
    vector<vector<Coords> > phase_data;
    TGraph* alphaT2 = new TGraph(intervals);
@@ -1171,38 +1177,14 @@ TGraph* Polarisation::CreateT2AlphaGraph(vector<TDirectory*> stateDirs, double r
                   // -- Extract Spin Observer Data if recorded
                   const SpinData* data = dynamic_cast<const SpinData*>(objKey->ReadObj());
                   assert(data->size() == intervals);
-                  // Create storage for this particle's phase information
-                  vector<Coords> phases;
-                  // Loop over spin data recorded for particle
+                  // Bin the time of each measurement in the histogram 
                   SpinData::const_iterator dataIter;
                   for (dataIter = data->begin(); dataIter != data->end(); dataIter++) {
-                     // Bin the time in the histogram 
                      time_data.Fill(dataIter->first);
-                     // -- For a holding Field aligned along the X-Axis, we want to find the
-                     // -- phase of the spin in the Y-Z plane. 
-                     const Spin* spin = dataIter->second;
-                     // Calculate probability of spin up along Y axis
-                     double yprob = spin->CalculateProbSpinUp(yAxis);
-                     // Calculate probability of spin up along Z axis
-                     double zprob = spin->CalculateProbSpinUp(zAxis);
-                     // Remap probabilities, [0,1] into a unit vector in the y-z plane [-1,1] 
-                     double ycoord = (2.0*yprob - 1.0);
-                     double zcoord = (2.0*zprob - 1.0);
-                     // Normalize vector
-                     double mag = ycoord*ycoord + zcoord*zcoord;
-                     assert(Algorithms::Precision::IsNotEqual(mag,0.0));
-                     ycoord = ycoord/mag;
-                     zcoord = zcoord/mag;
-                     // Calculate theta
-                     double theta = TMath::ATan2(zcoord,ycoord);
-                     // Store the current coordinates on the unit circle in the y-z plane
-                     Coords currentCoords;
-                     currentCoords.fSinTheta = zcoord;
-                     currentCoords.fCosTheta = ycoord;
-                     currentCoords.fTheta = theta;
-                     // Add set of y-z coords to list
-                     phases.push_back(currentCoords);
                   }
+                  // Calculate this particle's phase at each measurement
+                  vector<Coords> phases;
+                  Polarisation::CalculatePhases(*data, phases);
                   // Store particle's phases
                   phase_data.push_back(phases);
                   delete data;
@@ -1216,19 +1198,116 @@ TGraph* Polarisation::CreateT2AlphaGraph(vector<TDirectory*> stateDirs, double r
    Analysis::Polarisation::PlotPhaseAngleSnapShots(phase_data,intervals);
    //////////////////////////////////////////////////////////////////////////////////////
    // -- Calculate the polarisation, alpha, at each measurement interval
+   vector<double> times;
+   for (unsigned int intervalNum = 0; intervalNum < intervals; intervalNum++) {
+      times.push_back(time_data.GetBinLowEdge(intervalNum));
+   }
+   Polarisation::FillAlphaGraph(*alphaT2, phase_data, times);
+   return alphaT2;
+}
+
+//_____________________________________________________________________________
+bool Polarisation::CalculateT2(const std::vector<const SpinData*>& spinData, const double runTime, const double spinMeasInterval, double& t2, double& t2error)
+{
+   // -- Calculate T2 directly from the spin measurements of a set of particles, such as
+   // -- those produced by replaying recorded trajectories, rather than from a data file.
+   // -- Particles that were not measured at every interval are left out.
+   if (spinMeasInterval <= 0 || runTime <= 0) {
+      cerr << "Invalid RunTime or SpinMeasInterval" << endl;
+      return false;
+   }
+   const unsigned int intervals = 1 + runTime/spinMeasInterval;
+   vector<vector<Coords> > phase_data;
+   vector<const SpinData*>::const_iterator dataIter;
+   for (dataIter = spinData.begin(); dataIter != spinData.end(); dataIter++) {
+      if ((*dataIter)->size() < intervals) continue;
+      vector<Coords> phases;
+      Polarisation::CalculatePhases(**dataIter, phases);
+      phase_data.push_back(phases);
+   }
+   if (phase_data.empty()) {
+      cerr << "No particles were measured over the whole run" << endl;
+      return false;
+   }
+   if (phase_data.size() < spinData.size()) {
+      cout << "Left out " << spinData.size() - phase_data.size() << " of " << spinData.size();
+      cout << " particles that were not measured at every interval" << endl;
+   }
+   vector<double> times;
+   for (unsigned int intervalNum = 0; intervalNum < intervals; intervalNum++) {
+      times.push_back(intervalNum*spinMeasInterval);
+   }
+   TGraph alphaT2(intervals);
+   alphaT2.SetName("T2_Polarisation");
+   Polarisation::FillAlphaGraph(alphaT2, phase_data, times);
+   return Polarisation::FitT2(alphaT2, runTime, t2, t2error);
+}
+
+//_____________________________________________________________________________
+void Polarisation::CalculatePhases(const SpinData& data, vector<Coords>& phases)
+{
+   // -- For a holding Field aligned along the X-Axis, find the phase of the spin in the
+   // -- Y-Z plane at each measurement recorded in 'data', in order of time
+   const TVector3 yAxis(0.0,1.0,0.0);
+   const TVector3 zAxis(0.0,0.0,1.0);
+   SpinData::const_iterator dataIter;
+   for (dataIter = data.begin(); dataIter != data.end(); dataIter++) {
+      const Spin* spin = dataIter->second;
+      // Calculate probability of spin up along Y axis
+      double yprob = spin->CalculateProbSpinUp(yAxis);
+      // Calculate probability of spin up along Z axis
+      double zprob = spin->CalculateProbSpinUp(zAxis);
+      // Remap probabilities, [0,1] into a unit vector in the y-z plane [-1,1] 
+      double ycoord = (2.0*yprob - 1.0);
+      double zcoord = (2.0*zprob - 1.0);
+      // Normalize vector
+      double mag = ycoord*ycoord + zcoord*zcoord;
+      assert(Algorithms::Precision::IsNotEqual(mag,0.0));
+      ycoord = ycoord/mag;
+      zcoord = zcoord/mag;
+      // Calculate theta
+      double theta = TMath::ATan2(zcoord,ycoord);
+      // Store the current coordinates on the unit circle in the y-z plane
+      Coords currentCoords;
+      currentCoords.fSinTheta = zcoord;
+      currentCoords.fCosTheta = ycoord;
+      currentCoords.fTheta = theta;
+      // Add set of y-z coords to list
+      phases.push_back(currentCoords);
+   }
+}
+
+//_____________________________________________________________________________
+void Polarisation::FillAlphaGraph(TGraph& alphaT2, vector<vector<Coords> >& phase_data, const vector<double>& times)
+{
+   // -- Calculate the polarisation, alpha, at each measurement interval and add it to the graph
    cout << setw(12) << "IntervalNum" << "\t" << setw(12) << "Alpha";
    cout << setw(12) << "Mean Phase" << "\t" << "Old Mean Phase" << endl;
-   for (unsigned int intervalNum = 0; intervalNum < intervals; intervalNum++) {
+   for (unsigned int intervalNum = 0; intervalNum < times.size(); intervalNum++) {
       double meanPhase = Polarisation::CalculateMeanPhase(phase_data, intervalNum);
       double alpha = Polarisation::CalculateAlpha(phase_data, intervalNum, meanPhase);
-      double timebin = time_data.GetBinLowEdge(intervalNum);
       // Add point to graph
       cout << setw(4) << intervalNum << "\t";
       cout << setw(12) << "Alpha: " << setw(6) << alpha << "\t";
       cout << setw(12) << "Mean Phase: " << setw(6) << meanPhase*180.0/TMath::Pi() << "\t";
-      alphaT2->SetPoint(intervalNum, timebin, alpha);
+      alphaT2.SetPoint(intervalNum, times[intervalNum], alpha);
    }
-   return alphaT2;
+}
+
+//_____________________________________________________________________________
+bool Polarisation::FitT2(TGraph& alphaT2, const double runTime, double& t2, double& t2error)
+{
+   // -- Fit an exponential decay to the polarisation over time, and extract T2
+   int numParams = 2;
+   TF1 expo("Exponential", FitFunctions::ExponentialDecay, 0.0, runTime, numParams);
+   expo.SetParNames("Amplitude","Decay lifetime");
+   expo.SetParameters(1.0,1.0);
+   const int status = alphaT2.Fit(&expo, "RQN");
+   // Extract T2
+   t2 = expo.GetParameter(1);
+   t2error = expo.GetParError(1);
+   cout << "T2: " << t2 << "\t Error: " << t2error << endl;
+   return (status == 0);
 }
 
 //_____________________________________________________________________________
@@ -13,6 +13,7 @@
 #include "Particle.h"
 #include "Parabola.h"
 #include "Polynomial.h"
+#include "RunStatistics.h"
 
 #include "Box.h"
 
@@ -287,7 +288,7 @@ Double_t Box::TimeFromInsideS(const Double_t* point, const Double_t* velocity, c
 }
 
 //_____________________________________________________________________________
-Double_t Box::TimeFromOutside(const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t /*stepTime*/, const Bool_t onBoundary) const
+Double_t Box::TimeFromOutside(const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t stepTime, const Bool_t onBoundary) const
 {
 	// This method calculates the time of all possible intersections of the particle's future path
 	// with all possible boundaries of the current shape.
@@ -299,6 +300,15 @@ Double_t Box::TimeFromOutside(const Double_t* point, const Double_t* velocity, c
       cout << "-----------------------------" << endl;
       cout << "-- " << this->GetName() << " -- Starting Box::TimeFromOutside " << endl;
 	#endif
+
+	// -- Skip the full calculation if the box cannot be reached within the current step
+	if (stepTime > 0. && Box::ReachesBoxS(point, velocity, field, fDX, fDY, fDZ, fOrigin, stepTime) == kFALSE) {
+		#ifdef VERBOSE_MODE
+			cout << "Box cannot be reached within step time: " << stepTime << endl;
+		   cout << "-----------------------------" << endl;
+      #endif
+		return TGeoShape::Big();
+	}
 	
    // -- Determine the local point in case the box origin is not as the local centre (ie: 0,0,0)
 	// -- (Not sure of why this would ever be the case, but ROOT does allow you to set the origin...)
@@ -519,6 +529,34 @@ Double_t Box::TimeFromOutsideS(const Double_t* point, const Double_t* velocity,
 	}
 }
 
+//_____________________________________________________________________________
+Bool_t Box::ReachesBoxS(const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t dx, const Double_t dy, const Double_t dz, const Double_t *origin, const Double_t stepTime)
+{
+	// Quick test of whether the box can be reached from outside within stepTime. On each axis along
+	// which the point lies outside of the box, the parabola has to cross the nearer face of the box
+	// before the end of the step. If it cannot for any axis, the box is out of reach and there is no
+	// need to compute the actual time to its boundary. Points within tolerance of a face count as
+	// being level with it, so the test never rejects a box that the full calculation could hit.
+	// Each call is counted in the thread's run statistics, if it is recording any.
+	RunStatistics* statistics = RunStatistics::Current();
+	if (statistics) statistics->fShapesTested++;
+	const Double_t boundary[3] = {dx, dy, dz};
+	for (Int_t i = 0; i < 3; i++) {
+		const Double_t localpt = point[i] - origin[i];
+		if (TMath::Abs(localpt) <= boundary[i] + 10.*TGeoShape::Tolerance()) continue;
+		const Double_t face = (localpt > 0. ? boundary[i] : -boundary[i]);
+		const Double_t params[3] = {0.5*field[i], velocity[i], localpt - face};
+		if (Polynomial::Instance()->HasRootInInterval(params, 2, 0., stepTime) == kFALSE) {
+			#ifdef VERBOSE_MODE
+				cout << "Box face on axis " << i << " cannot be reached within step time: " << stepTime << endl;
+			#endif
+			if (statistics) statistics->fShapesCulled++;
+			return kFALSE;
+		}
+	}
+	return kTRUE;
+}
+
 //_____________________________________________________________________________
 Bool_t Box::IsNextPointOnBox(const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t* boundary, const Double_t t) 
 {
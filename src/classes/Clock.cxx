@@ -9,42 +9,59 @@
 using namespace std;
 
 //#define VERBOSE_MODE
-//#define PRINT_CONSTRUCTORS
-
-Clock *Clock::fgClock = NULL;
 
 //______________________________________________________________________________
 Clock::Clock()
       :fTime(0.),
        fRunEnd(0.),
        fMaxStepInterval(0.),
-       fExternalEvents()
+       fNumEvents(0)
 {
    // -- Default constructor
-   #ifdef PRINT_CONSTRUCTORS
-      Info("Clock","Default Constructor");
-   #endif
-   fgClock = this;
+}
+
+//______________________________________________________________________________
+Clock::Clock(const RunConfig& runConfig)
+      :fTime(0.),
+       fRunEnd(0.),
+       fMaxStepInterval(0.),
+       fNumEvents(0)
+{
+   // -- Constructor. Take the run length and maximum step size from the RunConfig
+   this->Initialise(runConfig);
+}
+
+//______________________________________________________________________________
+Clock::Clock(const Clock& other)
+      :fTime(other.fTime),
+       fRunEnd(other.fRunEnd),
+       fMaxStepInterval(other.fMaxStepInterval),
+       fNumEvents(other.fNumEvents)
+{
+   // -- Copy Constructor
+   for (int i = 0; i < fNumEvents; i++) {fExternalEvents[i] = other.fExternalEvents[i];}
+}
+
+//______________________________________________________________________________
+Clock& Clock::operator=(const Clock& other)
+{
+   // -- Assignment operator
+   if (this != &other) {
+      fTime = other.fTime;
+      fRunEnd = other.fRunEnd;
+      fMaxStepInterval = other.fMaxStepInterval;
+      fNumEvents = other.fNumEvents;
+      for (int i = 0; i < fNumEvents; i++) {fExternalEvents[i] = other.fExternalEvents[i];}
+   }
+   return *this;
 }
 
 //______________________________________________________________________________
 Clock::~Clock()
 { 
    // -- Destructor
-   #ifdef PRINT_CONSTRUCTORS
-      Info("Clock","Destructor");
-   #endif
-   fgClock = NULL;
 }
 
-//_____________________________________________________________________________
-Clock *Clock::Instance()
-{
-// Return pointer to singleton.
-   if (!fgClock) fgClock = new Clock();
-   return fgClock;
-}   
-
 //_____________________________________________________________________________
 bool Clock::Initialise(const RunConfig& runConfig)
 {
@@ -54,42 +71,34 @@ bool Clock::Initialise(const RunConfig& runConfig)
 }
 
 //______________________________________________________________________________
-void Clock::ScheduleEvent(const std::string name, const double interval, const double prevMeasureTime)
+bool Clock::ScheduleEvent(const double interval, const double prevMeasureTime)
 {
-   // -- Add this event to the Clock to be scheduled in Run
-   cout << "Scheduling Event: " << name << "\t" << "Measurement Interval: " << interval << "s" << endl;
-   EventTimer newEvent(name, interval, prevMeasureTime);
-   fExternalEvents.push_back(newEvent);
-}
-
-//______________________________________________________________________________
-bool Clock::CancelEvent(const std::string name)
-{
-   // Remove named event from list
-   vector<EventTimer>::iterator eventIt;
-   for (eventIt = fExternalEvents.begin(); eventIt != fExternalEvents.end(); eventIt++) {
-      if (eventIt->fEventName == name) {
-         fExternalEvents.erase(eventIt);
-         return true;
-      }
-   }
-   return false;
+   // -- Add this event to the Clock to be scheduled during propagation
+   #ifdef VERBOSE_MODE
+      cout << "Scheduling Event - Measurement Interval: " << interval << "s" << endl;
+   #endif
+   if (fNumEvents >= kMaxEvents) return false;
+   fExternalEvents[fNumEvents].fMeasInterval = interval;
+   fExternalEvents[fNumEvents].fPreviousMeas = prevMeasureTime;
+   fNumEvents++;
+   return true;
 }
 
 //______________________________________________________________________________
-double Clock::GetTimeToNextEvent()
+double Clock::GetTimeToNextEventWithin(const double maxInterval)
 {
+   // -- Time until the next external event or the end of the run, if either comes within
+   // -- maxInterval. Otherwise maxInterval.
    // If end of run has been reached
    if (fTime >= fRunEnd) return 0.0;
    // Set next event time to maximum step size permitted
-   double nextInterval = fMaxStepInterval;
+   double nextInterval = maxInterval;
    // Check if we will reach end of run in this time and adjust
    if (fTime + nextInterval >= fRunEnd) {nextInterval = fRunEnd - fTime;}
    // Finally check our list of external events to see if any will occur 
    // within next proposed interval. If so, set nextInterval to the time to this event
-   vector<EventTimer>::iterator eventIt;
-   for (eventIt = fExternalEvents.begin(); eventIt != fExternalEvents.end(); eventIt++) {
-      EventTimer& event = (*eventIt);
+   for (int i = 0; i < fNumEvents; i++) {
+      EventTimer& event = fExternalEvents[i];
       // Check if the event is only measured at a specific frequency
       if (event.fMeasInterval > 0.0) {
          // Update this event's last measurement time if we reached it
@@ -109,8 +118,7 @@ void Clock::Reset()
 {
    fTime = 0.0;
    // Set the time of previous measurement for every external event back to 0
-   vector<EventTimer>::iterator eventIt;
-   for (eventIt = fExternalEvents.begin(); eventIt != fExternalEvents.end(); eventIt++) {
-      eventIt->fPreviousMeas = 0.0;
+   for (int i = 0; i < fNumEvents; i++) {
+      fExternalEvents[i].fPreviousMeas = 0.0;
    }
 }
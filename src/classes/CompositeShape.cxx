@@ -361,9 +361,10 @@ Int_t CompositeShape::GetNmeshVertices() const
 Double_t CompositeShape::TimeFromOutside(const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t stepTime, const Bool_t onBoundary) const
 {
 // Compute the time from outside point to this composite shape along parabola.
-// Check if the bounding box is crossed within the requested distance
-   Double_t tBox = Box::TimeFromOutsideS(point,velocity,field, fDX, fDY, fDZ, fOrigin, onBoundary);
-   if (tBox > stepTime + TGeoShape::Tolerance()) return TGeoShape::Big();
+// Check if the bounding box can be crossed within the requested time. The Union, Subtraction
+// and Intersection nodes below only call on their operands' own TimeFromOutside, so every
+// shape in the tree is culled in the same way.
+   if (Box::ReachesBoxS(point, velocity, field, fDX, fDY, fDZ, fOrigin, stepTime) == kFALSE) return TGeoShape::Big();
    if (fNode) return fNode->TimeFromOutside(point, velocity, field, stepTime, onBoundary);
    return TGeoShape::Big();
 }   
@@ -16,9 +16,13 @@
 
 #include "RunConfig.h"
 #include "Particle.h"
+#include "ParticleColumns.h"
+#include "ParticleReader.h"
+#include "Clock.h"
 #include "Experiment.h"
 #include "MagFieldArray.h"
 #include "ElecFieldArray.h"
+#include "GravField.h"
 #include "ValidStates.h"
 #include "Algorithms.h"
 #include "DataAnalysis.h"
@@ -41,7 +45,11 @@ Data::Data()
    fOutputTree = NULL;
    fInputBranch = NULL;
    fCurrentParticle = NULL;
+   fReader = NULL;
    fOutputManifest = NULL;
+   fOutputBuffer = NULL;
+   fColumnarOutput = kFALSE;
+   fWriteNewCycles = kFALSE;
 }
 
 //_____________________________________________________________________________
@@ -53,7 +61,12 @@ Data::Data(const Data& other)
           fOutputTree(other.fOutputTree),
           fInputBranch(other.fInputBranch),
           fCurrentParticle(other.fCurrentParticle),
+          fReader(NULL),
+          fCompletedIndexes(other.fCompletedIndexes),
           fOutputManifest(other.fOutputManifest),
+          fOutputBuffer(other.fOutputBuffer),
+          fColumnarOutput(other.fColumnarOutput),
+          fWriteNewCycles(other.fWriteNewCycles),
           fObservers(other.fObservers)
 {
    // Copy Constructor
@@ -66,6 +79,7 @@ Data::~Data()
    // -- Destructor
    Info("Data","Destructor");
    fInputBranch = NULL; // Dont delete the branch, let the Tree clean it up
+   if (fReader) delete fReader; fReader = NULL;
    if (fInputTree) fInputTree->Delete(); fInputTree = NULL;
    if (fOutputTree) fOutputTree->Delete(); fOutputTree = NULL;
    if (fCurrentParticle) delete fCurrentParticle; fCurrentParticle = NULL;
@@ -76,11 +90,12 @@ Data::~Data()
 }
 
 //_____________________________________________________________________________
-Bool_t Data::Initialise(const RunConfig& runConfig)
+Bool_t Data::Initialise(const RunConfig& runConfig, const Bool_t resume)
 {
    // -- Open the output file, load the initial particles from the input file
    // -- and write the particle tree, as well as a copy of the runconfig to the
-   // -- output file
+   // -- output file. If resuming, carry on with the output saved at the output
+   // -- file's last checkpoint instead.
    
    ///////////////////////////////////////////////////////////////////////
    // -- Open the file holding the initial particle tree
@@ -98,16 +113,87 @@ Bool_t Data::Initialise(const RunConfig& runConfig)
    }
    // Open Output File
    const string outputFileName = runConfig.OutputFileName();
-   fOutputFile = Analysis::DataFile::OpenRootFile(outputFileName, "RECREATE");
-   if (fOutputFile == NULL) return false;
-   // Create the Output Tree and Output Particle Manifest
-   fOutputTree = new TTree("Particles","Tree of Particle Data");
-   fOutputManifest = new ParticleManifest();
+   if (resume == kTRUE) {
+      if (this->ReopenOutput(outputFileName) == kFALSE) return false;
+   } else {
+      fOutputFile = Analysis::DataFile::OpenRootFile(outputFileName, "RECREATE");
+      if (fOutputFile == NULL) return false;
+      // Create the Output Tree and Output Particle Manifest
+      fOutputTree = new TTree("Particles","Tree of Particle Data");
+      fOutputManifest = new ParticleManifest();
+   }
+   fColumnarOutput = runConfig.ColumnarOutput();
+   // When checkpointing, the tree is only saved along with the checkpoint, so that the two
+   // always agree
+   if (runConfig.CheckpointParticles() > 0 || runConfig.CheckpointMinutes() > 0) {
+      fOutputTree->SetAutoSave(0);
+   }
    // Store pointer to the current 'in-memory' Particle
    fCurrentParticle = new Particle();
    return true;
 }
 
+//_____________________________________________________________________________
+Bool_t Data::ReopenOutput(const string& outputFileName)
+{
+   // -- Reopen the output of an interrupted run, as it was at its last checkpoint
+   fOutputFile = Analysis::DataFile::OpenRootFile(outputFileName, "UPDATE");
+   if (fOutputFile == NULL) return kFALSE;
+   Listing* checkpoint = NULL;
+   fOutputFile->GetObject("Checkpoint", checkpoint);
+   fOutputFile->GetObject("Particles", fOutputTree);
+   fOutputManifest = this->ReadInParticleManifest(fOutputFile);
+   if (checkpoint == NULL || fOutputTree == NULL || fOutputManifest == NULL) {
+      Error("ReopenOutput","No checkpoint to resume from in %s", outputFileName.c_str());
+      if (checkpoint) delete checkpoint;
+      return kFALSE;
+   }
+   fCompletedIndexes = checkpoint->GetTreeIndexes();
+   delete checkpoint;
+   // Everything written after the checkpoint is lost, so the tree and manifest saved with it
+   // must hold exactly the particles it lists
+   const TBranch* initialBranch = fOutputTree->GetBranch(States::initial.c_str());
+   const Long64_t savedParticles = (initialBranch == NULL ? 0 : initialBranch->GetEntries());
+   if (savedParticles != static_cast<Long64_t>(fCompletedIndexes.size()) ||
+       fOutputManifest->GetListing(States::initial).Entries() != fCompletedIndexes.size()) {
+      Error("ReopenOutput","Checkpoint lists %i particles, but the tree holds %lli",
+            static_cast<Int_t>(fCompletedIndexes.size()), savedParticles);
+      return kFALSE;
+   }
+   cout << "Resuming from checkpoint after " << fCompletedIndexes.size() << " particles" << endl;
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t Data::Checkpoint(const vector<int>& completedIndexes)
+{
+   // -- Save the output so far, so that the run can be resumed from here. 'completedIndexes'
+   // -- are the input indexes of every particle written out, in the order they were written.
+   // -- The 'PerRun' observers must hold the data of exactly those particles.
+   Listing checkpoint("Checkpoint");
+   const vector<int> ids = fOutputManifest->GetListing(States::initial).GetParticleIDs();
+   if (ids.size() != completedIndexes.size()) {
+      Error("Checkpoint","%i particles completed, but %i written", static_cast<Int_t>(completedIndexes.size()),
+            static_cast<Int_t>(ids.size()));
+      return kFALSE;
+   }
+   for (size_t i = 0; i < ids.size(); i++) {checkpoint.AddEntry(ids[i], completedIndexes[i]);}
+   // Write the manifest, the 'PerRun' observers' data and the checkpoint as new cycles, then
+   // flush the tree's baskets and header and save the file's list of keys. Until that list is
+   // saved, the one on disk still points at the previous checkpoint's cycles, which are left
+   // untouched, so a crash at any point leaves one whole checkpoint to resume from. Only then
+   // are the previous cycles purged.
+   fWriteNewCycles = kTRUE;
+   this->WriteObjectToFile(fOutputManifest);
+   this->WriteRunObservers();
+   this->WriteObjectToFile(&checkpoint);
+   fWriteNewCycles = kFALSE;
+   fOutputTree->AutoSave("SaveSelf");
+   fOutputFile->Purge();
+   fOutputFile->SaveSelf(kTRUE);
+   return kTRUE;
+}
+
 //_____________________________________________________________________________
 vector<int> Data::GetListOfParticlesToLoad(const RunConfig& runConfig)
 {
@@ -160,13 +246,22 @@ vector<int> Data::GetSelectedParticleIndexes(const ParticleManifest& manifest, c
    // -- Check RunConfig for whether to load all the particles in this state, or 
    // -- only a subset of these particles, chosen by the User
    Bool_t loadAllParticles = runConfig.LoadAllParticles();
+   vector<int> selectedIndexes = availableIndexes;
    if (loadAllParticles != true) {
       // Get the User-defined particle IDs they wish to propagte
-      vector<int> selectedIndexes = runConfig.SelectedParticleIDs();
+      selectedIndexes = runConfig.SelectedParticleIDs();
       CheckSelectedIndexList(selectedIndexes, availableIndexes);
-      return selectedIndexes;
    }
-   return availableIndexes;
+   ///////////////////////////////////////////////////////////////////////
+   // -- If the run is split into shards, keep only this shard's consecutive block of the
+   // -- selected particles, so that the shards' outputs can be merged back in order
+   size_t first = 0, last = 0;
+   if (runConfig.ShardRange(selectedIndexes.size(), first, last) == true) {
+      cout << "Propagating shard " << runConfig.ShardName() << ": " << last - first << " of the ";
+      cout << selectedIndexes.size() << " selected particles, from position " << first << endl;
+      selectedIndexes = vector<int>(selectedIndexes.begin() + first, selectedIndexes.begin() + last);
+   }
+   return selectedIndexes;
 }
 
 //_____________________________________________________________________________
@@ -319,6 +414,15 @@ void Data::CreateObservers(const RunConfig& runConfig, Experiment& experiment)
       // Add observer to the list
       this->AddObserver(Categories::PerTrack, Subjects::Particles, obs);
    }
+   if (runConfig.ObserveTrajectory() == kTRUE) {
+      // Create an observer to record the path of each UCN, for replaying its spin later
+      const GravField* gravField = experiment.GetGravField();
+      const TVector3 gravity = (gravField == NULL ? TVector3() :
+                                TVector3(gravField->Gx(), gravField->Gy(), gravField->Gz()));
+      Observer* obs = new TrajectoryObserver("TrajectoryObserver", gravity);
+      // Add observer to the list
+      this->AddObserver(Categories::PerTrack, Subjects::Particles, obs);
+   }
    // -- Attach observers to parts of the experiment
    if (runConfig.ObserveField() == kTRUE) {
       // Create an observer to record field seen by spin
@@ -368,17 +472,18 @@ void Data::AddObserver(const string category, const string subject, Observer* ob
 }
 
 //______________________________________________________________________________
-void Data::RegisterObservers(Particle* particle)
+void Data::RegisterObservers(Particle* particle, Clock& clock)
 {
-   // -- Attach to particle the relevant observers
+   // -- Attach to particle the relevant observers, and schedule their measurements on the
+   // -- particle's clock
    ObserverCategories::iterator categoryIter;
    for(categoryIter = fObservers.begin(); categoryIter != fObservers.end(); ++categoryIter) {
       const string category = categoryIter->first;
       ObserverList& observerList = categoryIter->second;
       if (category == Categories::PerTrack) {
-         AttachObservers(observerList, particle);
+         AttachObservers(observerList, particle, clock);
       } else if (category == Categories::PerRun) {
-         AttachObservers(observerList, particle);
+         AttachObservers(observerList, particle, clock);
       } else {
          cerr << "Error: An observer category, " << category << " has been added that is not recognised." << endl;
          throw runtime_error("Unsure how to handle this observer");
@@ -420,7 +525,69 @@ void Data::ResetObservers()
 }
 
 //______________________________________________________________________________
-void Data::AttachObservers(ObserverList& observerList, Particle* particle)
+void Data::MergeObservers(const Data& other)
+{
+   // -- Add the data of another Data's 'PerRun' observers into the matching observers held here.
+   // -- Used to combine the observers of each worker thread at the end of a run.
+   ObserverCategories::iterator categoryIter = fObservers.find(Categories::PerRun);
+   ObserverCategories::const_iterator otherCategoryIter = other.fObservers.find(Categories::PerRun);
+   if (categoryIter == fObservers.end() || otherCategoryIter == other.fObservers.end()) return;
+   ObserverList& observerList = categoryIter->second;
+   const ObserverList& otherObserverList = otherCategoryIter->second;
+   ObserverList::iterator observerIter;
+   for(observerIter = observerList.begin(); observerIter != observerList.end(); ++observerIter) {
+      Observer* observer = observerIter->second;
+      ObserverList::const_iterator otherIter;
+      for(otherIter = otherObserverList.begin(); otherIter != otherObserverList.end(); ++otherIter) {
+         if (string(otherIter->second->GetName()) == observer->GetName()) {
+            observer->Merge(*(otherIter->second));
+         }
+      }
+   }
+}
+
+//______________________________________________________________________________
+void Data::ResetRunObservers()
+{
+   // -- Clear the data of the 'PerRun' observers, once it has been merged into another Data's
+   ObserverCategories::iterator categoryIter = fObservers.find(Categories::PerRun);
+   if (categoryIter == fObservers.end()) return;
+   ObserverList& observerList = categoryIter->second;
+   ObserverList::iterator observerIter;
+   for(observerIter = observerList.begin(); observerIter != observerList.end(); ++observerIter) {
+      observerIter->second->ResetData();
+   }
+}
+
+//______________________________________________________________________________
+void Data::WriteRunObservers()
+{
+   // -- Write out the data of the 'PerRun' observers, as recorded so far
+   ObserverCategories::iterator categoryIter = fObservers.find(Categories::PerRun);
+   if (categoryIter == fObservers.end()) return;
+   ObserverList& observerList = categoryIter->second;
+   ObserverList::iterator observerIter;
+   for(observerIter = observerList.begin(); observerIter != observerList.end(); ++observerIter) {
+      observerIter->second->WriteToFile(*this);
+   }
+}
+
+//______________________________________________________________________________
+void Data::RestoreRunObservers()
+{
+   // -- When resuming a run, add the data the 'PerRun' observers had recorded at the
+   // -- checkpoint back into them
+   ObserverCategories::iterator categoryIter = fObservers.find(Categories::PerRun);
+   if (categoryIter == fObservers.end()) return;
+   ObserverList& observerList = categoryIter->second;
+   ObserverList::iterator observerIter;
+   for(observerIter = observerList.begin(); observerIter != observerList.end(); ++observerIter) {
+      observerIter->second->RestoreFromFile(*this);
+   }
+}
+
+//______________________________________________________________________________
+void Data::AttachObservers(ObserverList& observerList, Particle* particle, Clock& clock)
 {
    ObserverList::iterator observerIter;
    for(observerIter = observerList.begin(); observerIter != observerList.end(); ++observerIter) {
@@ -442,8 +609,10 @@ void Data::AttachObservers(ObserverList& observerList, Particle* particle)
          cerr << "Error: An observer subject, " << subject << " has been added that is not recognised." << endl;
          throw runtime_error("Unsure how to handle this observer");
       }
+      // Register the observer's periodic measurements with the particle's clock
+      observer->ScheduleMeasurements(clock);
       // Get observers to make a measurement of the initial state of their subjects
-      observer->RecordEvent(particle->GetPoint(), particle->GetVelocity(), Context::Creation);
+      observer->RecordEvent(particle->GetPoint(), particle->GetVelocity(), Context::Creation, clock);
    }
 }
 
@@ -452,11 +621,14 @@ Bool_t Data::SaveInitialParticle(Particle* particle)
 {
    // Detach observers
    particle->DetachAll();
+   // If buffering, hold a copy of the particle to be written out later
+   if (fOutputBuffer != NULL) {
+      BufferedObject entry = {States::initial, States::initial, new Particle(*particle)};
+      fOutputBuffer->push_back(entry);
+      return true;
+   }
    // Write Particle to output branch
-   this->WriteObjectToTree(particle, States::initial.c_str());
-   // Update Manifest
-   int branchIndex = fOutputTree->GetBranch(States::initial.c_str())->GetEntries() - 1;
-   fOutputManifest->AddEntry(States::initial, particle->Id(), branchIndex);
+   this->WriteParticleToTree(particle, States::initial, States::initial);
    return true;
 }
 
@@ -465,11 +637,14 @@ Bool_t Data::SaveFinalParticle(Particle* particle, const std::string& state)
 {
    // Detach observers
    particle->DetachAll();
+   // If buffering, hold a copy of the particle to be written out later
+   if (fOutputBuffer != NULL) {
+      BufferedObject entry = {States::final, state, new Particle(*particle)};
+      fOutputBuffer->push_back(entry);
+      return true;
+   }
    // Write Particle to output branch
-   this->WriteObjectToTree(particle, States::final.c_str());
-   // Update Manifest
-   int branchIndex = fOutputTree->GetBranch(States::final.c_str())->GetEntries() - 1;
-   fOutputManifest->AddEntry(state, particle->Id(), branchIndex);
+   this->WriteParticleToTree(particle, States::final, state);
    return true;
 }
 
@@ -489,6 +664,32 @@ Particle* const Data::RetrieveParticle(unsigned int index)
    return fCurrentParticle;
 }
 
+//_____________________________________________________________________________
+Bool_t Data::PrefetchParticles(const std::vector<int>& indexes)
+{
+   // -- Prepare to hand out the particles at the given entries of the input branch, in
+   // -- order, with NextParticle. They are read from the tree in batches.
+   if (fInputBranch == NULL) {
+      Error("PrefetchParticles","No input branch set");
+      return kFALSE;
+   }
+   if (fReader) delete fReader;
+   fReader = new ParticleReader(*fInputTree, *fInputBranch, indexes);
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Particle* Data::NextParticle()
+{
+   // -- Return the next of the particles given to PrefetchParticles, which the caller then
+   // -- owns, or NULL if there are none left or it could not be read
+   if (fReader == NULL) {
+      Error("NextParticle","PrefetchParticles has not been called");
+      return NULL;
+   }
+   return fReader->Next();
+}
+
 //_____________________________________________________________________________
 Bool_t Data::ChecksOut() const
 {
@@ -562,32 +763,42 @@ void Data::Export()
 {
    this->WriteObjectToFile(fOutputTree);
    this->WriteObjectToFile(fOutputManifest);
+   // The run is complete, so there is no longer anything to resume
+   fOutputFile->Delete("Checkpoint;*");
    // Write out any 'PerRun' observers
-   ObserverCategories::iterator categoryIter = fObservers.find(Categories::PerRun);
-   if (categoryIter != fObservers.end()) {
-      ObserverList& observerList = categoryIter->second;
-      ObserverList::iterator observerIter;
-      for(observerIter = observerList.begin(); observerIter != observerList.end(); ++observerIter) {
-         Observer* observer = observerIter->second;
-         observer->WriteToFile(*this);
-      }
-   }
+   this->WriteRunObservers();
 }
 
 //_____________________________________________________________________________
 int Data::WriteObjectToFile(TObject* object)
 {
-   // -- Write a copy of the object to the top level directory of the File
+   // -- Write a copy of the object to the top level directory of the File. While checkpointing,
+   // -- it is written as a new cycle, leaving the previous one in place.
    fOutputFile->cd();
-   int bytesCopied = object->Write(object->GetName(),TObject::kOverwrite);
+   int bytesCopied = object->Write(object->GetName(),(fWriteNewCycles == kTRUE ? 0 : TObject::kOverwrite));
    return bytesCopied;
 }
 
+//_____________________________________________________________________________
+TObject* Data::ReadObjectFromFile(const char* name)
+{
+   // -- Read a copy, owned by the caller, of the named object in the top level directory of
+   // -- the output file. Returns NULL if there is none.
+   if (fOutputFile == NULL) return NULL;
+   return fOutputFile->Get(name);
+}
+
 //_____________________________________________________________________________
 int Data::WriteObjectToTree(TObject* object, const char* branchName)
 {
    // -- Write out the provided data to a branch on the provided tree, named after
    // -- the classname of the data
+   if (fOutputBuffer != NULL) {
+      // -- If buffering, hold a copy of the data to be written out later
+      BufferedObject entry = {branchName, "", object->Clone()};
+      fOutputBuffer->push_back(entry);
+      return 0;
+   }
    TBranch* branch = fOutputTree->GetBranch(branchName);
    if (branch == NULL) {
       // -- If there is no branch yet, create one
@@ -597,4 +808,39 @@ int Data::WriteObjectToTree(TObject* object, const char* branchName)
    fOutputTree->SetBranchAddress(branchName, &object);
    int bytesCopied = branch->Fill();
    return bytesCopied;
-}
\ No newline at end of file
+}
+
+//_____________________________________________________________________________
+Bool_t Data::WriteBufferToTree(ObjectBuffer& buffer)
+{
+   // -- Write out, in order, the objects held in another Data's output buffer, adding any
+   // -- particles to the manifest. The buffer is emptied and its objects deleted.
+   ObjectBuffer::iterator entryIter;
+   for (entryIter = buffer.begin(); entryIter != buffer.end(); ++entryIter) {
+      if (entryIter->fState.empty() == false) {
+         Particle* particle = static_cast<Particle*>(entryIter->fObject);
+         this->WriteParticleToTree(particle, entryIter->fBranchName, entryIter->fState);
+      } else {
+         this->WriteObjectToTree(entryIter->fObject, entryIter->fBranchName.c_str());
+      }
+      delete entryIter->fObject;
+   }
+   buffer.clear();
+   return true;
+}
+
+//_____________________________________________________________________________
+void Data::WriteParticleToTree(Particle* particle, const string& branchName, const string& state)
+{
+   // -- Write the particle to its branch, and its columns alongside if requested, and list
+   // -- its entry in the manifest under 'state'
+   this->WriteObjectToTree(particle, branchName.c_str());
+   if (fColumnarOutput == kTRUE) {
+      ParticleColumns columns;
+      columns.Set(*particle);
+      columns.Fill(*fOutputTree, branchName);
+   }
+   // Update Manifest
+   int branchIndex = fOutputTree->GetBranch(branchName.c_str())->GetEntries() - 1;
+   fOutputManifest->AddEntry(state, particle->Id(), branchIndex);
+}
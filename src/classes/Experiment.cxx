@@ -9,8 +9,11 @@
 
 #include "Run.h"
 #include "ConfigFile.h"
+#include "GravField.h"
 
 #include "TGeoManager.h"
+#include "TGeoVolume.h"
+#include "TGeoNode.h"
 
 using std::cout;
 using std::endl;
@@ -25,7 +28,9 @@ ClassImp(Experiment)
 Experiment::Experiment()
            :TNamed("Experiment", "The Experimental Geometry"),
             fFieldManager(),
-            fGeoManager(NULL)
+            fGeoManager(NULL),
+            fVolumeTrees(),
+            fVolumeGravity()
 {
 // -- Default constructor
    Info("Experiment", "Default Constructor");
@@ -35,7 +40,9 @@ Experiment::Experiment()
 Experiment::Experiment(const Experiment& other)
                :TNamed(other),
                 fFieldManager(other.fFieldManager),
-                fGeoManager(other.fGeoManager)
+                fGeoManager(other.fGeoManager),
+                fVolumeTrees(other.fVolumeTrees),
+                fVolumeGravity(other.fVolumeGravity)
 {
 // -- Copy Constructor
    Info("Experiment", "Copy Constructor");
@@ -68,6 +75,55 @@ Bool_t Experiment::BuildGeometry(const RunConfig& runConfig)
    return kTRUE;
 }
 
+//______________________________________________________________________________
+void Experiment::BuildVolumeTrees()
+{
+// -- Build the tree used to search the daughters of every volume that has any. The trees are
+// -- only read during propagation, so are shared by all of the worker threads.
+   fVolumeTrees.clear();
+   TObjArray* volumes = fGeoManager->GetListOfVolumes();
+   for (Int_t i = 0; i < volumes->GetEntriesFast(); i++) {
+      const TGeoVolume* volume = static_cast<const TGeoVolume*>(volumes->At(i));
+      if (volume == NULL || volume->GetNdaughters() == 0) continue;
+      fVolumeTrees.insert(std::make_pair(volume, VolumeTree(*volume)));
+   }
+}
+
+//______________________________________________________________________________
+void Experiment::BuildVolumeGravity()
+{
+// -- Find the gravitational field in the local frame of every volume, by walking down the
+// -- geometry tree from the top volume. Like the trees, these are only read during propagation.
+   fVolumeGravity.clear();
+   const GravField* const gravField = fFieldManager.GetGravField();
+   if (gravField == NULL) return;
+   const Double_t globalField[3] = {gravField->Gx(), gravField->Gy(), gravField->Gz()};
+   this->AddVolumeGravity(*(fGeoManager->GetTopVolume()), globalField);
+}
+
+//______________________________________________________________________________
+void Experiment::AddVolumeGravity(const TGeoVolume& volume, const Double_t* field)
+{
+// -- Record the field seen by this placement of the volume, and carry on down to its daughters.
+// -- A volume placed in differently oriented frames has no single local field, and is left to
+// -- be transformed on each step.
+   std::map<const TGeoVolume*, VolumeGravity>::iterator gravityIter = fVolumeGravity.find(&volume);
+   if (gravityIter == fVolumeGravity.end()) {
+      fVolumeGravity.insert(std::make_pair(&volume, VolumeGravity(volume, field)));
+   } else if (gravityIter->second.Matches(field) == kTRUE) {
+      // Every volume below this one has already been given this same field
+      return;
+   } else {
+      gravityIter->second.SetAmbiguous();
+   }
+   for (Int_t i = 0; i < volume.GetNdaughters(); i++) {
+      const TGeoNode* daughter = volume.GetNode(i);
+      Double_t localField[3];
+      daughter->MasterToLocalVect(field, localField);
+      this->AddVolumeGravity(*(daughter->GetVolume()), localField);
+   }
+}
+
 //______________________________________________________________________________
 Bool_t Experiment::Initialise(const RunConfig& runConfig)
 {
@@ -83,8 +139,10 @@ Bool_t Experiment::Initialise(const RunConfig& runConfig)
       Error("Initialise","Failed building geometry.");
       return kFALSE;
    }
+   this->BuildVolumeTrees();
    cout << "-------------------------------------------" << endl;
    cout << "Geometry has been created succesfully" << endl;
+   cout << "Built daughter search trees for " << fVolumeTrees.size() << " volumes" << endl;
    cout << "-------------------------------------------" << endl;
    ///////////////////////////////////////////////////////////////////////////////////////
    // -- Field Initialisation
@@ -93,6 +151,8 @@ Bool_t Experiment::Initialise(const RunConfig& runConfig)
       Error("Initialise","Failed in field initialisation.");
       return kFALSE;
    }
+   this->BuildVolumeGravity();
+   cout << "Precomputed the local gravitational field of " << fVolumeGravity.size() << " volumes" << endl;
    return kTRUE;
 }
 
@@ -103,6 +163,9 @@ Bool_t Experiment::Export(Run& run)
    // -- it exists. Else just export the usual Geometry
    string geomFileName = run.GetRunConfig().GeomVisFileName();
    if (geomFileName.empty() == false) {
+      // The trees refer to the volumes of the geometry being replaced
+      fVolumeTrees.clear();
+      fVolumeGravity.clear();
       fGeoManager = TGeoManager::Import(geomFileName.c_str());
       if (fGeoManager == NULL) return kFALSE;
    }
@@ -118,3 +181,21 @@ const TVector3 Experiment::GetMagField(const Point& point, const TVector3& vel,
    return fFieldManager.GetMagField(point,vel,volume);
 }
 
+//______________________________________________________________________________
+const VolumeTree* Experiment::GetVolumeTree(const TGeoVolume* volume) const
+{
+   // -- Return the tree over the daughters of the volume, or NULL if it has none
+   std::map<const TGeoVolume*, VolumeTree>::const_iterator treeIter = fVolumeTrees.find(volume);
+   if (treeIter == fVolumeTrees.end()) return NULL;
+   return &(treeIter->second);
+}
+
+//______________________________________________________________________________
+const VolumeGravity* Experiment::GetVolumeGravity(const TGeoVolume* volume) const
+{
+   // -- Return the gravitational field in the volume's frame and in those of its daughters,
+   // -- or NULL if it has to be transformed on each step
+   std::map<const TGeoVolume*, VolumeGravity>::const_iterator gravityIter = fVolumeGravity.find(volume);
+   if (gravityIter == fVolumeGravity.end() || gravityIter->second.IsUnique() == kFALSE) return NULL;
+   return &(gravityIter->second);
+}
@@ -3,6 +3,9 @@
 
 #include "Field.h"
 #include "FieldVertex.h"
+
+#include "TGeoBBox.h"
+#include "TMath.h"
 //______________________________________________________________________________
 // Field - ABC for magnetic field.
 //
@@ -49,6 +52,13 @@ Field::~Field()
    if(fFieldMatrix) {delete fFieldMatrix; fFieldMatrix = NULL;}
 }
 
+//______________________________________________________________________________
+Bool_t Field::Initialise()
+{
+   // -- Prepare the field for use, once it has been read in from file. Nothing to do by default
+   return kTRUE;
+}
+
 //______________________________________________________________________________
 Bool_t Field::Contains(const TVector3& point) const
 {
@@ -61,6 +71,37 @@ Bool_t Field::Contains(const TVector3& point) const
    return fFieldShape->Contains(localPoint);
 }
 
+//______________________________________________________________________________
+void Field::BoundingBox(Double_t* lower, Double_t* upper) const
+{
+   // -- Box in the global frame that bounds the field's extent, padded by the geometry tolerance
+   // Every TGeoShape is a TGeoBBox, holding the shape's own bounding box
+   const TGeoBBox* shape = static_cast<const TGeoBBox*>(fFieldShape);
+   const Double_t* origin = shape->GetOrigin();
+   const Double_t halfLength[3] = {shape->GetDX(), shape->GetDY(), shape->GetDZ()};
+   for (Int_t axis = 0; axis < 3; axis++) {
+      lower[axis] = TGeoShape::Big();
+      upper[axis] = -TGeoShape::Big();
+   }
+   // Transform the eight corners of the box into the global frame
+   for (Int_t corner = 0; corner < 8; corner++) {
+      Double_t local[3], master[3];
+      for (Int_t axis = 0; axis < 3; axis++) {
+         const Double_t sign = ((corner >> axis) & 1) ? 1.0 : -1.0;
+         local[axis] = origin[axis] + sign*halfLength[axis];
+      }
+      fFieldMatrix->LocalToMaster(local, master);
+      for (Int_t axis = 0; axis < 3; axis++) {
+         lower[axis] = TMath::Min(lower[axis], master[axis]);
+         upper[axis] = TMath::Max(upper[axis], master[axis]);
+      }
+   }
+   for (Int_t axis = 0; axis < 3; axis++) {
+      lower[axis] -= TGeoShape::Tolerance();
+      upper[axis] += TGeoShape::Tolerance();
+   }
+}
+
 //______________________________________________________________________________
 FieldVertex Field::ConvertToGlobalFrame(const FieldVertex& point) const
 {
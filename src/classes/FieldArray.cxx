@@ -4,19 +4,37 @@
 #include <cassert>
 #include <stdexcept>
 
+#include <boost/thread/tss.hpp>
+
 #include "Point.h"
 #include "FieldArray.h"
+#include "VolumeTree.h"
+#include "RunStatistics.h"
 
 //#define VERBOSE_MODE
 
 using namespace std;
 
+namespace {
+   // Scratch list of the fields whose bounding box holds the point, one per thread
+   boost::thread_specific_ptr<vector<Int_t> > gThreadCandidates;
+   
+   vector<Int_t>& ThreadCandidates()
+   {
+      if (gThreadCandidates.get() == NULL) gThreadCandidates.reset(new vector<Int_t>());
+      return *gThreadCandidates;
+   }
+}
+
 ClassImp(FieldArray)
 
 //_____________________________________________________________________________
 FieldArray::FieldArray()
            :TNamed("FieldArray","Field Array"),
-            Observable()
+            Observable(),
+            fSumOverlapping(kFALSE),
+            fRegionFields(),
+            fRegionTree(NULL)
 {
    // Default constructor
    Info("FieldArray", "Default Constructor");
@@ -25,7 +43,10 @@ FieldArray::FieldArray()
 //_____________________________________________________________________________
 FieldArray::FieldArray(const std::string name)
            :TNamed(name,"FieldArray"),
-            Observable()
+            Observable(),
+            fSumOverlapping(kFALSE),
+            fRegionFields(),
+            fRegionTree(NULL)
 {
    // Named Constructor
    Info("FieldArray", "Constructor");
@@ -35,10 +56,14 @@ FieldArray::FieldArray(const std::string name)
 FieldArray::FieldArray(const FieldArray& other)
            :TNamed(other),
             Observable(other),
-            fFieldList(other.fFieldList)
+            fFieldList(other.fFieldList),
+            fSumOverlapping(other.fSumOverlapping),
+            fRegionFields(),
+            fRegionTree(NULL)
 {
    //copy constructor
    Info("FieldArray", "Copy Constructor");
+   this->BuildRegionIndex();
 }
 
 //_____________________________________________________________________________
@@ -47,6 +72,7 @@ FieldArray::~FieldArray()
    // Destructor
    Info("FieldArray", "Destructor");
    this->PurgeFields();
+   if (fRegionTree) delete fRegionTree;
 }
 
 //_____________________________________________________________________________
@@ -65,20 +91,85 @@ void FieldArray::AddField(Field* field)
 {
    // -- Add field to container
    fFieldList.insert(pair<string, Field*>(field->GetName(), field));
+   this->BuildRegionIndex();
 }
 
 //_____________________________________________________________________________
-const TVector3 FieldArray::GetField(const Point& point, const string /*volume*/) const
+void FieldArray::BuildRegionIndex()
 {
-   // -- Determine which field contains the current particle
+   // -- Build the hierarchy over the bounding boxes of the fields, so that a lookup only
+   // -- tests the few fields whose box holds the point
+   if (fRegionTree) delete fRegionTree;
+   fRegionFields.clear();
+   vector<Double_t> bounds;
    FieldContainer::const_iterator fieldIter;
    for(fieldIter = fFieldList.begin(); fieldIter != fFieldList.end(); ++fieldIter) {
-      if (fieldIter->second->Contains(point.GetPosition()) == kTRUE) {
-         return fieldIter->second->GetField(point);
+      Double_t lower[3], upper[3];
+      fieldIter->second->BoundingBox(lower, upper);
+      bounds.insert(bounds.end(), lower, lower + 3);
+      bounds.insert(bounds.end(), upper, upper + 3);
+      fRegionFields.push_back(fieldIter->second);
+   }
+   fRegionTree = new VolumeTree(bounds);
+}
+
+//_____________________________________________________________________________
+Bool_t FieldArray::Initialise()
+{
+   // -- Prepare each field for use, once the array has been read in from file
+   this->BuildRegionIndex();
+   FieldContainer::iterator fieldIter;
+   for(fieldIter = fFieldList.begin(); fieldIter != fFieldList.end(); ++fieldIter) {
+      if (fieldIter->second->Initialise() == kFALSE) {
+         Error("Initialise","Failed to initialise field: %s", fieldIter->first.c_str());
+         return kFALSE;
       }
    }
-   cout << "NO FIELD FOUND!" << endl;
-   point.GetPosition().Print();
-   return TVector3(0.,0.,0.);
+   return kTRUE;
 }
 
+//_____________________________________________________________________________
+const TVector3 FieldArray::GetField(const Point& point, const string /*volume*/) const
+{
+   // -- Determine which field contains the current particle. Only the fields whose bounding
+   // -- box holds the point are tested, in the order of the field list. Either the first field
+   // -- containing the point is used, or the sum of all of them. A point outside every field
+   // -- sees no field, and is counted as a miss.
+   RunStatistics* statistics = RunStatistics::Current();
+   if (statistics) statistics->fFieldLookups++;
+   const TVector3& position = point.GetPosition();
+   TVector3 field(0.,0.,0.);
+   Bool_t found = kFALSE;
+   if (fRegionTree) {
+      const Double_t pos[3] = {position.X(), position.Y(), position.Z()};
+      vector<Int_t>& candidates = ThreadCandidates();
+      fRegionTree->FindCandidates(pos, pos, candidates);
+      vector<Int_t>::const_iterator candidateIter;
+      for (candidateIter = candidates.begin(); candidateIter != candidates.end(); ++candidateIter) {
+         const Field* candidate = fRegionFields[*candidateIter];
+         if (candidate->Contains(position) == kTRUE) {
+            if (fSumOverlapping == kFALSE) return candidate->GetField(point);
+            field += candidate->GetField(point);
+            found = kTRUE;
+         }
+      }
+   } else {
+      // The index is only missing if the array has not been initialised. Test every field.
+      FieldContainer::const_iterator fieldIter;
+      for(fieldIter = fFieldList.begin(); fieldIter != fFieldList.end(); ++fieldIter) {
+         if (fieldIter->second->Contains(position) == kTRUE) {
+            if (fSumOverlapping == kFALSE) return fieldIter->second->GetField(point);
+            field += fieldIter->second->GetField(point);
+            found = kTRUE;
+         }
+      }
+   }
+   if (found == kFALSE) {
+      if (statistics) statistics->fFieldMisses++;
+      #ifdef VERBOSE_MODE
+         cout << "NO FIELD FOUND!" << endl;
+         position.Print();
+      #endif
+   }
+   return field;
+}
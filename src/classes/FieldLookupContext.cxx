@@ -0,0 +1,74 @@
+#include <vector>
+
+#include <boost/thread/tss.hpp>
+
+#include "FieldLookupContext.h"
+
+using namespace std;
+
+namespace {
+   // Contexts of a single thread, one per field map it has looked up
+   typedef vector<FieldLookupContext*> ThreadContexts;
+   
+   void DeleteThreadContexts(ThreadContexts* contexts)
+   {
+      // A thread is exiting, so its contexts will never be used again
+      ThreadContexts::iterator contextIter;
+      for (contextIter = contexts->begin(); contextIter != contexts->end(); ++contextIter) {
+         delete *contextIter;
+      }
+      delete contexts;
+   }
+   boost::thread_specific_ptr<ThreadContexts> gThreadContexts(&DeleteThreadContexts);
+   
+   ThreadContexts& GetThreadContexts()
+   {
+      if (gThreadContexts.get() == NULL) gThreadContexts.reset(new ThreadContexts());
+      return *gThreadContexts;
+   }
+}
+
+//______________________________________________________________________________
+FieldLookupContext::FieldLookupContext(const void* map)
+                   :fMap(map),
+                    fField()
+{
+   // -- Constructor
+   this->Forget();
+}
+
+//______________________________________________________________________________
+void FieldLookupContext::Forget()
+{
+   // -- Discard the last lookup
+   fHasReading = kFALSE;
+   fPosition[0] = fPosition[1] = fPosition[2] = 0.;
+   fLeaf = -1;
+   fCell = -1;
+}
+
+//______________________________________________________________________________
+FieldLookupContext& FieldLookupContext::ForMap(const void* map)
+{
+   // -- Find the calling thread's context for the map, creating it on first use. A thread
+   // -- only ever looks up a handful of maps, so a linear search is quickest.
+   ThreadContexts& contexts = GetThreadContexts();
+   ThreadContexts::iterator contextIter;
+   for (contextIter = contexts.begin(); contextIter != contexts.end(); ++contextIter) {
+      if ((*contextIter)->fMap == map) return **contextIter;
+   }
+   FieldLookupContext* context = new FieldLookupContext(map);
+   contexts.push_back(context);
+   return *context;
+}
+
+//______________________________________________________________________________
+void FieldLookupContext::BeginTrack()
+{
+   // -- A new track starts elsewhere, so nothing the thread last looked up is nearby
+   ThreadContexts& contexts = GetThreadContexts();
+   ThreadContexts::iterator contextIter;
+   for (contextIter = contexts.begin(); contextIter != contexts.end(); ++contextIter) {
+      (*contextIter)->Forget();
+   }
+}
@@ -118,6 +118,18 @@ Bool_t FieldManager::Initialise(const RunConfig& runConfig)
             Error("Initialise","Could not find: %s in file", magManagerName.Data());
             return kFALSE;
          }
+         importedMagFieldArray->SetSumOverlapping(runConfig.SumOverlappingFields());
+         if (importedMagFieldArray->Initialise() == kFALSE) {
+            delete importedMagFieldArray;
+            return kFALSE;
+         }
+         if (runConfig.BakeFieldsOn() == kTRUE) {
+            Info("Initialise","Baking analytic fields to a tolerance of %g", runConfig.BakeTolerance());
+            if (importedMagFieldArray->BakeFields(runConfig.BakeTolerance()) == kFALSE) {
+               delete importedMagFieldArray;
+               return kFALSE;
+            }
+         }
          // Store MagField Manager
          fMagFieldArray = importedMagFieldArray;
          importedMagFieldArray = 0;
@@ -134,6 +146,11 @@ Bool_t FieldManager::Initialise(const RunConfig& runConfig)
             Error("Initialise","Could not find: %s in file", elecFieldArrayName.Data());
             return kFALSE;
          }
+         importedElecFieldArray->SetSumOverlapping(runConfig.SumOverlappingFields());
+         if (importedElecFieldArray->Initialise() == kFALSE) {
+            delete importedElecFieldArray;
+            return kFALSE;
+         }
          // Store ElecField Manager
          fElecFieldArray = importedElecFieldArray;
          importedElecFieldArray = 0;
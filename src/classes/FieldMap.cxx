@@ -2,16 +2,23 @@
 // Author: Matthew Raso-Barnett  13/12/2010
 #include <list>
 #include <cmath>
+#include <algorithm>
 #include <iostream>
 
 #include "FieldMap.h"
 #include "FileParser.h"
-#include "VertexStack.h"
+#include "FieldLookupContext.h"
+#include "RunStatistics.h"
 #include "Particle.h"
 #include "Run.h"
 
 #include "Algorithms.h"
 
+#include "TBuffer.h"
+#include "TGeoBBox.h"
+#include "TGeoMatrix.h"
+#include "TMath.h"
+
 //#define VERBOSE
 
 using namespace std;
@@ -53,7 +60,8 @@ ClassImp(MagFieldMap)
 //_____________________________________________________________________________
 MagFieldMap::MagFieldMap()
             :FieldMap(),
-             fTree(NULL)
+             fTree(NULL),
+             fMapFile()
 {
 // Default constructor.
    Info("MagFieldMap", "Default Constructor");
@@ -63,7 +71,8 @@ MagFieldMap::MagFieldMap()
 MagFieldMap::MagFieldMap(const string& name, const TGeoShape* shape, const TGeoMatrix* matrix)
             :FieldMap(),
              MagField(name, shape, matrix), 
-             fTree(NULL)
+             fTree(NULL),
+             fMapFile()
 {
 // Default constructor.
    Info("MagFieldMap", "Constructor");
@@ -74,7 +83,8 @@ MagFieldMap::MagFieldMap(const string& name, const TGeoShape* shape, const TGeoM
 MagFieldMap::MagFieldMap(const MagFieldMap& other)
             :FieldMap(other), 
              MagField(other),
-             fTree(NULL)
+             fTree(NULL),
+             fMapFile(other.fMapFile)
 {
 // Copy constructor.
    Info("MagFieldMap", "Copy Constructor");
@@ -92,24 +102,57 @@ MagFieldMap::~MagFieldMap()
 const TVector3 MagFieldMap::GetField(const Point& point) const
 {
    // -- Perform interpolation to get current field
+   // Each thread keeps its own record of its current track's last lookup in this map
+   FieldLookupContext& context = FieldLookupContext::ForMap(this);
+   RunStatistics* statistics = RunStatistics::Current();
+   if (statistics) statistics->fMapLookups++;
    // If point requested was recently measured, return its value. Saves recomputing the value
-   static FieldVertex cachedReading;
-   if (cachedReading.GetPoint() == point) {return cachedReading.GetField();}
+   const TVector3& position = point.GetPosition();
+   if (context.fHasReading == kTRUE && context.fPosition[0] == position.X()
+         && context.fPosition[1] == position.Y() && context.fPosition[2] == position.Z()) {
+      if (statistics) statistics->fMapRepeatHits++;
+      return context.fField;
+   }
+   const TVector3 field = this->LookUp(position, context);
+   // Update cached reading before return vale
+   context.fHasReading = kTRUE;
+   context.fPosition[0] = position.X();
+   context.fPosition[1] = position.Y();
+   context.fPosition[2] = position.Z();
+   context.fField = field;
+   return field;
+}
+
+//______________________________________________________________________________
+TVector3 MagFieldMap::LookUp(const TVector3& position, FieldLookupContext& context) const
+{
+   // -- Interpolate from the nearest vertices, starting the search from the leaf of the
+   // -- previous lookup
    // Number of interpolation points is currently an arbitrary number. Need to define this
    // at runtime perhaps through another config variable.
-   Int_t numInterpolatePoints = 6;
-   const TVector3 field = this->Interpolate(point.GetPosition(), numInterpolatePoints);
-   // Update cached reading before return vale
-   cachedReading.SetPoint(point);
-   cachedReading.SetField(field);
+   Bool_t hintSufficed = kFALSE;
+   const TVector3 field = this->Interpolate(position, kNumInterpolatePoints, context.fLeaf, hintSufficed);
+   if (hintSufficed == kTRUE) {
+      RunStatistics* statistics = RunStatistics::Current();
+      if (statistics) statistics->fMapHintHits++;
+   }
    return field;
 }
 
 //______________________________________________________________________________
 Bool_t MagFieldMap::BuildMap(const std::string& filename)
 {
-   // -- Take input file and initialise a KDTree object data structure to hold the field points.
+   // -- Take input file and initialise a FlatKDTree object data structure to hold the field points.
+   // -- A binary map, written by WriteBinaryMap, is mapped in place of being parsed.
+   if (FlatKDTree::IsBinaryFile(filename) == true) {
+      cout << "Mapping MagFieldMap from binary file: " << filename << endl;
+      fMapFile = filename;
+      if (this->Initialise() == kFALSE) return false;
+      cout << "Successfully mapped MagFieldMap of " << fTree->Size() << " points." << endl;
+      return true;
+   }
    cout << "Building MagFieldMap from file: " << filename << endl;
+   fMapFile.clear();
    FileParser parser;
    // Get flat list of Field vertices from provided file using the parser
    vector<FieldVertex*> vertices;
@@ -117,6 +160,93 @@ Bool_t MagFieldMap::BuildMap(const std::string& filename)
       Error("BuildMap","Failed to extract field vertices from: %s", filename.c_str());
       return false;
    }
+   const Bool_t built = this->BuildFromVertices(vertices);
+   // Delete original local points
+   vector<FieldVertex*>::const_iterator iter;
+   for (iter = vertices.begin(); iter != vertices.end(); iter++) {if (*iter) delete *iter;}
+   if (built == kFALSE) {
+      Error("BuildMap","Failed to build field map from: %s", filename.c_str());
+      return false;
+   }
+   cout << "Successfully created MagFieldMap from " << fTree->Size() << " points." << endl;
+   return true;
+}
+
+//______________________________________________________________________________
+Bool_t MagFieldMap::Initialise()
+{
+   // -- A map built from a binary file only stores the file's name, so map the file again
+   // -- once the field has been read in
+   if (fMapFile.empty() == true) {
+      // Maps written before version 2 held the old, pointer-based tree, which cannot be read
+      if (fTree == NULL) Error("Initialise","Field map %s holds no tree. Rebuild it from its source file.", this->GetName());
+      return (fTree != NULL);
+   }
+   if (fTree && fTree->IsMapped()) return kTRUE;
+   if (fTree) delete fTree;
+   fTree = FlatKDTree::Map(fMapFile);
+   if (fTree == NULL) {
+      Error("Initialise","Failed to map field map: %s", fMapFile.c_str());
+      return kFALSE;
+   }
+   // The file's vertices must have been placed where the geometry puts this field
+   Double_t placement[12];
+   this->GetPlacement(placement);
+   const double* filePlacement = fTree->GetPlacement();
+   for (Int_t i = 0; i < 12; i++) {
+      if (TMath::Abs(placement[i] - filePlacement[i]) > 1.0E-9*(1. + TMath::Abs(placement[i]))) {
+         Error("Initialise","Field map %s was converted with a different placement from the field's",
+               fMapFile.c_str());
+         delete fTree;
+         fTree = NULL;
+         return kFALSE;
+      }
+   }
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+void MagFieldMap::GetPlacement(Double_t* placement) const
+{
+   // -- Fill the 12 elements of the field's rotation (row by row) and translation, as
+   // -- recorded in a binary map
+   const Double_t* rotation = GetMatrix().GetRotationMatrix();
+   const Double_t* translation = GetMatrix().GetTranslation();
+   for (Int_t i = 0; i < 9; i++) {placement[i] = rotation[i];}
+   for (Int_t i = 0; i < 3; i++) {placement[9 + i] = translation[i];}
+}
+
+//______________________________________________________________________________
+void MagFieldMap::Streamer(TBuffer& R__b)
+{
+   // -- Stream the map. A tree mapped from a binary file is left out, as only the file's name
+   // -- is needed: Initialise maps the file again once the map has been read back in.
+   if (R__b.IsReading()) {
+      R__b.ReadClassBuffer(MagFieldMap::Class(), this);
+   } else {
+      FlatKDTree* tree = fTree;
+      if (fTree && fTree->IsMapped()) fTree = NULL;
+      R__b.WriteClassBuffer(MagFieldMap::Class(), this);
+      fTree = tree;
+   }
+}
+
+//______________________________________________________________________________
+Bool_t MagFieldMap::WriteBinaryMap(const std::string& filename) const
+{
+   // -- Write the map's vertices, already in the global frame, and its search tree to a binary
+   // -- file that BuildMap can map directly
+   if (fTree == NULL) {
+      Error("WriteBinaryMap","Field map has not been built");
+      return kFALSE;
+   }
+   return fTree->Write(filename);
+}
+
+//______________________________________________________________________________
+Bool_t MagFieldMap::BuildFromVertices(const vector<FieldVertex*>& vertices)
+{
+   // -- Build the kd-tree from the supplied vertices, given in the field's local frame
    // For each vertex, convert coordinates to the global coordinate system
    vector<const FieldVertex*> global_vertices;
    vector<FieldVertex*>::const_iterator iter;
@@ -124,47 +254,533 @@ Bool_t MagFieldMap::BuildMap(const std::string& filename)
       FieldVertex global = this->ConvertToGlobalFrame((**iter));
       global_vertices.push_back(new FieldVertex(global));
    }
-   // Build Tree structure of FieldVertices
-   fTree = new KDTree(global_vertices);
-   // Delete original local points
-   for (iter = vertices.begin(); iter != vertices.end(); iter++) {if (*iter) delete *iter;}
-   cout << "Successfully created MagFieldMap from " << global_vertices.size() << " points." << endl;
-   return true;
+   // Build Tree structure of FieldVertices. The tree keeps its own copy of the vertices
+   if (fTree) delete fTree;
+   fTree = new FlatKDTree(global_vertices);
+   Double_t placement[12];
+   this->GetPlacement(placement);
+   fTree->SetPlacement(placement);
+   // Delete the global points now copied into the tree
+   vector<const FieldVertex*>::const_iterator globalIter;
+   for (globalIter = global_vertices.begin(); globalIter != global_vertices.end(); globalIter++) {
+      delete *globalIter;
+   }
+   return (fTree->Size() > 0);
 }
 
 //______________________________________________________________________________
 TVector3 MagFieldMap::Interpolate(const TVector3& position, const Int_t numInterpolatePoints) const
+{
+   // -- Interpolate without any knowledge of where nearby lookups were
+   Int_t leafHint = -1;
+   Bool_t hintSufficed = kFALSE;
+   return this->Interpolate(position, numInterpolatePoints, leafHint, hintSufficed);
+}
+
+//______________________________________________________________________________
+TVector3 MagFieldMap::Interpolate(const TVector3& position, const Int_t numInterpolatePoints, Int_t& leafHint, Bool_t& hintSufficed) const
 {
    // -- For given position, find the n-nearest-neighbouring vertices (n being numInterpolatePoints)
    // -- and perform IDW interpolation using Modified Shepard's Method,
    // -- http://en.wikipedia.org/wiki/Inverse_distance_weighting
-   FieldVertex vertex(position.X(), position.Y(), position.Z(), 0.,0.,0.,0.);
-   const VertexStack* neighbours = fTree->NearestNeighbours(vertex, numInterpolatePoints);
-   list<StackElement>::const_iterator stackIter;
-   double radius = (neighbours->back()).second;
+   // -- The search starts from the leaf 'leafHint', which is updated to the leaf holding position.
+   // -- 'hintSufficed' is set if the search, working up from that leaf, found the nearest
+   // -- vertices without going back up to the root of the tree.
+   const double point[3] = {position.X(), position.Y(), position.Z()};
+   NeighbourHeap neighbours(numInterpolatePoints);
+   bool sufficed = false;
+   fTree->NearestNeighbours(point, neighbours, leafHint, sufficed);
+   hintSufficed = (sufficed ? kTRUE : kFALSE);
+   // The furthest neighbour sits at the top of the heap
+   double radius = sqrt(neighbours.SquaredDistance(0));
    double sumWeights = 0.;
    TVector3 avgField;
-   for (stackIter = neighbours->begin(); stackIter != neighbours->end(); stackIter++) {
-      double distance = stackIter->second;
-      const FieldVertex* vertex = stackIter->first;
+   for (int i = 0; i < neighbours.Size(); i++) {
+      const int index = neighbours.Index(i);
+      const TVector3 vertexField(fTree->Fx(index), fTree->Fy(index), fTree->Fz(index));
+      double distance = sqrt(neighbours.SquaredDistance(i));
       // If one of the points found is exactly on the requested position, return that
       if (Algorithms::Precision::IsEqual(distance, 0.0)) {
-         delete neighbours;
-         return vertex->GetField();
+         return vertexField;
       }
       // Compute weight for each point
       double weight = pow((radius - distance)/(radius*distance),2.0);
       #ifdef VERBOSE
-         cout << "Vertex: " << vertex->ToString() << "\t";
+         cout << "Vertex: " << fTree->X(index) << ", " << fTree->Y(index) << ", " << fTree->Z(index) << "\t";
          cout << "Distance: " << distance << "\t";
          cout << "Weight: " << weight << endl;
       #endif
       sumWeights += weight;
-      avgField += weight*(vertex->GetField());
+      avgField += weight*vertexField;
    }
    avgField = avgField*(1.0/sumWeights);
-   // Delete nearest neighbours now that we are finished with it
-   delete neighbours;
    return avgField;
 }
 
+//______________________________________________________________________________
+// GridMagFieldMap - 
+//
+//______________________________________________________________________________
+
+ClassImp(GridMagFieldMap)
+
+namespace {
+   // -- Fraction of a grid axis' extent within which coordinates count as the same grid line
+   const Double_t kGridTolerance = 1.0E-6;
+   
+   //______________________________________________________________________________
+   void CatmullRomWeights(const Double_t t, Double_t* weights)
+   {
+      // -- Weights of the points at offsets -1, 0, 1, 2 for a cubic through points 0 and 1
+      const Double_t t2 = t*t, t3 = t2*t;
+      weights[0] = 0.5*(-t3 + 2.0*t2 - t);
+      weights[1] = 0.5*(3.0*t3 - 5.0*t2 + 2.0);
+      weights[2] = 0.5*(-3.0*t3 + 4.0*t2 + t);
+      weights[3] = 0.5*(t3 - t2);
+   }
+}
+
+//_____________________________________________________________________________
+GridMagFieldMap::GridMagFieldMap()
+                :MagFieldMap(),
+                 fInterpolation(kTrilinear),
+                 fGridDeclared(kFALSE),
+                 fIsGrid(kFALSE),
+                 fGridField()
+{
+// Default constructor.
+   Info("GridMagFieldMap", "Default Constructor");
+   for (Int_t axis = 0; axis < 3; axis++) {
+      fGridLower[axis] = 0.; fGridSpacing[axis] = 0.; fGridPoints[axis] = 0;
+   }
+}
+
+//_____________________________________________________________________________
+GridMagFieldMap::GridMagFieldMap(const string& name, const TGeoShape* shape, const TGeoMatrix* matrix,
+                                 const Interpolation interpolation)
+                :MagFieldMap(name, shape, matrix),
+                 fInterpolation(interpolation),
+                 fGridDeclared(kFALSE),
+                 fIsGrid(kFALSE),
+                 fGridField()
+{
+// Constructor.
+   Info("GridMagFieldMap", "Constructor");
+   for (Int_t axis = 0; axis < 3; axis++) {
+      fGridLower[axis] = 0.; fGridSpacing[axis] = 0.; fGridPoints[axis] = 0;
+   }
+}
+
+//_____________________________________________________________________________
+GridMagFieldMap::GridMagFieldMap(const GridMagFieldMap& other)
+                :MagFieldMap(other),
+                 fInterpolation(other.fInterpolation),
+                 fGridDeclared(other.fGridDeclared),
+                 fIsGrid(other.fIsGrid),
+                 fGridField(other.fGridField)
+{
+// Copy constructor.
+   Info("GridMagFieldMap", "Copy Constructor");
+   for (Int_t axis = 0; axis < 3; axis++) {
+      fGridLower[axis] = other.fGridLower[axis];
+      fGridSpacing[axis] = other.fGridSpacing[axis];
+      fGridPoints[axis] = other.fGridPoints[axis];
+   }
+}
+
+//______________________________________________________________________________
+GridMagFieldMap::~GridMagFieldMap()
+{
+// Destructor.
+   Info("GridMagFieldMap", "Destructor");
+}
+
+//______________________________________________________________________________
+void GridMagFieldMap::DeclareGrid(const Double_t* lower, const Double_t* spacing, const Int_t* numPoints)
+{
+   // -- Declare the grid the vertices lie on, in the field's local frame, rather than have it
+   // -- detected from the vertices. Must be called before BuildMap.
+   for (Int_t axis = 0; axis < 3; axis++) {
+      fGridLower[axis] = lower[axis];
+      fGridSpacing[axis] = spacing[axis];
+      fGridPoints[axis] = numPoints[axis];
+   }
+   fGridDeclared = kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t GridMagFieldMap::BuildFromVertices(const vector<FieldVertex*>& vertices)
+{
+   // -- Build the kd-tree, kept for points off the grid, then place the vertices on the grid
+   if (MagFieldMap::BuildFromVertices(vertices) == kFALSE) return kFALSE;
+   this->BuildGrid(vertices);
+   this->PrintGrid(cout);
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t GridMagFieldMap::Initialise()
+{
+   // -- A map built from a binary file has no grid until the file is mapped. Recover the
+   // -- vertices' local positions from the tree to find the grid. A baked map has only its grid.
+   if (fIsGrid == kTRUE && this->GetTree() == NULL) return kTRUE;
+   if (MagFieldMap::Initialise() == kFALSE) return kFALSE;
+   if (fIsGrid == kTRUE || this->GetTree()->IsMapped() == false) return kTRUE;
+   const FlatKDTree& tree = *(this->GetTree());
+   vector<FieldVertex*> vertices;
+   vertices.reserve(tree.Size());
+   for (Int_t i = 0; i < tree.Size(); i++) {
+      const FieldVertex global(tree.X(i), tree.Y(i), tree.Z(i), 0., tree.Fx(i), tree.Fy(i), tree.Fz(i));
+      vertices.push_back(new FieldVertex(this->ConvertToLocalFrame(global)));
+   }
+   this->BuildGrid(vertices);
+   this->PrintGrid(cout);
+   vector<FieldVertex*>::const_iterator iter;
+   for (iter = vertices.begin(); iter != vertices.end(); iter++) {delete *iter;}
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+void GridMagFieldMap::BuildGrid(const vector<FieldVertex*>& vertices)
+{
+   // -- Place the vertices, given in the local frame, on the declared or detected grid. If they
+   // -- do not fill it, the map falls back to scattered interpolation.
+   fIsGrid = kFALSE;
+   fGridField.clear();
+   if (fGridDeclared == kFALSE && this->DetectGrid(vertices) == kFALSE) {
+      Warning("BuildGrid","Vertices of %s do not lie on a regular grid. Using scattered interpolation.", GetName());
+      return;
+   }
+   if (this->FillGrid(vertices) == kFALSE) {
+      Warning("BuildGrid","Vertices of %s do not fill the grid. Using scattered interpolation.", GetName());
+      fGridField.clear();
+      return;
+   }
+   fIsGrid = kTRUE;
+}
+
+//______________________________________________________________________________
+void GridMagFieldMap::PrintGrid(ostream& out) const
+{
+   // -- Describe the grid the vertices were placed on, and how it compares with the kd-tree
+   if (fIsGrid == kFALSE) return;
+   out << "Field map " << GetName() << " lies on a " << fGridPoints[0] << "x" << fGridPoints[1];
+   out << "x" << fGridPoints[2] << " grid" << endl;
+   this->ReportInterpolationError(out);
+}
+
+//______________________________________________________________________________
+Bool_t GridMagFieldMap::DetectGrid(const vector<FieldVertex*>& vertices)
+{
+   // -- Find the distinct coordinates of the vertices along each local axis, and check that
+   // -- they are evenly spaced and that there is one vertex for every combination of them
+   for (Int_t axis = 0; axis < 3; axis++) {
+      vector<Double_t> coords;
+      coords.reserve(vertices.size());
+      vector<FieldVertex*>::const_iterator iter;
+      for (iter = vertices.begin(); iter != vertices.end(); iter++) {
+         coords.push_back(axis == 0 ? (*iter)->X() : (axis == 1 ? (*iter)->Y() : (*iter)->Z()));
+      }
+      sort(coords.begin(), coords.end());
+      const Double_t tolerance = kGridTolerance*(coords.back() - coords.front());
+      vector<Double_t> lines;
+      for (vector<Double_t>::const_iterator coord = coords.begin(); coord != coords.end(); coord++) {
+         if (lines.empty() || *coord - lines.back() > tolerance) lines.push_back(*coord);
+      }
+      // Interpolation needs at least two grid lines along every axis
+      if (lines.size() < 2) return kFALSE;
+      fGridPoints[axis] = static_cast<Int_t>(lines.size());
+      fGridLower[axis] = lines.front();
+      fGridSpacing[axis] = (lines.back() - lines.front())/(lines.size() - 1);
+      for (size_t line = 0; line < lines.size(); line++) {
+         if (fabs(lines[line] - (fGridLower[axis] + line*fGridSpacing[axis])) > tolerance) return kFALSE;
+      }
+   }
+   const size_t numGridPoints = static_cast<size_t>(fGridPoints[0])*fGridPoints[1]*fGridPoints[2];
+   return (numGridPoints == vertices.size());
+}
+
+//______________________________________________________________________________
+Bool_t GridMagFieldMap::FillGrid(const vector<FieldVertex*>& vertices)
+{
+   // -- Copy the field of each vertex, rotated into the global frame, into the slot of its
+   // -- grid point. Every grid point must be given exactly one vertex.
+   for (Int_t axis = 0; axis < 3; axis++) {
+      if (fGridPoints[axis] < 2 || fGridSpacing[axis] <= 0.) return kFALSE;
+   }
+   const size_t numGridPoints = static_cast<size_t>(fGridPoints[0])*fGridPoints[1]*fGridPoints[2];
+   if (numGridPoints != vertices.size()) return kFALSE;
+   fGridField.assign(3*numGridPoints, 0.);
+   vector<Bool_t> filled(numGridPoints, kFALSE);
+   vector<FieldVertex*>::const_iterator iter;
+   for (iter = vertices.begin(); iter != vertices.end(); iter++) {
+      const Double_t local[3] = {(*iter)->X(), (*iter)->Y(), (*iter)->Z()};
+      Int_t index[3];
+      for (Int_t axis = 0; axis < 3; axis++) {
+         const Double_t u = (local[axis] - fGridLower[axis])/fGridSpacing[axis];
+         index[axis] = static_cast<Int_t>(floor(u + 0.5));
+         if (index[axis] < 0 || index[axis] >= fGridPoints[axis]) return kFALSE;
+         if (fabs(u - index[axis]) > kGridTolerance*(fGridPoints[axis] - 1)) return kFALSE;
+      }
+      const size_t gridPoint = (static_cast<size_t>(index[0])*fGridPoints[1] + index[1])*fGridPoints[2] + index[2];
+      if (filled[gridPoint] == kTRUE) return kFALSE;
+      filled[gridPoint] = kTRUE;
+      const FieldVertex global = this->ConvertToGlobalFrame(**iter);
+      fGridField[3*gridPoint] = global.Fx();
+      fGridField[3*gridPoint + 1] = global.Fy();
+      fGridField[3*gridPoint + 2] = global.Fz();
+   }
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+const Double_t* GridMagFieldMap::GridField(const Int_t i, const Int_t j, const Int_t k) const
+{
+   return &fGridField[3*((static_cast<size_t>(i)*fGridPoints[1] + j)*fGridPoints[2] + k)];
+}
+
+//______________________________________________________________________________
+TVector3 GridMagFieldMap::LookUp(const TVector3& position, FieldLookupContext& context) const
+{
+   // -- Interpolate from the grid, if the point lies within it
+   if (fIsGrid == kFALSE) return MagFieldMap::LookUp(position, context);
+   const Double_t master[3] = {position.X(), position.Y(), position.Z()};
+   Double_t local[3] = {0.,0.,0.};
+   GetMatrix().MasterToLocal(master, local);
+   TVector3 field;
+   if (this->InterpolateGrid(local, field, context) == kFALSE) {
+      if (this->GetTree() != NULL) return MagFieldMap::LookUp(position, context);
+      // A baked map has no kd-tree to fall back on, so take the nearest point of the grid
+      Double_t clamped[3];
+      for (Int_t axis = 0; axis < 3; axis++) {
+         const Double_t upper = fGridLower[axis] + (fGridPoints[axis] - 1)*fGridSpacing[axis];
+         clamped[axis] = min(max(local[axis], fGridLower[axis]), upper);
+      }
+      this->InterpolateGrid(clamped, field, context);
+   }
+   return field;
+}
+
+//______________________________________________________________________________
+Bool_t GridMagFieldMap::InterpolateGrid(const Double_t* local, TVector3& field, FieldLookupContext& context) const
+{
+   // -- Find the cell containing the local point, and interpolate from its corners or, for
+   // -- tricubic interpolation, from the 4x4x4 block of grid points around it. Points beyond
+   // -- the edge of the grid are repeated to fill the block at the boundary. The context holds
+   // -- the values of the last cell used, so they are only gathered from the grid on a new cell.
+   // -- Returns false if the point lies outside the grid.
+   Int_t cell[3];
+   Double_t frac[3];
+   for (Int_t axis = 0; axis < 3; axis++) {
+      const Double_t u = (local[axis] - fGridLower[axis])/fGridSpacing[axis];
+      const Double_t last = fGridPoints[axis] - 1;
+      if (u < -kGridTolerance*last || u > last*(1.0 + kGridTolerance)) return kFALSE;
+      cell[axis] = static_cast<Int_t>(u);
+      if (cell[axis] < 0) cell[axis] = 0;
+      if (cell[axis] > fGridPoints[axis] - 2) cell[axis] = fGridPoints[axis] - 2;
+      frac[axis] = u - cell[axis];
+   }
+   const Int_t width = (fInterpolation == kTricubic ? 4 : 2);
+   const Long64_t cellIndex = (static_cast<Long64_t>(cell[0])*fGridPoints[1] + cell[1])*fGridPoints[2] + cell[2];
+   Double_t* values = context.fCellValues;
+   if (cellIndex == context.fCell) {
+      RunStatistics* statistics = RunStatistics::Current();
+      if (statistics) statistics->fMapHintHits++;
+   } else {
+      // Gather the block of grid points used by the cell, nearest the origin first
+      const Int_t first = (width == 4 ? -1 : 0);
+      Int_t value = 0;
+      for (Int_t a = 0; a < width; a++) {
+         const Int_t i = min(max(cell[0] + first + a, 0), fGridPoints[0] - 1);
+         for (Int_t b = 0; b < width; b++) {
+            const Int_t j = min(max(cell[1] + first + b, 0), fGridPoints[1] - 1);
+            for (Int_t c = 0; c < width; c++) {
+               const Int_t k = min(max(cell[2] + first + c, 0), fGridPoints[2] - 1);
+               const Double_t* gridField = this->GridField(i, j, k);
+               values[value++] = gridField[0];
+               values[value++] = gridField[1];
+               values[value++] = gridField[2];
+            }
+         }
+      }
+      context.fCell = cellIndex;
+   }
+   Double_t weights[3][4];
+   for (Int_t axis = 0; axis < 3; axis++) {
+      if (width == 4) {
+         CatmullRomWeights(frac[axis], weights[axis]);
+      } else {
+         weights[axis][0] = 1.0 - frac[axis];
+         weights[axis][1] = frac[axis];
+      }
+   }
+   Double_t sum[3] = {0.,0.,0.};
+   Int_t value = 0;
+   for (Int_t a = 0; a < width; a++) {
+      for (Int_t b = 0; b < width; b++) {
+         const Double_t weightXY = weights[0][a]*weights[1][b];
+         for (Int_t c = 0; c < width; c++) {
+            const Double_t weight = weightXY*weights[2][c];
+            sum[0] += weight*values[value++];
+            sum[1] += weight*values[value++];
+            sum[2] += weight*values[value++];
+         }
+      }
+   }
+   field.SetXYZ(sum[0], sum[1], sum[2]);
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+void GridMagFieldMap::ReportInterpolationError(ostream& out) const
+{
+   // -- Compare the grid interpolation with the kd-tree's scattered interpolation at the centres
+   // -- of the grid's cells, where the two differ the most. Large maps are sampled at a stride
+   // -- through their cells. A baked map has no kd-tree to compare with.
+   if (fIsGrid == kFALSE || this->GetTree() == NULL) return;
+   const Int_t maxSamples = 1000;
+   const Int_t numCells = (fGridPoints[0] - 1)*(fGridPoints[1] - 1)*(fGridPoints[2] - 1);
+   const Int_t stride = (numCells > maxSamples ? numCells/maxSamples : 1);
+   Int_t numSamples = 0;
+   Double_t sumSquaredError = 0., maxError = 0., maxRelativeError = 0.;
+   for (Int_t cellIndex = 0; cellIndex < numCells; cellIndex += stride) {
+      const Int_t i = cellIndex/((fGridPoints[1] - 1)*(fGridPoints[2] - 1));
+      const Int_t j = (cellIndex/(fGridPoints[2] - 1))%(fGridPoints[1] - 1);
+      const Int_t k = cellIndex%(fGridPoints[2] - 1);
+      const Double_t local[3] = {fGridLower[0] + (i + 0.5)*fGridSpacing[0],
+                                 fGridLower[1] + (j + 0.5)*fGridSpacing[1],
+                                 fGridLower[2] + (k + 0.5)*fGridSpacing[2]};
+      Double_t master[3] = {0.,0.,0.};
+      GetMatrix().LocalToMaster(local, master);
+      TVector3 gridField;
+      FieldLookupContext context;
+      if (this->InterpolateGrid(local, gridField, context) == kFALSE) continue;
+      const TVector3 scatteredField = this->Interpolate(TVector3(master[0], master[1], master[2]), kNumInterpolatePoints);
+      const Double_t error = (gridField - scatteredField).Mag();
+      sumSquaredError += error*error;
+      if (error > maxError) maxError = error;
+      if (scatteredField.Mag() > 0. && error/scatteredField.Mag() > maxRelativeError) {
+         maxRelativeError = error/scatteredField.Mag();
+      }
+      numSamples++;
+   }
+   if (numSamples == 0) return;
+   out << "Grid interpolation (" << (fInterpolation == kTricubic ? "tricubic" : "trilinear");
+   out << ") against scattered interpolation at " << numSamples << " cell centres:" << endl;
+   out << "RMS Difference: " << sqrt(sumSquaredError/numSamples) << "\t";
+   out << "Max Difference: " << maxError << "\t";
+   out << "Max Relative Difference: " << maxRelativeError << endl;
+}
+
+//______________________________________________________________________________
+GridMagFieldMap* GridMagFieldMap::Bake(const MagField& field, const Double_t tolerance,
+                                       const Interpolation interpolation, const Int_t maxPoints)
+{
+   // -- Sample the field onto a regular grid over the bounding box of its shape, in its local
+   // -- frame, and return a map interpolating from the grid in its place. The grid spacing is
+   // -- halved until the worst difference from the field at the cells' centres within the field
+   // -- is below 'tolerance' times the largest field sampled, or until a finer grid would hold
+   // -- more than 'maxPoints'. Returns NULL if the field cannot be sampled everywhere.
+   const TGeoBBox& box = static_cast<const TGeoBBox&>(field.GetShape());
+   const TGeoMatrix& matrix = field.GetMatrix();
+   const TGeoRotation rotation(matrix);
+   const Double_t halfLength[3] = {box.GetDX(), box.GetDY(), box.GetDZ()};
+   Double_t lower[3];
+   Double_t spacing = 0.;
+   for (Int_t axis = 0; axis < 3; axis++) {
+      lower[axis] = box.GetOrigin()[axis] - halfLength[axis];
+      spacing = TMath::Max(spacing, halfLength[axis]/2.0);
+   }
+   GridMagFieldMap* baked = NULL;
+   for (;;) {
+      // Cover the box with cells of (at most) the current spacing along every axis
+      Int_t numPoints[3];
+      Double_t gridSpacing[3];
+      for (Int_t axis = 0; axis < 3; axis++) {
+         const Int_t numCells = TMath::Max(1, static_cast<Int_t>(ceil(2.0*halfLength[axis]/spacing)));
+         numPoints[axis] = numCells + 1;
+         gridSpacing[axis] = (halfLength[axis] > 0. ? 2.0*halfLength[axis]/numCells : spacing);
+      }
+      // Sample the field at every grid point, in the local frame
+      vector<FieldVertex*> vertices;
+      vertices.reserve(numPoints[0]*numPoints[1]*numPoints[2]);
+      Double_t maxField = 0.;
+      Bool_t finite = kTRUE;
+      for (Int_t i = 0; i < numPoints[0] && finite; i++) {
+         for (Int_t j = 0; j < numPoints[1] && finite; j++) {
+            for (Int_t k = 0; k < numPoints[2] && finite; k++) {
+               const Double_t local[3] = {lower[0] + i*gridSpacing[0], lower[1] + j*gridSpacing[1], lower[2] + k*gridSpacing[2]};
+               Double_t master[3] = {0.,0.,0.};
+               matrix.LocalToMaster(local, master);
+               const TVector3 sample = field.GetField(Point(master[0], master[1], master[2], 0.));
+               const Double_t masterField[3] = {sample.X(), sample.Y(), sample.Z()};
+               Double_t localField[3] = {0.,0.,0.};
+               rotation.MasterToLocal(masterField, localField);
+               finite = (TMath::Finite(sample.Mag()) ? kTRUE : kFALSE);
+               maxField = TMath::Max(maxField, sample.Mag());
+               vertices.push_back(new FieldVertex(local[0], local[1], local[2], 0., localField[0], localField[1], localField[2]));
+            }
+         }
+      }
+      if (finite == kTRUE) {
+         baked = new GridMagFieldMap(field.GetName(), static_cast<TGeoShape*>(field.GetShape().Clone()),
+                                     new TGeoHMatrix(matrix), interpolation);
+         baked->DeclareGrid(lower, gridSpacing, numPoints);
+         // The samples fill the grid by construction, so the kd-tree is never needed
+         baked->BuildGrid(vertices);
+         if (baked->IsGrid() == kFALSE) {
+            delete baked;
+            baked = NULL;
+         }
+      }
+      vector<FieldVertex*>::const_iterator iter;
+      for (iter = vertices.begin(); iter != vertices.end(); iter++) {delete *iter;}
+      if (baked == NULL) {
+         ::Error("GridMagFieldMap::Bake","Field %s could not be sampled on a %ix%ix%i grid", field.GetName(), numPoints[0], numPoints[1], numPoints[2]);
+         return NULL;
+      }
+      // Compare with the field at the centres of the cells, where interpolation is worst
+      const Int_t numCells = (numPoints[0] - 1)*(numPoints[1] - 1)*(numPoints[2] - 1);
+      const Int_t maxSamples = 10000;
+      const Int_t stride = (numCells > maxSamples ? numCells/maxSamples : 1);
+      FieldLookupContext context;
+      Double_t worstError = 0.;
+      Double_t worstLocal[3] = {0.,0.,0.};
+      for (Int_t cellIndex = 0; cellIndex < numCells; cellIndex += stride) {
+         const Int_t i = cellIndex/((numPoints[1] - 1)*(numPoints[2] - 1));
+         const Int_t j = (cellIndex/(numPoints[2] - 1))%(numPoints[1] - 1);
+         const Int_t k = cellIndex%(numPoints[2] - 1);
+         const Double_t local[3] = {lower[0] + (i + 0.5)*gridSpacing[0], lower[1] + (j + 0.5)*gridSpacing[1],
+                                    lower[2] + (k + 0.5)*gridSpacing[2]};
+         Double_t master[3] = {0.,0.,0.};
+         matrix.LocalToMaster(local, master);
+         const TVector3 position(master[0], master[1], master[2]);
+         if (field.Contains(position) == kFALSE) continue;
+         const TVector3 exact = field.GetField(Point(master[0], master[1], master[2], 0.));
+         const TVector3 interpolated = baked->LookUp(position, context);
+         const Double_t error = (interpolated - exact).Mag();
+         if (error > worstError) {
+            worstError = error;
+            for (Int_t axis = 0; axis < 3; axis++) {worstLocal[axis] = local[axis];}
+         }
+      }
+      const Double_t relativeError = (maxField > 0. ? worstError/maxField : 0.);
+      const Bool_t converged = (relativeError <= tolerance);
+      const Double_t nextPoints = 8.0*numPoints[0]*numPoints[1]*numPoints[2];
+      if (converged == kTRUE || nextPoints > maxPoints) {
+         cout << "Baked field " << field.GetName() << " onto a " << numPoints[0] << "x" << numPoints[1];
+         cout << "x" << numPoints[2] << " grid" << endl;
+         cout << "Worst difference from the field: " << worstError << " (" << relativeError;
+         cout << " of the largest field) at local point (" << worstLocal[0] << ", " << worstLocal[1];
+         cout << ", " << worstLocal[2] << ")" << endl;
+         if (converged == kFALSE) {
+            ::Warning("GridMagFieldMap::Bake","Field %s reached the limit of %i grid points without meeting the tolerance of %g",
+                    field.GetName(), maxPoints, tolerance);
+         }
+         return baked;
+      }
+      delete baked;
+      baked = NULL;
+      spacing /= 2.0;
+   }
+}
@@ -0,0 +1,406 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+#include "FlatKDTree.h"
+#include "MappedFile.h"
+
+//#define VERBOSE
+
+using namespace std;
+
+namespace {
+   // -- Header at the start of a binary tree file
+   struct FileHeader {
+      char fMagic[8];         // kFileMagic
+      int fVersion;           // kFileVersion
+      int fByteOrder;         // kByteOrder, as written by the machine that wrote the file
+      int fNumVertices;
+      int fNumLeaves;
+      int fReserved[2];
+      double fPlacement[12];  // Rotation (row by row) then translation the vertices were placed by
+   };
+   const char kFileMagic[8] = {'U','C','N','F','M','A','P','\0'};
+   const int kFileVersion = 2;
+   const int kByteOrder = 0x01020304;
+   
+   //______________________________________________________________________________
+   size_t FileSize(const int numVertices, const int numLeaves)
+   {
+      // -- Size of a binary tree file. Doubles come first, so that every array is aligned.
+      const size_t numInternal = numLeaves - 1;
+      return sizeof(FileHeader) + (numInternal + 6*numVertices)*sizeof(double)
+             + (numLeaves + 1)*sizeof(int) + numInternal*sizeof(char);
+   }
+   
+   // -- Orders vertex indices by one coordinate of the vertices
+   class SortAxis {
+      public:
+      SortAxis(const vector<const FieldVertex*>& vertices, const int axis) : fVertices(vertices), fAxis(axis) {}
+      bool operator() (const int a, const int b) const {return Coordinate(a) < Coordinate(b);}
+      double Coordinate(const int i) const {
+         const FieldVertex& vertex = *fVertices[i];
+         return (fAxis == 0 ? vertex.X() : (fAxis == 1 ? vertex.Y() : vertex.Z()));
+      }
+      private:
+      const vector<const FieldVertex*>& fVertices;
+      const int fAxis;
+   };
+}
+
+//______________________________________________________________________________
+FlatKDTree::FlatKDTree()
+           :fNumVertices(0),
+            fNumLeaves(1),
+            fSplitValue(),
+            fSplitAxis(),
+            fLeafBegin(2, 0),
+            fX(), fY(), fZ(),
+            fFx(), fFy(), fFz(),
+            fMapping(NULL)
+{
+   // -- Default Constructor. Empty tree, with a single empty leaf covering all of space
+   this->SetPlacement(NULL);
+}
+
+//______________________________________________________________________________
+FlatKDTree::FlatKDTree(const vector<const FieldVertex*>& vertices, const int bucketSize)
+           :fNumVertices(static_cast<int>(vertices.size())),
+            fNumLeaves(1),
+            fSplitValue(),
+            fSplitAxis(),
+            fLeafBegin(),
+            fX(), fY(), fZ(),
+            fFx(), fFy(), fFz(),
+            fMapping(NULL)
+{
+   // -- Constructor. Copy the vertices into the tree. The vertices themselves are not kept.
+   this->SetPlacement(NULL);
+   if (bucketSize < 1) {
+      throw runtime_error("Invalid bucket size requested for FlatKDTree");
+   }
+   const int numVertices = fNumVertices;
+   // Halve the vertices at each level until every leaf holds at most bucketSize
+   while (fNumLeaves*bucketSize < numVertices) {fNumLeaves *= 2;}
+   const int numInternal = fNumLeaves - 1;
+   fSplitValue.resize(numInternal);
+   fSplitAxis.resize(numInternal);
+   fLeafBegin.resize(fNumLeaves + 1);
+   vector<int> order(numVertices);
+   for (int i = 0; i < numVertices; i++) {order[i] = i;}
+   this->BuildNode(vertices, order, 0, 0, numVertices);
+   fLeafBegin[fNumLeaves] = numVertices;
+   // Copy the vertices into contiguous arrays in leaf order
+   fX.resize(numVertices); fY.resize(numVertices); fZ.resize(numVertices);
+   fFx.resize(numVertices); fFy.resize(numVertices); fFz.resize(numVertices);
+   for (int i = 0; i < numVertices; i++) {
+      const FieldVertex& vertex = *vertices[order[i]];
+      fX[i] = vertex.X(); fY[i] = vertex.Y(); fZ[i] = vertex.Z();
+      fFx[i] = vertex.Fx(); fFy[i] = vertex.Fy(); fFz[i] = vertex.Fz();
+   }
+   #ifdef VERBOSE
+      cout << "FlatKDTree built with " << numVertices << " vertices in " << fNumLeaves << " leaves" << endl;
+   #endif
+}
+
+//______________________________________________________________________________
+FlatKDTree::~FlatKDTree()
+{
+   if (fMapping) delete fMapping;
+}
+
+//______________________________________________________________________________
+bool FlatKDTree::IsBinaryFile(const string& filename)
+{
+   // -- Whether the file starts like a binary tree file
+   ifstream in(filename.c_str(), ios::binary);
+   char magic[sizeof(kFileMagic)];
+   if (!in.read(magic, sizeof(magic))) return false;
+   return (memcmp(magic, kFileMagic, sizeof(kFileMagic)) == 0);
+}
+
+//______________________________________________________________________________
+FlatKDTree* FlatKDTree::Map(const string& filename)
+{
+   // -- Map a binary tree file written by Write(). The tree reads its arrays straight from the
+   // -- mapping, which it holds until it is destroyed. Returns NULL if the file cannot be used.
+   MappedFile* mapping = new MappedFile();
+   if (mapping->Open(filename) == false) {
+      delete mapping;
+      return NULL;
+   }
+   FileHeader header;
+   if (mapping->Size() < sizeof(header)) {
+      cout << "Error::FlatKDTree - file: " << filename << " is too short to hold a tree" << endl;
+      delete mapping;
+      return NULL;
+   }
+   memcpy(&header, mapping->Data(), sizeof(header));
+   if (memcmp(header.fMagic, kFileMagic, sizeof(kFileMagic)) != 0 || header.fVersion != kFileVersion
+         || header.fByteOrder != kByteOrder) {
+      cout << "Error::FlatKDTree - file: " << filename << " was not written by this version, or on this";
+      cout << " kind of machine" << endl;
+      delete mapping;
+      return NULL;
+   }
+   if (header.fNumVertices < 0 || header.fNumLeaves < 1
+         || mapping->Size() != FileSize(header.fNumVertices, header.fNumLeaves)) {
+      cout << "Error::FlatKDTree - file: " << filename << " is corrupt" << endl;
+      delete mapping;
+      return NULL;
+   }
+   FlatKDTree* tree = new FlatKDTree();
+   tree->SetPlacement(header.fPlacement);
+   tree->fNumVertices = header.fNumVertices;
+   tree->fNumLeaves = header.fNumLeaves;
+   tree->fLeafBegin.clear();
+   tree->fMapping = mapping;
+   const size_t numInternal = header.fNumLeaves - 1;
+   const size_t numVertices = header.fNumVertices;
+   const double* doubles = reinterpret_cast<const double*>(mapping->Data() + sizeof(FileHeader));
+   tree->fMapped.fSplitValue = doubles;
+   tree->fMapped.fX = doubles + numInternal;
+   tree->fMapped.fY = tree->fMapped.fX + numVertices;
+   tree->fMapped.fZ = tree->fMapped.fY + numVertices;
+   tree->fMapped.fFx = tree->fMapped.fZ + numVertices;
+   tree->fMapped.fFy = tree->fMapped.fFx + numVertices;
+   tree->fMapped.fFz = tree->fMapped.fFy + numVertices;
+   tree->fMapped.fLeafBegin = reinterpret_cast<const int*>(tree->fMapped.fFz + numVertices);
+   tree->fMapped.fSplitAxis = reinterpret_cast<const char*>(tree->fMapped.fLeafBegin + header.fNumLeaves + 1);
+   // Check the arrays before anything indexes by them
+   if (tree->HasValidArrays() == false) {
+      cout << "Error::FlatKDTree - file: " << filename << " is corrupt" << endl;
+      delete tree;
+      return NULL;
+   }
+   return tree;
+}
+
+//______________________________________________________________________________
+bool FlatKDTree::Write(const string& filename) const
+{
+   // -- Write the tree's arrays, and the placement of its vertices, to a binary file that
+   // -- Map() can read
+   ofstream out(filename.c_str(), ios::binary | ios::trunc);
+   if (!out.is_open()) {
+      cout << "Error::FlatKDTree - cannot open file: " << filename << endl;
+      return false;
+   }
+   FileHeader header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.fMagic, kFileMagic, sizeof(kFileMagic));
+   header.fVersion = kFileVersion;
+   header.fByteOrder = kByteOrder;
+   header.fNumVertices = fNumVertices;
+   header.fNumLeaves = fNumLeaves;
+   copy(fPlacement, fPlacement + 12, header.fPlacement);
+   out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+   const Arrays arrays = this->GetArrays();
+   const size_t numInternal = fNumLeaves - 1;
+   const size_t numVertices = fNumVertices;
+   out.write(reinterpret_cast<const char*>(arrays.fSplitValue), numInternal*sizeof(double));
+   const double* vertexArrays[6] = {arrays.fX, arrays.fY, arrays.fZ, arrays.fFx, arrays.fFy, arrays.fFz};
+   for (int array = 0; array < 6; array++) {
+      out.write(reinterpret_cast<const char*>(vertexArrays[array]), numVertices*sizeof(double));
+   }
+   out.write(reinterpret_cast<const char*>(arrays.fLeafBegin), (fNumLeaves + 1)*sizeof(int));
+   out.write(arrays.fSplitAxis, numInternal*sizeof(char));
+   out.close();
+   if (!out) {
+      cout << "Error::FlatKDTree - failed writing to file: " << filename << endl;
+      return false;
+   }
+   return true;
+}
+
+//______________________________________________________________________________
+void FlatKDTree::SetPlacement(const double* placement)
+{
+   // -- Record the rotation (9 elements, row by row) and translation (3 elements) by which
+   // -- the vertices were placed in the frame they are stored in. NULL means no placement.
+   static const double identity[12] = {1.,0.,0., 0.,1.,0., 0.,0.,1., 0.,0.,0.};
+   const double* source = (placement ? placement : identity);
+   copy(source, source + 12, fPlacement);
+}
+
+//______________________________________________________________________________
+bool FlatKDTree::HasValidArrays() const
+{
+   // -- Whether the tree's shape is consistent: a power of two leaves, whose offsets run in
+   // -- order from 0 to the number of vertices, and split axes that are all 0, 1 or 2
+   if (fNumLeaves < 1 || (fNumLeaves & (fNumLeaves - 1)) != 0) return false;
+   const Arrays arrays = this->GetArrays();
+   if (arrays.fLeafBegin[0] != 0 || arrays.fLeafBegin[fNumLeaves] != fNumVertices) return false;
+   for (int leaf = 0; leaf < fNumLeaves; leaf++) {
+      if (arrays.fLeafBegin[leaf] > arrays.fLeafBegin[leaf + 1]) return false;
+   }
+   for (int node = 0; node < fNumLeaves - 1; node++) {
+      if (arrays.fSplitAxis[node] < 0 || arrays.fSplitAxis[node] > 2) return false;
+   }
+   return true;
+}
+
+//______________________________________________________________________________
+FlatKDTree::Arrays FlatKDTree::GetArrays() const
+{
+   // -- Locate the tree's arrays. Empty arrays are given as NULL.
+   if (fMapping) return fMapped;
+   Arrays arrays;
+   arrays.fSplitValue = (fSplitValue.empty() ? NULL : &fSplitValue[0]);
+   arrays.fSplitAxis = (fSplitAxis.empty() ? NULL : &fSplitAxis[0]);
+   arrays.fLeafBegin = (fLeafBegin.empty() ? NULL : &fLeafBegin[0]);
+   arrays.fX = (fX.empty() ? NULL : &fX[0]);
+   arrays.fY = (fY.empty() ? NULL : &fY[0]);
+   arrays.fZ = (fZ.empty() ? NULL : &fZ[0]);
+   arrays.fFx = (fFx.empty() ? NULL : &fFx[0]);
+   arrays.fFy = (fFy.empty() ? NULL : &fFy[0]);
+   arrays.fFz = (fFz.empty() ? NULL : &fFz[0]);
+   return arrays;
+}
+
+//______________________________________________________________________________
+void FlatKDTree::BuildNode(const vector<const FieldVertex*>& vertices, vector<int>& order, const int node, const int begin, const int end)
+{
+   // -- Split the vertices order[begin, end) about their median along the axis on which they
+   // -- are most spread out, and build the two halves as the node's children
+   const int numInternal = fNumLeaves - 1;
+   if (node >= numInternal) {
+      fLeafBegin[node - numInternal] = begin;
+      return;
+   }
+   // Find the widest axis
+   double lower[3] = {0.,0.,0.}, upper[3] = {0.,0.,0.};
+   for (int i = begin; i < end; i++) {
+      const FieldVertex& vertex = *vertices[order[i]];
+      const double coords[3] = {vertex.X(), vertex.Y(), vertex.Z()};
+      for (int axis = 0; axis < 3; axis++) {
+         if (i == begin || coords[axis] < lower[axis]) lower[axis] = coords[axis];
+         if (i == begin || coords[axis] > upper[axis]) upper[axis] = coords[axis];
+      }
+   }
+   int splitAxis = 0;
+   for (int axis = 1; axis < 3; axis++) {
+      if (upper[axis] - lower[axis] > upper[splitAxis] - lower[splitAxis]) splitAxis = axis;
+   }
+   // Vertices before the median are no greater than it along the axis, those after no less
+   const int median = begin + (end - begin)/2;
+   const SortAxis sortAxis(vertices, splitAxis);
+   if (begin < end) {
+      nth_element(order.begin() + begin, order.begin() + median, order.begin() + end, sortAxis);
+   }
+   fSplitAxis[node] = static_cast<char>(splitAxis);
+   fSplitValue[node] = (median < end ? sortAxis.Coordinate(order[median]) : 0.);
+   this->BuildNode(vertices, order, 2*node + 1, begin, median);
+   this->BuildNode(vertices, order, 2*node + 2, median, end);
+}
+
+//______________________________________________________________________________
+bool FlatKDTree::CellHolds(const double* point, const Arrays& arrays, const int node, const double boundSquared) const
+{
+   // -- Whether the node's cell holds the point, with every face of the cell at least
+   // -- sqrt(boundSquared) away from it. Vertices outside the node's subtree lie beyond those
+   // -- faces, so none of them can be nearer to the point than the bound. The faces are the
+   // -- splitting planes of the nodes above, each of which must have the point on the node's
+   // -- side, as in the descent in LeafContaining.
+   int child = node;
+   while (child > 0) {
+      const int parent = (child - 1)/2;
+      const double offset = point[static_cast<int>(arrays.fSplitAxis[parent])] - arrays.fSplitValue[parent];
+      if ((offset < 0.) != (child == 2*parent + 1)) return false;
+      if (offset*offset < boundSquared) return false;
+      child = parent;
+   }
+   return true;
+}
+
+//______________________________________________________________________________
+int FlatKDTree::NearestNeighbours(const double* point, NeighbourHeap& neighbours) const
+{
+   // -- Fill the heap with the vertices closest to point, up to its capacity. Any neighbours
+   // -- already in the heap are discarded. Returns the number of vertices examined.
+   int leaf = -1;
+   bool hintSufficed = false;
+   return this->NearestNeighbours(point, neighbours, leaf, hintSufficed);
+}
+
+//______________________________________________________________________________
+int FlatKDTree::NearestNeighbours(const double* point, NeighbourHeap& neighbours, int& leaf, bool& hintSufficed) const
+{
+   // -- As above, but start from 'leaf' and work up the tree, searching the other child of
+   // -- each node passed, until reaching a node whose cell holds the point and the neighbours
+   // -- found so far. Nothing outside that node's subtree can be nearer. 'hintSufficed' is set
+   // -- if the search stopped below the root. On return, 'leaf' is the leaf holding the point.
+   neighbours.Clear();
+   hintSufficed = false;
+   const Arrays arrays = this->GetArrays();
+   const int numInternal = fNumLeaves - 1;
+   if (leaf < 0 || leaf >= fNumLeaves) {
+      const int examined = this->SearchNode(point, arrays, 0, neighbours);
+      leaf = this->LeafContaining(point, arrays, 0);
+      return examined;
+   }
+   int node = numInternal + leaf;
+   int examined = this->SearchLeaf(point, arrays, leaf, neighbours);
+   while (node > 0 && this->CellHolds(point, arrays, node, neighbours.BoundSquared()) == false) {
+      const int parent = (node - 1)/2;
+      const int sibling = (node == 2*parent + 1 ? node + 1 : node - 1);
+      // The sibling can only hold a closer vertex if the point is on its side of the
+      // splitting plane, or the plane is nearer than the furthest neighbour found so far
+      const double offset = point[static_cast<int>(arrays.fSplitAxis[parent])] - arrays.fSplitValue[parent];
+      const bool siblingSide = ((offset < 0.) == (sibling == 2*parent + 1));
+      if (siblingSide == true || offset*offset <= neighbours.BoundSquared()) {
+         examined += this->SearchNode(point, arrays, sibling, neighbours);
+      }
+      node = parent;
+   }
+   hintSufficed = (node > 0);
+   leaf = this->LeafContaining(point, arrays, node);
+   return examined;
+}
+
+//______________________________________________________________________________
+int FlatKDTree::SearchNode(const double* point, const Arrays& arrays, const int node, NeighbourHeap& neighbours) const
+{
+   // -- Search the node's subtree, nearer child first. The further child can only hold a closer
+   // -- vertex if the splitting plane is nearer than the furthest neighbour found so far.
+   const int numInternal = fNumLeaves - 1;
+   if (node >= numInternal) {
+      return this->SearchLeaf(point, arrays, node - numInternal, neighbours);
+   }
+   const double offset = point[static_cast<int>(arrays.fSplitAxis[node])] - arrays.fSplitValue[node];
+   const int nearChild = (offset < 0. ? 2*node + 1 : 2*node + 2);
+   const int farChild = (offset < 0. ? 2*node + 2 : 2*node + 1);
+   int examined = this->SearchNode(point, arrays, nearChild, neighbours);
+   if (offset*offset <= neighbours.BoundSquared()) {
+      examined += this->SearchNode(point, arrays, farChild, neighbours);
+   }
+   return examined;
+}
+
+//______________________________________________________________________________
+int FlatKDTree::SearchLeaf(const double* point, const Arrays& arrays, const int leaf, NeighbourHeap& neighbours) const
+{
+   // -- Offer every vertex of the leaf to the heap
+   const int begin = arrays.fLeafBegin[leaf], end = arrays.fLeafBegin[leaf + 1];
+   for (int i = begin; i < end; i++) {
+      const double dx = arrays.fX[i] - point[0], dy = arrays.fY[i] - point[1], dz = arrays.fZ[i] - point[2];
+      neighbours.Offer(i, dx*dx + dy*dy + dz*dz);
+   }
+   return end - begin;
+}
+
+//______________________________________________________________________________
+int FlatKDTree::LeafContaining(const double* point, const Arrays& arrays, const int startNode) const
+{
+   // -- Follow the splitting planes down from startNode, whose cell holds the point, to the
+   // -- leaf whose cell holds it
+   const int numInternal = fNumLeaves - 1;
+   int node = startNode;
+   while (node < numInternal) {
+      const double offset = point[static_cast<int>(arrays.fSplitAxis[node])] - arrays.fSplitValue[node];
+      node = (offset < 0. ? 2*node + 1 : 2*node + 2);
+   }
+   return node - numInternal;
+}
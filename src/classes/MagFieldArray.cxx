@@ -6,6 +6,8 @@
 
 #include "Point.h"
 #include "MagFieldArray.h"
+#include "FieldMap.h"
+#include "UniformMagField.h"
 
 //#define VERBOSE_MODE
 
@@ -41,3 +43,27 @@ const TVector3 MagFieldArray::GetMagField(const Point& point, const TVector3& /*
 {
    return this->GetField(point,volume);
 }
+
+//_____________________________________________________________________________
+Bool_t MagFieldArray::BakeFields(const Double_t tolerance)
+{
+   // -- Replace every analytic field with a map sampled from it on a regular grid, fine enough
+   // -- to reproduce the field to within 'tolerance' of its largest value. Field maps and uniform
+   // -- fields are cheap to evaluate already, and are left as they are.
+   FieldContainer::iterator fieldIter;
+   for (fieldIter = fFieldList.begin(); fieldIter != fFieldList.end(); ++fieldIter) {
+      const MagField* field = dynamic_cast<const MagField*>(fieldIter->second);
+      if (field == NULL) continue;
+      if (dynamic_cast<const MagFieldMap*>(field) != NULL) continue;
+      if (dynamic_cast<const UniformMagField*>(field) != NULL) continue;
+      GridMagFieldMap* baked = GridMagFieldMap::Bake(*field, tolerance);
+      if (baked == NULL) {
+         Error("BakeFields","Unable to bake field %s", fieldIter->first.c_str());
+         return kFALSE;
+      }
+      delete fieldIter->second;
+      fieldIter->second = baked;
+   }
+   this->BuildRegionIndex();
+   return kTRUE;
+}
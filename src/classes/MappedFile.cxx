@@ -0,0 +1,68 @@
+#include <iostream>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "MappedFile.h"
+
+using namespace std;
+
+//______________________________________________________________________________
+MappedFile::MappedFile()
+           :fFileName(),
+            fData(NULL),
+            fSize(0)
+{
+   // -- Constructor
+}
+
+//______________________________________________________________________________
+MappedFile::~MappedFile()
+{
+   // -- Destructor
+   this->Close();
+}
+
+//______________________________________________________________________________
+bool MappedFile::Open(const string& filename)
+{
+   // -- Map the whole of the file. Any previous mapping is released first.
+   this->Close();
+   const int descriptor = open(filename.c_str(), O_RDONLY);
+   if (descriptor < 0) {
+      cout << "Error::MappedFile - cannot open file: " << filename << endl;
+      return false;
+   }
+   struct stat status;
+   if (fstat(descriptor, &status) != 0 || status.st_size <= 0) {
+      cout << "Error::MappedFile - file: " << filename << " appears to contain no data" << endl;
+      close(descriptor);
+      return false;
+   }
+   const size_t size = static_cast<size_t>(status.st_size);
+   void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, descriptor, 0);
+   // The mapping holds its own reference to the file
+   close(descriptor);
+   if (data == MAP_FAILED) {
+      cout << "Error::MappedFile - cannot map file: " << filename << endl;
+      return false;
+   }
+   fFileName = filename;
+   fData = static_cast<const char*>(data);
+   fSize = size;
+   return true;
+}
+
+//______________________________________________________________________________
+void MappedFile::Close()
+{
+   // -- Release the mapping
+   if (fData != NULL) {
+      munmap(const_cast<char*>(fData), fSize);
+   }
+   fFileName.clear();
+   fData = NULL;
+   fSize = 0;
+}
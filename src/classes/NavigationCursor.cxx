@@ -0,0 +1,105 @@
+// NavigationCursor class
+#include <iostream>
+#include <cassert>
+
+#include "NavigationCursor.h"
+
+#include "TGeoNavigator.h"
+#include "TGeoNode.h"
+#include "TGeoVolume.h"
+
+using namespace std;
+
+//#define VERBOSE_MODE
+
+//______________________________________________________________________________
+NavigationCursor::NavigationCursor()
+                 :fLevel(-1),
+                  fNodes(),
+                  fIndices(),
+                  fMatrix()
+{
+   // -- Constructor. Nothing is saved.
+}
+
+//______________________________________________________________________________
+NavigationCursor::NavigationCursor(const NavigationCursor& other)
+                 :fLevel(other.fLevel),
+                  fNodes(other.fNodes),
+                  fIndices(other.fIndices),
+                  fMatrix()
+{
+   // -- Copy Constructor
+   fMatrix.CopyFrom(&other.fMatrix);
+}
+
+//______________________________________________________________________________
+NavigationCursor& NavigationCursor::operator=(const NavigationCursor& other)
+{
+   // -- Assignment. Only the matrix's values are copied, so the cursor keeps its own name.
+   if (this != &other) {
+      fLevel = other.fLevel;
+      fNodes = other.fNodes;
+      fIndices = other.fIndices;
+      fMatrix.CopyFrom(&other.fMatrix);
+   }
+   return *this;
+}
+
+//______________________________________________________________________________
+Bool_t NavigationCursor::IsOnBranch(const TGeoNavigator* navigator, const Int_t up) const
+{
+   // -- Whether the navigator's node 'up' levels above its current node is the saved node,
+   // -- reached along the saved branch. Comparing the whole branch matters, since the same
+   // -- volume may be placed in several mothers.
+   if (fLevel < 0 || navigator->GetLevel() != fLevel + up) return kFALSE;
+   for (Int_t level = fLevel; level >= 0; level--) {
+      if (navigator->GetMother(fLevel - level + up) != fNodes[level]) return kFALSE;
+   }
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+void NavigationCursor::Save(const TGeoNavigator* navigator)
+{
+   // -- Record the navigator's current node. If it is still the saved node, the branch
+   // -- and matrix are already correct.
+   if (this->IsOnBranch(navigator, 0) == kTRUE) return;
+   fLevel = navigator->GetLevel();
+   // Only reallocates the first time the track reaches this depth
+   fNodes.resize(fLevel + 1);
+   fIndices.resize(fLevel + 1);
+   for (Int_t level = 0; level <= fLevel; level++) {
+      fNodes[level] = navigator->GetMother(fLevel - level);
+   }
+   fIndices[0] = 0;
+   for (Int_t level = 1; level <= fLevel; level++) {
+      fIndices[level] = fNodes[level - 1]->GetVolume()->GetIndex(fNodes[level]);
+      assert(fIndices[level] >= 0);
+   }
+   fMatrix.CopyFrom(navigator->GetCurrentMatrix());
+   #ifdef VERBOSE_MODE
+      cout << "NavigationCursor saved node " << fNodes[fLevel]->GetName() << " at level " << fLevel << endl;
+   #endif
+}
+
+//______________________________________________________________________________
+Bool_t NavigationCursor::Restore(TGeoNavigator* navigator) const
+{
+   // -- Make the saved node the navigator's current node. Returns false if nothing is saved.
+   if (fLevel < 0) return kFALSE;
+   // Already there
+   if (this->IsOnBranch(navigator, 0) == kTRUE) return kTRUE;
+   // Navigator is in a daughter of the saved node, as after a bounce off a daughter
+   if (this->IsOnBranch(navigator, 1) == kTRUE) {
+      navigator->CdUp();
+      return kTRUE;
+   }
+   // Otherwise walk down from the top of the geometry
+   navigator->CdTop();
+   for (Int_t level = 1; level <= fLevel; level++) {
+      navigator->CdDown(fIndices[level]);
+   }
+   assert(navigator->GetCurrentNode() == fNodes[fLevel]);
+   return kTRUE;
+}
@@ -0,0 +1,84 @@
+#include <stdexcept>
+#include <limits>
+
+#include "NeighbourHeap.h"
+
+using namespace std;
+
+//______________________________________________________________________________
+NeighbourHeap::NeighbourHeap(const int capacity)
+              :fCapacity(capacity),
+               fSize(0)
+{
+   // -- Constructor
+   if (capacity < 1 || capacity > kMaxNeighbours) {
+      throw runtime_error("Invalid number of nearest neighbours requested");
+   }
+}
+
+//______________________________________________________________________________
+double NeighbourHeap::BoundSquared() const
+{
+   // -- Until the heap is full any vertex is accepted
+   return (this->IsFull() ? fSquaredDistances[0] : numeric_limits<double>::max());
+}
+
+//______________________________________________________________________________
+void NeighbourHeap::Offer(const int index, const double squaredDistance)
+{
+   // -- Add the vertex if there is room, sifting it up to its place. Once full, it replaces
+   // -- the furthest neighbour at the top, if it is nearer than it, and is sifted down.
+   if (fSize < fCapacity) {
+      int position = fSize++;
+      fIndices[position] = index;
+      fSquaredDistances[position] = squaredDistance;
+      while (position > 0) {
+         const int parent = (position - 1)/2;
+         if (fSquaredDistances[parent] >= fSquaredDistances[position]) break;
+         this->Swap(parent, position);
+         position = parent;
+      }
+   } else if (squaredDistance < fSquaredDistances[0]) {
+      fIndices[0] = index;
+      fSquaredDistances[0] = squaredDistance;
+      this->SiftDown(0, fSize);
+   }
+}
+
+//______________________________________________________________________________
+void NeighbourHeap::Sort()
+{
+   // -- Heap sort in place. Repeatedly move the furthest remaining neighbour to the back.
+   for (int size = fSize - 1; size > 0; size--) {
+      this->Swap(0, size);
+      this->SiftDown(0, size);
+   }
+}
+
+//______________________________________________________________________________
+void NeighbourHeap::SiftDown(const int position, const int size)
+{
+   // -- Restore the heap below 'position', considering only the first 'size' elements
+   int parent = position;
+   for (;;) {
+      const int left = 2*parent + 1;
+      if (left >= size) break;
+      const int right = left + 1;
+      int largest = left;
+      if (right < size && fSquaredDistances[right] > fSquaredDistances[left]) largest = right;
+      if (fSquaredDistances[parent] >= fSquaredDistances[largest]) break;
+      this->Swap(parent, largest);
+      parent = largest;
+   }
+}
+
+//______________________________________________________________________________
+void NeighbourHeap::Swap(const int a, const int b)
+{
+   const int index = fIndices[a];
+   fIndices[a] = fIndices[b];
+   fIndices[b] = index;
+   const double squaredDistance = fSquaredDistances[a];
+   fSquaredDistances[a] = fSquaredDistances[b];
+   fSquaredDistances[b] = squaredDistance;
+}
@@ -50,13 +50,13 @@ void Observable::DetachAll()
 }
 
 //_____________________________________________________________________________
-void Observable::NotifyObservers(const Point& point, const TVector3& velocity, const std::string& context)
+void Observable::NotifyObservers(const Point& point, const TVector3& velocity, const std::string& context, const Clock& clock)
 {
    // -- Notify *ALL* Observers of change
    vector<Observer*>::iterator it;
    // Notify my observers
    for(it = fObservers.begin(); it != fObservers.end(); it++) {
-      (*it)->RecordEvent(point, velocity, context);
+      (*it)->RecordEvent(point, velocity, context, clock);
    }
 }
 
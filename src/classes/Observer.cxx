@@ -12,7 +12,6 @@
 #include "Data.h"
 #include "Clock.h"
 #include "Algorithms.h"
-#include "Clock.h"
 
 /////////////////////////////////////////////////////////////////////////////
 //                                                                         //
@@ -41,12 +40,10 @@ Observer::Observer(const string name, const double measureInterval)
          :TNamed(name,name),
           fSubject(NULL),
           fMeasInterval(measureInterval),
-          fPreviousMeasTime(Clock::Instance()->GetTime())
+          fPreviousMeasTime(0.0)
 {
    // Constructor
    Info("Observer","Default Constructor");
-   // Register ourselves with the clock as a periodic event
-   Clock::Instance()->ScheduleEvent(name, measureInterval, fPreviousMeasTime);
 }
 
 //_____________________________________________________________________________
@@ -58,8 +55,6 @@ Observer::Observer(const Observer& other)
 {
    // Copy Constructor
    Info("Observer","Copy Constructor");
-   // Register ourselves with the clock as a periodic event
-   Clock::Instance()->ScheduleEvent(this->GetName(), fMeasInterval, fPreviousMeasTime);
 }
 
 //_____________________________________________________________________________
@@ -67,15 +62,10 @@ Observer& Observer::operator=(const Observer& other)
 {
    Info("Observer","Assignment");
    if(this!=&other) {
-      // Un-register ourselves from the Clock's list of events
-      Clock::Instance()->CancelEvent(this->GetName());
-      // Assignment
-      Observer::operator=(other);
+      TNamed::operator=(other);
       fSubject = other.fSubject;
       fMeasInterval = other.fMeasInterval;
       fPreviousMeasTime = other.fPreviousMeasTime;
-      // Re-register ourselves with the Clock
-      Clock::Instance()->ScheduleEvent(this->GetName(), fMeasInterval, fPreviousMeasTime);
    }
    return *this;
 }
@@ -87,6 +77,30 @@ Observer::~Observer()
    Info("Observer","Destructor");
 }
 
+//_____________________________________________________________________________
+void Observer::ScheduleMeasurements(Clock& clock) const
+{
+   // -- Register our periodic measurements with the clock of the particle we are watching
+   if (clock.ScheduleEvent(fMeasInterval, fPreviousMeasTime) == false) {
+      Warning("ScheduleMeasurements","Clock is full. Measurements of %s will not be scheduled", this->GetName());
+   }
+}
+
+//_____________________________________________________________________________
+void Observer::Merge(const Observer& /*other*/)
+{
+   // -- Add another observer's data into this one's. Only meaningful for observers
+   // -- recording on a 'PerRun' basis
+   Warning("Merge","Observer %s cannot merge its data with another observer", this->GetName());
+}
+
+//_____________________________________________________________________________
+void Observer::RestoreFromFile(Data& /*data*/)
+{
+   // -- Add back the data written out at a checkpoint, when resuming a run. Only 'PerRun'
+   // -- observers hold data across particles, so by default there is nothing to restore.
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //                                                                         //
 //    SpinObserver                                                     //
@@ -137,13 +151,13 @@ SpinObserver::~SpinObserver()
 }
 
 //_____________________________________________________________________________
-void SpinObserver::RecordEvent(const Point& /*point*/, const TVector3& /*velocity*/, const std::string& context)
+void SpinObserver::RecordEvent(const Point& /*point*/, const TVector3& /*velocity*/, const std::string& context, const Clock& clock)
 {
    // -- Record the current spin state
    if (context == Context::Spin) {
       // The Spin context means that spin state has just changed.
       // First check whether it is time to make a Spin measurement
-      double currentTime = Clock::Instance()->GetTime();
+      double currentTime = clock.GetTime();
       if (Precision::IsEqual(currentTime, (this->GetPreviousMeasTime() + this->GetMeasInterval()))) {
          const Particle* particle = dynamic_cast<const Particle*>(this->GetSubject());
          // Make a copy of the current spin state
@@ -227,7 +241,7 @@ BounceObserver::~BounceObserver()
 }
 
 //_____________________________________________________________________________
-void BounceObserver::RecordEvent(const Point& /*point*/, const TVector3& /*velocity*/, const std::string& context)
+void BounceObserver::RecordEvent(const Point& /*point*/, const TVector3& /*velocity*/, const std::string& context, const Clock& /*clock*/)
 
 {
    // -- If context indicates a bounce was made, increment counters.
@@ -305,11 +319,11 @@ TrackObserver::~TrackObserver()
 }
 
 //_____________________________________________________________________________
-void TrackObserver::RecordEvent(const Point& /*point*/, const TVector3& /*velocity*/, const std::string& context)
+void TrackObserver::RecordEvent(const Point& /*point*/, const TVector3& /*velocity*/, const std::string& context, const Clock& clock)
 {
    // -- Record the current polarisation
    if (context == Context::Step) {
-      double currentTime = Clock::Instance()->GetTime();
+      double currentTime = clock.GetTime();
       // If no measurement interval is set, we record every step
       if (this->GetMeasInterval() == 0.0) {
          const Particle* particle = dynamic_cast<const Particle*>(this->GetSubject());
@@ -396,12 +410,12 @@ FieldObserver::~FieldObserver()
 }
 
 //_____________________________________________________________________________
-void FieldObserver::RecordEvent(const Point& point, const TVector3& velocity, const std::string& context)
+void FieldObserver::RecordEvent(const Point& point, const TVector3& velocity, const std::string& context, const Clock& clock)
 {
    // -- Record the current Field at the current point
    if (context == Context::MagField) {
       // Calculate whether it is time to make a field measurement
-      double currentTime = Clock::Instance()->GetTime();
+      double currentTime = clock.GetTime();
       if (Precision::IsEqual(currentTime,(this->GetPreviousMeasTime() + this->GetMeasInterval()))) {
          // Make measurement
          const TVector3 field = dynamic_cast<const FieldArray*>(this->GetSubject())->GetMagField(point,velocity);
@@ -484,13 +498,13 @@ PopulationObserver::~PopulationObserver()
 }
 
 //_____________________________________________________________________________
-void PopulationObserver::RecordEvent(const Point& point, const TVector3& velocity, const std::string& context)
+void PopulationObserver::RecordEvent(const Point& point, const TVector3& velocity, const std::string& context, const Clock& clock)
 {
    // -- Record the current Population at the current point
    if (context == Context::Population) {
       // The population context means that its time to record the particle population.
       // First check whether it is time to make a population measurement
-      double currentTime = Clock::Instance()->GetTime();
+      double currentTime = clock.GetTime();
       if (Precision::IsEqual(currentTime, (this->GetPreviousMeasTime() + this->GetMeasInterval()))) {
          // Get the current state of the particle
          const Particle* particle = dynamic_cast<const Particle*>(this->GetSubject());
@@ -505,7 +519,7 @@ void PopulationObserver::RecordEvent(const Point& point, const TVector3& velocit
       // shall make a measurement of its initial state
       const Particle* particle = dynamic_cast<const Particle*>(this->GetSubject());
       const string stateName = particle->GetState().GetName();
-      fPopulationData->Fill(Clock::Instance()->GetTime(), stateName);
+      fPopulationData->Fill(clock.GetTime(), stateName);
    } 
 }
 
@@ -522,4 +536,101 @@ void PopulationObserver::WriteToFile(Data& data)
 {
    // -- Write out the current observer's data to the observer's branch on the tree
    data.WriteObjectToFile(fPopulationData);
-}
\ No newline at end of file
+}
+
+//_____________________________________________________________________________
+void PopulationObserver::Merge(const Observer& other)
+{
+   // -- Add the population counts of another PopulationObserver to our own
+   const PopulationObserver* otherObserver = dynamic_cast<const PopulationObserver*>(&other);
+   if (otherObserver == NULL) {
+      Error("Merge","Cannot merge %s with %s", this->GetName(), other.GetName());
+      return;
+   }
+   fPopulationData->Add(*(otherObserver->fPopulationData));
+}
+
+//_____________________________________________________________________________
+void PopulationObserver::RestoreFromFile(Data& data)
+{
+   // -- Add the populations counted before the checkpoint being resumed to our own
+   PopulationData* saved = dynamic_cast<PopulationData*>(data.ReadObjectFromFile(fPopulationData->GetName()));
+   if (saved == NULL) return;
+   fPopulationData->Add(*saved);
+   delete saved;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    TrajectoryObserver                                                   //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+ClassImp(TrajectoryObserver);
+
+//_____________________________________________________________________________
+TrajectoryObserver::TrajectoryObserver(const std::string name, const TVector3& gravity)
+                   :Observer(name, 0.0),
+                    fTrajectory(NULL)
+{
+   // Constructor
+   Info("TrajectoryObserver","Default Constructor");
+   fTrajectory = new Trajectory(gravity);
+}
+
+//_____________________________________________________________________________
+TrajectoryObserver::TrajectoryObserver(const TrajectoryObserver& other)
+                   :Observer(other),
+                    fTrajectory(NULL)
+{
+   // Copy Constructor
+   Info("TrajectoryObserver","Copy Constructor");
+   if (other.fTrajectory) fTrajectory = new Trajectory(*(other.fTrajectory));
+}
+
+//_____________________________________________________________________________
+TrajectoryObserver& TrajectoryObserver::operator=(const TrajectoryObserver& other)
+{
+   // Assignment
+   Info("TrajectoryObserver","Assignment");
+   if(this!=&other) {
+      Observer::operator=(other);
+      if (fTrajectory) delete fTrajectory;
+      fTrajectory = new Trajectory(*(other.fTrajectory));
+   }
+   return *this;
+}
+
+//_____________________________________________________________________________
+TrajectoryObserver::~TrajectoryObserver()
+{
+   // Destructor
+   Info("TrajectoryObserver","Destructor");
+   if (fTrajectory != NULL) delete fTrajectory;
+}
+
+//_____________________________________________________________________________
+void TrajectoryObserver::RecordEvent(const Point& point, const TVector3& velocity, const std::string& context, const Clock& /*clock*/)
+{
+   // -- A new segment of free fall begins when the particle is created, and after each bounce
+   if (context == Context::Creation || context == Context::SpecBounce || context == Context::DiffBounce) {
+      fTrajectory->AddSegment(point, velocity);
+   }
+}
+
+//_____________________________________________________________________________
+void TrajectoryObserver::ResetData()
+{
+   // -- Remove the current track's segments, keeping the gravitational field
+   fTrajectory->Clear();
+}
+
+//_____________________________________________________________________________
+void TrajectoryObserver::WriteToFile(Data& data)
+{
+   // -- Mark where the track ended, and write it to the observer's branch on the tree
+   const Particle* particle = dynamic_cast<const Particle*>(this->GetSubject());
+   if (particle != NULL) fTrajectory->SetEndTime(particle->T());
+   data.WriteObjectToTree(fTrajectory, fTrajectory->GetName());
+}
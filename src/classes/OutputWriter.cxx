@@ -0,0 +1,154 @@
+// OutputWriter class
+#include <iostream>
+#include <cassert>
+
+#include <boost/bind.hpp>
+
+#include "OutputWriter.h"
+
+using namespace std;
+
+//#define VERBOSE_MODE
+
+//______________________________________________________________________________
+OutputWriter::OutputWriter(Data& data, const size_t capacity)
+             :fData(data),
+              fCapacity(capacity),
+              fThread(),
+              fMutex(),
+              fFileMutex(),
+              fOutputAvailable(),
+              fSpaceAvailable(),
+              fAllWritten(),
+              fQueue(),
+              fWriting(false),
+              fStopping(false),
+              fSubmitted(0),
+              fTotalDepth(0),
+              fMaxDepth(0),
+              fStalls(0),
+              fBusyTime(),
+              fStallTime()
+{
+   // -- Constructor
+   assert(fCapacity > 0);
+   fBusyTime.Reset();
+   fStallTime.Reset();
+}
+
+//______________________________________________________________________________
+OutputWriter::~OutputWriter()
+{
+   // -- Destructor
+   this->Stop();
+}
+
+//______________________________________________________________________________
+void OutputWriter::Start()
+{
+   // -- Launch the writer thread
+   #ifdef VERBOSE_MODE
+      cout << "Starting output writer thread, holding up to " << fCapacity << " tracks" << endl;
+   #endif
+   fThread = boost::thread(boost::bind(&OutputWriter::WriterLoop, this));
+}
+
+//______________________________________________________________________________
+void OutputWriter::Submit(Data::ObjectBuffer& buffer)
+{
+   // -- Queue a finished track's output to be written, taking the contents of 'buffer'.
+   // -- Blocks while the queue is full.
+   Data::ObjectBuffer* output = new Data::ObjectBuffer();
+   output->swap(buffer);
+   {
+      boost::mutex::scoped_lock lock(fMutex);
+      if (fQueue.size() >= fCapacity) {
+         fStalls++;
+         fStallTime.Start(kFALSE);
+         while (fQueue.size() >= fCapacity) {
+            fSpaceAvailable.wait(lock);
+         }
+         fStallTime.Stop();
+      }
+      fQueue.push_back(output);
+      fSubmitted++;
+      fTotalDepth += fQueue.size();
+      if (fQueue.size() > fMaxDepth) fMaxDepth = fQueue.size();
+   }
+   fOutputAvailable.notify_one();
+}
+
+//______________________________________________________________________________
+void OutputWriter::Flush()
+{
+   // -- Block until every track submitted so far has been written to the data tree
+   boost::mutex::scoped_lock lock(fMutex);
+   while (fQueue.empty() == false || fWriting == true) {
+      fAllWritten.wait(lock);
+   }
+}
+
+//______________________________________________________________________________
+void OutputWriter::Stop()
+{
+   // -- Wait for everything queued to be written, then stop the writer thread
+   {
+      boost::mutex::scoped_lock lock(fMutex);
+      fStopping = true;
+   }
+   fOutputAvailable.notify_all();
+   if (fThread.joinable()) fThread.join();
+   // If the writer was never started, write out whatever was queued here
+   while (fQueue.empty() == false) {
+      fData.WriteBufferToTree(*fQueue.front());
+      delete fQueue.front();
+      fQueue.pop_front();
+   }
+}
+
+//______________________________________________________________________________
+void OutputWriter::PrintStatistics()
+{
+   // -- Report how full the queue ran, and how long the writer and the run spent waiting
+   cout << "Output Writer: Tracks written: " << fSubmitted;
+   cout << "\t Mean queue depth: " << (fSubmitted > 0 ? (double)fTotalDepth/fSubmitted : 0.);
+   cout << "\t Max queue depth: " << fMaxDepth << " of " << fCapacity << endl;
+   cout << "Output Writer: Busy time (s): " << fBusyTime.RealTime();
+   cout << "\t Run waited for space " << fStalls << " times, for (s): " << fStallTime.RealTime() << endl;
+}
+
+//______________________________________________________________________________
+void OutputWriter::WriterLoop()
+{
+   // -- Body of the writer thread. Write out each track's output in the order it was
+   // -- submitted, until stopped with nothing left to write.
+   for (;;) {
+      Data::ObjectBuffer* output = NULL;
+      {
+         boost::mutex::scoped_lock lock(fMutex);
+         while (fQueue.empty() && fStopping == false) {
+            fOutputAvailable.wait(lock);
+         }
+         if (fQueue.empty()) break;
+         output = fQueue.front();
+         fQueue.pop_front();
+         fWriting = true;
+      }
+      fSpaceAvailable.notify_one();
+      {
+         boost::mutex::scoped_lock fileLock(fFileMutex);
+         fBusyTime.Start(kFALSE);
+         fData.WriteBufferToTree(*output);
+         fBusyTime.Stop();
+      }
+      #ifdef VERBOSE_MODE
+         cout << "Writer wrote a track, " << fQueue.size() << " waiting" << endl;
+      #endif
+      delete output;
+      {
+         boost::mutex::scoped_lock lock(fMutex);
+         fWriting = false;
+      }
+      fAllWritten.notify_all();
+   }
+}
@@ -127,3 +127,28 @@ Double_t Parabola::ArcLength(const Double_t* velocity, const Double_t* field, co
 	#endif
 	return solution1;
 }
+
+//_____________________________________________________________________________
+void Parabola::BoundingBox(const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t steptime, Double_t* lower, Double_t* upper) const
+{
+	// -- Calculate the smallest axis-aligned box containing the arc x(t) = point + velocity*t + 0.5*field*t^2
+	// -- for 0 <= t <= steptime. Along each axis the arc's extremes are at its ends, or at its turning point
+	// -- t = -velocity/field if that lies within the step.
+	for (Int_t axis = 0; axis < 3; axis++) {
+		const Double_t end = point[axis] + velocity[axis]*steptime + 0.5*field[axis]*steptime*steptime;
+		lower[axis] = TMath::Min(point[axis], end);
+		upper[axis] = TMath::Max(point[axis], end);
+		if (field[axis] != 0.) {
+			const Double_t turningTime = -velocity[axis]/field[axis];
+			if (turningTime > 0. && turningTime < steptime) {
+				const Double_t turningPoint = point[axis] - 0.5*velocity[axis]*velocity[axis]/field[axis];
+				lower[axis] = TMath::Min(lower[axis], turningPoint);
+				upper[axis] = TMath::Max(upper[axis], turningPoint);
+			}
+		}
+	}
+	#ifdef VERBOSE_MODE
+		Info("BoundingBox","Lower - x: %f, y: %f, z: %f", lower[0], lower[1], lower[2]);
+		Info("BoundingBox","Upper - x: %f, y: %f, z: %f", upper[0], upper[1], upper[2]);
+	#endif
+}
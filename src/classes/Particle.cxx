@@ -14,6 +14,8 @@
 #include "Observer.h"
 #include "Volume.h"
 #include "Clock.h"
+#include "NavigationCursor.h"
+#include "SpinIntegrator.h"
 #include "ValidStates.h"
 
 #include "TMath.h"
@@ -34,11 +36,36 @@ using namespace std;
 
 ClassImp(Particle)
 
+namespace {
+   //______________________________________________________________________________
+   // -- The magnetic field along the particle's free-fall path from the start of a step
+   class PathField : public SpinIntegrator::FieldSource
+   {
+   private:
+      const Experiment& fExperiment;
+      const TVector3 fPos, fVel, fGravity;
+      const Double_t fStartTime;
+   public:
+      PathField(const Experiment& experiment, const TVector3& pos, const TVector3& vel,
+                const TVector3& gravity, const Double_t startTime)
+         :fExperiment(experiment), fPos(pos), fVel(vel), fGravity(gravity), fStartTime(startTime) {}
+      
+      TVector3 Position(const Double_t time) const {
+         const Double_t dt = time - fStartTime;
+         return fPos + dt*fVel + (0.5*dt*dt)*fGravity;
+      }
+      TVector3 Velocity(const Double_t time) const {return fVel + (time - fStartTime)*fGravity;}
+      virtual TVector3 GetField(const Double_t time) {
+         return fExperiment.GetMagField(Point(this->Position(time), time), this->Velocity(time));
+      }
+   };
+}
+
 //______________________________________________________________________________
 Particle::Particle()
              :TObject(), Observable(),
               fId(0), fPos(), fVel(),
-              fState(NULL), fSpin(), fRndState(NULL)
+              fState(NULL), fSpin(), fSpinStep(0.), fRndSeed(0), fRndDrawIndex(0), fRandom(NULL)
 {
    // -- Default constructor
    #ifdef PRINT_CONSTRUCTORS
@@ -51,7 +78,7 @@ Particle::Particle()
 Particle::Particle(const unsigned int id, const Point pos, const TVector3 vel)
              :TObject(), Observable(),
               fId(id), fPos(pos), fVel(vel),
-              fState(NULL), fSpin(), fRndState(NULL)
+              fState(NULL), fSpin(), fSpinStep(0.), fRndSeed(0), fRndDrawIndex(0), fRandom(NULL)
 {
    // -- Constructor
    #ifdef PRINT_CONSTRUCTORS
@@ -64,14 +91,14 @@ Particle::Particle(const unsigned int id, const Point pos, const TVector3 vel)
 Particle::Particle(const Particle& other)
              :TObject(other), Observable(other),
               fId(other.fId), fPos(other.fPos), fVel(other.fVel),
-              fState(NULL), fSpin(other.fSpin), fRndState(NULL)
+              fState(NULL), fSpin(other.fSpin), fSpinStep(other.fSpinStep), fRndSeed(other.fRndSeed),
+              fRndDrawIndex(other.fRndDrawIndex), fRandom(NULL)
 {
    // -- Copy Constructor
    #ifdef PRINT_CONSTRUCTORS
       Info("Particle","Copy Constructor");
    #endif
       if (other.fState) fState = (other.fState)->Clone();
-      if (other.fRndState) fRndState = (other.fRndState)->Clone();
 }
 
 //_____________________________________________________________________________
@@ -88,10 +115,11 @@ Particle& Particle::operator=(const Particle& other)
       fPos = other.fPos;
       fVel = other.fVel;
       fSpin = other.fSpin;
+      fSpinStep = other.fSpinStep;
       if (fState) delete fState;
-      fState = (other.fState)->Clone();
-      if (fRndState) delete fRndState;
-      if (other.fRndState) fRndState = (other.fRndState)->Clone();
+      fState = (other.fState ? (other.fState)->Clone() : NULL);
+      fRndSeed = other.fRndSeed;
+      fRndDrawIndex = other.fRndDrawIndex;
    }
    return *this;
 }
@@ -104,7 +132,6 @@ Particle::~Particle()
       Info("Particle","Destructor");
    #endif
    if (fState) delete fState;
-   if (fRndState) delete fRndState;
 }
 
 //______________________________________________________________________________
@@ -152,16 +179,16 @@ void Particle::Print(const Option_t* /*option*/) const
 }
 
 //_____________________________________________________________________________
-Bool_t Particle::Propagate(Run* run)
+Bool_t Particle::Propagate(Run* run, Clock& clock)
 {
-   // -- Call State-dependent propagate method
+   // -- Call State-dependent propagate method, timing the particle with the provided clock
    if (!fState) fState = new Propagating();
-   return fState->Propagate(this,run);
+   return fState->Propagate(this,run,clock);
    return true;
 }
 
 //_____________________________________________________________________________
-void Particle::Move(const Double_t stepTime, const Run* run)
+void Particle::Move(const Double_t stepTime, const Run* run, Clock& clock)
 {
    // -- Move Particle by specified steptime and interact with any fields 
    // -- that may be present
@@ -190,9 +217,36 @@ void Particle::Move(const Double_t stepTime, const Run* run)
    if (gravity != NULL) {
       gravField.SetXYZ(gravity->Gx(), gravity->Gy(), gravity->Gz());
    }
+   const Double_t end = this->T() + stepTime;
+   const Double_t spinTolerance = run->GetRunConfig().SpinTolerance();
+   if (spinTolerance > 0.) {
+      // Let the spin integrator choose the steps, from how quickly the field along
+      // the path turns. Each track starts with a step of 'SpinStepTime'.
+      PathField path(run->GetExperiment(), TVector3(this->X(), this->Y(), this->Z()),
+                     this->GetVelocity(), gravField, this->T());
+      SpinIntegrator integrator(spinTolerance);
+      if (fSpinStep <= 0.) fSpinStep = interval;
+      while (this->T() < end) {
+         const Double_t startTime = this->T();
+         const Double_t spinInterval = integrator.Step(fSpin, path, startTime, end - startTime, fSpinStep);
+         const Double_t finalTime = (spinInterval < end - startTime ? startTime + spinInterval : end);
+         const Double_t halfwayTime = 0.5*(startTime + finalTime);
+         const Point halfwayPoint(path.Position(halfwayTime), halfwayTime);
+         const TVector3 halfwayVel = path.Velocity(halfwayTime);
+         const TVector3 pos = path.Position(finalTime);
+         const TVector3 vel = path.Velocity(finalTime);
+         // Update Clock
+         clock.Tick(finalTime - startTime);
+         // Update Particle
+         this->SetPosition(pos[0],pos[1],pos[2],finalTime);
+         this->SetVelocity(vel[0],vel[1],vel[2]);
+         // Notify observers of new field state, and of the spin precessed along the step
+         this->NotifyObservers(halfwayPoint, halfwayVel, Context::MagField, clock);
+         this->NotifyObservers(this->GetPoint(), this->GetVelocity(), Context::Spin, clock);
+      }
+   }
    // Make multiple small steps, of size 'interval', until we have made
    // one step of size 'stepTime'
-   const Double_t end = this->T() + stepTime;
    while (this->T() < end) {
       // Check if we will reach the end of stepTime within the next small step
       if (this->T() + interval > end) {interval = end - this->T();} 
@@ -216,16 +270,16 @@ void Particle::Move(const Double_t stepTime, const Run* run)
          vel[i] += gravField[i]*interval;
       }
       // Update Clock
-      Clock::Instance()->Tick(interval);
+      clock.Tick(interval);
       // Update Particle
       this->SetPosition(pos[0],pos[1],pos[2],finalTime);
       this->SetVelocity(vel[0],vel[1],vel[2]);
       // Measure the magnetic field at the halfway point along step
       const TVector3 field = run->GetExperiment().GetMagField(halfwayPoint,halfwayVel);
       // Notify observers of new field state
-      this->NotifyObservers(halfwayPoint, halfwayVel, Context::MagField);
+      this->NotifyObservers(halfwayPoint, halfwayVel, Context::MagField, clock);
       // Precess spin about measured magnetic field
-      this->PrecessSpin(field, interval);
+      this->PrecessSpin(field, interval, clock);
    }
    #ifdef VERBOSE_MODE
       cout << setw(10) << "Final - " << setw(4) << "X: " << setw(10) << this->X() << "\t";
@@ -239,7 +293,7 @@ void Particle::Move(const Double_t stepTime, const Run* run)
    #endif
    ///////////////////////////////////////////////////////////////////////////////////////
    // -- Notify Observers of Step Completion
-   this->NotifyObservers(this->GetPoint(), this->GetVelocity(), Context::Step);
+   this->NotifyObservers(this->GetPoint(), this->GetVelocity(), Context::Step, clock);
 }
 
 //_____________________________________________________________________________
@@ -281,7 +335,7 @@ Bool_t Particle::WillDecay(const Double_t timeInterval)
 {
    // Calculate probability particle will decay within timeInterval, and then roll the dice!
    Double_t probDecay = (timeInterval/Neutron::lifetime);
-   if (gRandom->Uniform(0.0, 1.0) < probDecay) { return kTRUE; }
+   if (this->GetRandomGenerator()->Uniform(0.0, 1.0) < probDecay) { return kTRUE; }
    return kFALSE;
 }
 
@@ -318,12 +372,12 @@ void Particle::Polarise(const TVector3& axis, const Bool_t up)
 }
 
 //_____________________________________________________________________________
-void Particle::PrecessSpin(const TVector3& field, const Double_t precessTime)
+void Particle::PrecessSpin(const TVector3& field, const Double_t precessTime, const Clock& clock)
 {
    // -- Precess spin about field for time defined by precessTime 
    fSpin.Precess(field,precessTime);
    // Notify Observers of spin state change
-   NotifyObservers(this->GetPoint(), this->GetVelocity(), Context::Spin);
+   NotifyObservers(this->GetPoint(), this->GetVelocity(), Context::Spin, clock);
 }
 
 //_____________________________________________________________________________
@@ -334,7 +388,7 @@ Bool_t Particle::IsSpinUp(const TVector3& axis) const
 }
 
 //_____________________________________________________________________________
-Bool_t Particle::Reflect(const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const char* initialPath)
+Bool_t Particle::Reflect(const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const NavigationCursor& initialCursor, const Clock& clock)
 {
    // -- Reflect particle
    #ifdef VERBOSE_MODE
@@ -358,20 +412,20 @@ Bool_t Particle::Reflect(const Double_t* normal, TGeoNavigator* navigator, TGeoN
    // -- Calculate Probability of diffuse reflection
    Double_t diffuseProbability = this->DiffuseProbability(boundary, norm);
    // Determine Reflection Type 
-   if (gRandom->Uniform(0.0,1.0) <= diffuseProbability) {
+   if (this->GetRandomGenerator()->Uniform(0.0,1.0) <= diffuseProbability) {
       // -- Diffuse Bounce
       this->DiffuseBounce(navigator, norm);
-      this->NotifyObservers(this->GetPoint(), this->GetVelocity(), Context::DiffBounce);
+      this->NotifyObservers(this->GetPoint(), this->GetVelocity(), Context::DiffBounce, clock);
    } else {
       // -- Specular Bounce
       this->SpecularBounce(norm);
-      this->NotifyObservers(this->GetPoint(), this->GetVelocity(), Context::SpecBounce);
+      this->NotifyObservers(this->GetPoint(), this->GetVelocity(), Context::SpecBounce, clock);
    }
    // Update Navigator
    navigator->SetCurrentDirection(this->Nx(), this->Ny(), this->Nz());
    //------------------------------------------------------
    // Change navigator state back to the initial node after bounce
-   if (navigator->cd(initialPath) == kFALSE) {
+   if (initialCursor.Restore(navigator) == kFALSE) {
       Error("MakeStep","Unable to cd to initial node after bounce!");
       throw runtime_error("Unable to cd to initial node");
    }
@@ -432,13 +486,13 @@ void Particle::DiffuseBounce(TGeoNavigator* navigator, const Double_t* norm)
    // Correct method for UCN physics though is to weight these angles towards the poles by adding
    // an extra cos(theta). Derivation of how to pick these angles is in notes
    // Overall solid angle used is dOmega = cos(theta)sin(theta) dtheta dphi
-   Double_t phi = gRandom->Uniform(0.0, 1.0)*2*TMath::Pi();
+   Double_t phi = this->GetRandomGenerator()->Uniform(0.0, 1.0)*2*TMath::Pi();
    // We do not want the full range of theta from 0 to pi/2 however.
    // An angle of pi/2 would imply moving off the boundary exactly parallel to
    // the current surface.Therefore we should restrict theta to a slightly smaller
    // proportion of angles - letting u be between 0 and 0.499, ensures theta
    // is between 0 and ~89 degrees. 
-   Double_t u = gRandom->Uniform(0.0, 0.499);
+   Double_t u = this->GetRandomGenerator()->Uniform(0.0, 0.499);
    // We ignore the negative sqrt term when selecting theta,
    // since we are only interested in theta between 0 and pi/2 
    // (negative root provides the pi/2 to pi branch) 
@@ -535,7 +589,9 @@ Double_t Particle::DiffuseProbability(const Boundary* boundary, const Double_t*
 }
 
 //______________________________________________________________________________
-void Particle::SaveRandomGeneratorState(const TRandom3State& rndState)
+void Particle::SaveRandomGeneratorState(const UInt_t seed, const ULong64_t drawIndex)
 {
-   fRndState = new TRandom3State(rndState);
+   // -- Record where in its random stream the particle's propagation began
+   fRndSeed = seed;
+   fRndDrawIndex = drawIndex;
 }
@@ -0,0 +1,117 @@
+// ParticleColumns class
+
+#include <iostream>
+#include <sstream>
+
+#include "ParticleColumns.h"
+#include "Particle.h"
+#include "ValidStates.h"
+
+#include "TTree.h"
+#include "TBranch.h"
+
+using namespace std;
+
+//______________________________________________________________________________
+ParticleColumns::ParticleColumns()
+                :fId(0),
+                 fX(0.), fY(0.), fZ(0.), fT(0.),
+                 fVx(0.), fVy(0.), fVz(0.),
+                 fUpRe(0.), fUpIm(0.), fDownRe(0.), fDownIm(0.),
+                 fState(States::kUnknown),
+                 fBranches()
+{
+   // -- Constructor
+}
+
+//______________________________________________________________________________
+vector<ParticleColumns::Column> ParticleColumns::Columns()
+{
+   // -- Name, address and type of each column
+   const Column columns[] = {
+      {"id", &fId, 'I'},
+      {"x", &fX, 'D'}, {"y", &fY, 'D'}, {"z", &fZ, 'D'}, {"t", &fT, 'D'},
+      {"vx", &fVx, 'D'}, {"vy", &fVy, 'D'}, {"vz", &fVz, 'D'},
+      {"up_re", &fUpRe, 'D'}, {"up_im", &fUpIm, 'D'},
+      {"down_re", &fDownRe, 'D'}, {"down_im", &fDownIm, 'D'},
+      {"state", &fState, 'I'}
+   };
+   return vector<Column>(columns, columns + sizeof(columns)/sizeof(Column));
+}
+
+//______________________________________________________________________________
+void ParticleColumns::Set(const Particle& particle)
+{
+   // -- Take the values of each column from the particle
+   fId = particle.Id();
+   fX = particle.X();
+   fY = particle.Y();
+   fZ = particle.Z();
+   fT = particle.T();
+   fVx = particle.Vx();
+   fVy = particle.Vy();
+   fVz = particle.Vz();
+   const Spinor& spinor = particle.GetSpin().GetSpinor();
+   fUpRe = spinor.UpRe();
+   fUpIm = spinor.UpIm();
+   fDownRe = spinor.DownRe();
+   fDownIm = spinor.DownIm();
+   fState = States::StateCode(particle.GetState().GetName());
+}
+
+//______________________________________________________________________________
+Int_t ParticleColumns::Fill(TTree& tree, const string& prefix)
+{
+   // -- Add the current values as the next entry of each column's branch, creating the
+   // -- branches on first use
+   Int_t bytesCopied = 0;
+   const vector<Column> columns = this->Columns();
+   vector<Column>::const_iterator columnIter;
+   for (columnIter = columns.begin(); columnIter != columns.end(); ++columnIter) {
+      const string name = prefix + "_" + columnIter->fName;
+      TBranch* branch = tree.GetBranch(name.c_str());
+      if (branch == NULL) {
+         const string leafList = string(columnIter->fName) + "/" + columnIter->fType;
+         branch = tree.Branch(name.c_str(), columnIter->fAddress, leafList.c_str());
+      } else {
+         branch->SetAddress(columnIter->fAddress);
+      }
+      bytesCopied += branch->Fill();
+   }
+   return bytesCopied;
+}
+
+//______________________________________________________________________________
+Bool_t ParticleColumns::Attach(TTree& tree, const string& prefix, const string& selection)
+{
+   // -- Prepare to read the selected columns from the tree. Returns false if any of them
+   // -- are missing, as they are from files written without the columnar output.
+   fBranches.clear();
+   const string padded = "," + selection + ",";
+   const vector<Column> columns = this->Columns();
+   vector<Column>::const_iterator columnIter;
+   for (columnIter = columns.begin(); columnIter != columns.end(); ++columnIter) {
+      const string column = columnIter->fName;
+      if (selection.empty() == false && padded.find("," + column + ",") == string::npos) continue;
+      TBranch* branch = tree.GetBranch((prefix + "_" + column).c_str());
+      if (branch == NULL) {
+         fBranches.clear();
+         return kFALSE;
+      }
+      branch->SetAddress(columnIter->fAddress);
+      fBranches.push_back(branch);
+   }
+   return (fBranches.empty() ? kFALSE : kTRUE);
+}
+
+//______________________________________________________________________________
+Int_t ParticleColumns::GetEntry(const Long64_t entry)
+{
+   // -- Read the attached columns of the given entry
+   Int_t bytesRead = 0;
+   vector<TBranch*>::iterator branchIter;
+   for (branchIter = fBranches.begin(); branchIter != fBranches.end(); ++branchIter) {
+      bytesRead += (*branchIter)->GetEntry(entry);
+   }
+   return bytesRead;
+}
@@ -156,6 +156,22 @@ Listing ParticleManifest::GetListing(const vector<string> states) const
    return newListing;
 }
 
+//______________________________________________________________________________
+void ParticleManifest::Append(const ParticleManifest& other, const int indexOffset)
+{
+   // -- Add every entry of another manifest to this one, for when the other's tree has been
+   // -- appended to this one's. Its tree indexes are shifted along by 'indexOffset'.
+   map<string, Listing>::const_iterator iter;
+   for (iter = other.fDictionary.begin(); iter != other.fDictionary.end(); iter++) {
+      const Listing& listing = iter->second;
+      const vector<int>& ids = listing.GetParticleIDs();
+      const vector<int>& indexes = listing.GetTreeIndexes();
+      for (size_t entry = 0; entry < indexes.size(); entry++) {
+         this->AddEntry(listing.GetName(), ids[entry], indexes[entry] + indexOffset);
+      }
+   }
+}
+
 //______________________________________________________________________________
 void ParticleManifest::Print() const
 {
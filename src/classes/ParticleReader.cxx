@@ -0,0 +1,97 @@
+// ParticleReader class
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+
+#include "ParticleReader.h"
+
+#include "TTree.h"
+#include "TBranch.h"
+#include "RVersion.h"
+
+using namespace std;
+
+//#define VERBOSE_MODE
+
+//______________________________________________________________________________
+ParticleReader::ParticleReader(TTree& tree, TBranch& branch, const vector<int>& indexes, const size_t batchSize)
+               :fTree(tree),
+                fBranch(branch),
+                fIndexes(indexes),
+                fBatchSize(batchSize),
+                fBatch(),
+                fBatchStart(0),
+                fNext(0),
+                fMutex()
+{
+   // -- Constructor. Set the tree's cache to hold only the input branch, over the range of
+   // -- entries selected.
+   assert(fBatchSize > 0);
+   if (fIndexes.empty()) return;
+   fTree.SetCacheSize(kCacheSize);
+   #if ROOT_VERSION_CODE >= ROOT_VERSION(5,26,0)
+      fTree.AddBranchToCache(fBranch.GetName(), kTRUE);
+      const int first = *min_element(fIndexes.begin(), fIndexes.end());
+      const int last = *max_element(fIndexes.begin(), fIndexes.end());
+      fTree.SetCacheEntryRange(first, last + 1);
+      fTree.StopCacheLearningPhase();
+   #endif
+}
+
+//______________________________________________________________________________
+ParticleReader::~ParticleReader()
+{
+   // -- Destructor
+   fTree.SetCacheSize(0);
+}
+
+//______________________________________________________________________________
+Particle* ParticleReader::Next()
+{
+   // -- Return a copy of the next particle, owned by the caller, or NULL once every
+   // -- particle has been handed out or if one cannot be read
+   boost::mutex::scoped_lock lock(fMutex);
+   if (fNext >= fIndexes.size()) return NULL;
+   if (fNext >= fBatchStart + fBatch.size()) {
+      if (this->ReadBatch() == kFALSE) return NULL;
+   }
+   Particle* particle = new Particle(fBatch[fNext - fBatchStart]);
+   fNext++;
+   return particle;
+}
+
+//______________________________________________________________________________
+size_t ParticleReader::Remaining()
+{
+   // -- Number of particles yet to be handed out
+   boost::mutex::scoped_lock lock(fMutex);
+   return fIndexes.size() - fNext;
+}
+
+//______________________________________________________________________________
+Bool_t ParticleReader::ReadBatch()
+{
+   // -- Decode the next batch of particles, each straight into its place in the batch
+   fBatchStart = fNext;
+   const size_t batchEnd = min(fNext + fBatchSize, fIndexes.size());
+   // Start from freshly constructed particles, rather than assigning over the last batch
+   fBatch.clear();
+   fBatch.resize(batchEnd - fBatchStart);
+   for (size_t i = 0; i < fBatch.size(); i++) {
+      const int index = fIndexes[fBatchStart + i];
+      if (index < 0 || index >= fBranch.GetEntries()) {
+         ::Error("ParticleReader::ReadBatch","Requested index, %i, is larger than number of particles", index);
+         fBatch.resize(i);
+         break;
+      }
+      Particle* address = &fBatch[i];
+      fBranch.SetAddress(&address);
+      fBranch.GetEntry(index);
+   }
+   // The address set above does not outlive this method
+   fTree.ResetBranchAddress(&fBranch);
+   #ifdef VERBOSE_MODE
+      cout << "Read " << fBatch.size() << " particles, from position " << fBatchStart << endl;
+   #endif
+   return (fBatch.empty() ? kFALSE : kTRUE);
+}
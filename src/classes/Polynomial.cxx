@@ -4,6 +4,7 @@
 #include <vector>
 #include <stdexcept>
 #include <cassert>
+#include <cfloat>
 
 #include "TMath.h"
 #include "TGeoShape.h"
@@ -137,6 +138,7 @@ Int_t Polynomial::QuarticRootFinder(const Double_t* params, Double_t* roots)
    // -- Solves quartic equation for all REAL solutions to a polynomial of form
    // -- ax^4 + bx^3 + cx^2 + dx + e = 0 
    // -- Takes 5 parameters and 4 roots as arguments.	
+   // -- Uses Ferrari's method, followed by a Newton polish of each root. Makes no allocations.
    Double_t a = params[0], b = params[1], c = params[2], d = params[3], e = params[4];
    // Check that we actually have a quartic equation
    assert(a != 0.0); 
@@ -156,6 +158,97 @@ Int_t Polynomial::QuarticRootFinder(const Double_t* params, Double_t* roots)
    }
    // Get quartic into the standard form: x^4 + a3*x^3 + a2*x^2 + a1*x + a0 = 0   --  see notes
    const Double_t a3 = b/a, a2 = c/a, a1 = d/a, a0 = e/a;
+   const Double_t coeffs[4] = {a3, a2, a1, a0};
+   // Substitute x = y - a3/4 to remove the cubic term: y^4 + p*y^2 + q*y + r = 0
+   const Double_t shift = 0.25*a3;
+   const Double_t a3Sq = a3*a3;
+   const Double_t p = a2 - 0.375*a3Sq;
+   const Double_t q = a1 - 0.5*a3*a2 + 0.125*a3Sq*a3;
+   const Double_t r = a0 - 0.25*a3*a1 + 0.0625*a3Sq*a2 - 0.01171875*a3Sq*a3Sq;
+   #ifdef VERBOSE_MODE
+      cout << "QuarticRootFinder - Depressed quartic - p: " << p << "\t" << "q: " << q << "\t" << "r: " << r << endl;
+   #endif
+   Double_t depressedRoots[4] = {0.,0.,0.,0.};
+   Int_t numRoots = 0;
+   // q is only zero up to the rounding errors of the terms it was built from
+   const Double_t qScale = TMath::Abs(a1) + TMath::Abs(0.5*a3*a2) + TMath::Abs(0.125*a3Sq*a3);
+   if (TMath::Abs(q) <= 1.E-14*qScale) {
+      // Biquadratic: z^2 + p*z + r = 0, with z = y^2
+      Double_t zRoots[2] = {0.,0.};
+      const Int_t zSolutions = this->RealQuadraticRoots(p, r, zRoots);
+      for (Int_t i = 0; i < zSolutions; i++) {
+         if (zRoots[i] >= 0.0) {
+            const Double_t y = TMath::Sqrt(zRoots[i]);
+            depressedRoots[numRoots++] = y;
+            depressedRoots[numRoots++] = -y;
+         }
+      }
+   } else {
+      // Ferrari - find the largest root, m, of the resolvent cubic
+      // m^3 + p*m^2 + (p^2/4 - r)*m - q^2/8 = 0
+      // This is always positive, since the cubic is negative at m = 0 and q != 0
+      Double_t cubicRoots[3] = {0.,0.,0.};
+      const Int_t cubicSolutions = gsl_poly_solve_cubic(p, 0.25*p*p - r, -0.125*q*q, &cubicRoots[0], &cubicRoots[1], &cubicRoots[2]);
+      Double_t m = cubicRoots[cubicSolutions-1];
+      // Polish m, since the quartic's roots are sensitive to it
+      for (Int_t iter = 0; iter < 2 && m > 0.0; iter++) {
+         const Double_t f = ((m + p)*m + (0.25*p*p - r))*m - 0.125*q*q;
+         const Double_t df = (3.0*m + 2.0*p)*m + (0.25*p*p - r);
+         if (df == 0.0) break;
+         m -= f/df;
+      }
+      if (m <= 0.0) {
+         // Lost to rounding errors - fall back to the general solver
+         Warning("QuarticRootFinder","Resolvent cubic has no positive root. Using general solver.");
+         return this->ComplexQuarticRootFinder(params, roots);
+      }
+      // The quartic factorises into the two quadratics
+      // y^2 -/+ s*y + (p/2 + m +/- q/(2s)) = 0, where s = sqrt(2m)
+      const Double_t s = TMath::Sqrt(2.0*m);
+      const Double_t qTerm = 0.5*q/s;
+      numRoots += this->RealQuadraticRoots(-s, 0.5*p + m + qTerm, &depressedRoots[numRoots]);
+      numRoots += this->RealQuadraticRoots(s, 0.5*p + m - qTerm, &depressedRoots[numRoots]);
+   }
+   // Undo the substitution and polish each root against the original quartic
+   for (Int_t i = 0; i < numRoots; i++) {
+      roots[i] = this->PolishQuarticRoot(coeffs, depressedRoots[i] - shift);
+   }
+   #ifdef VERBOSE_MODE
+      cout << "---------------------------" << endl;
+      cout << "Ferrari Quartic Root Finder" << endl;
+      cout << "No. of Roots: " << numRoots << endl;
+      for (Int_t i = 0; i < numRoots; i++) {cout << i << ": " << roots[i] << "\t";}
+      cout << endl << "---------------------------" << endl;
+   #endif
+   return numRoots;
+}
+
+//_____________________________________________________________________________
+Int_t Polynomial::ComplexQuarticRootFinder(const Double_t* params, Double_t* roots)
+{
+   // -- Solves quartic equation for all REAL solutions to a polynomial of form
+   // -- ax^4 + bx^3 + cx^2 + dx + e = 0, using GSL's general complex polynomial solver.
+   // -- Allocates a workspace on every call, so is no longer used during propagation, but is
+   // -- kept as the reference for the closed-form solver (see test_polynomial).
+   Double_t a = params[0], b = params[1], c = params[2], d = params[3], e = params[4];
+   // Check that we actually have a quartic equation
+   assert(a != 0.0); 
+   #ifdef VERBOSE_MODE
+      cout << "ComplexQuarticRootFinder - a: " << a << "\t" << "b: " << b << "\t" << "c: " << c << "\t" << "d: " << d << "\t" << "e: " << e << endl;
+   #endif
+   // If e = 0, then one of the solutions must be zero (since we can then factor a 't'
+   // out of each term), and so we actually have a cubic equation. Set the 4th root
+   // to zero and pass the remaining parameters to the cubic root finder. 
+   if (e == 0.0) {
+      #ifdef VERBOSE_MODE
+         cout << "ComplexQuarticRootFinder - Constant parameter is zero, implying one solution is zero. Remaining equation is now a cubic." << endl;
+      #endif
+      roots[3] = 0.0;
+      Double_t cubicParams[4] = {a, b, c, d};
+      return this->CubicRootFinder(cubicParams, roots);
+   }
+   // Get quartic into the standard form: x^4 + a3*x^3 + a2*x^2 + a1*x + a0 = 0   --  see notes
+   const Double_t a3 = b/a, a2 = c/a, a1 = d/a, a0 = e/a;
    // Solve Quartic using GNU Scientific Library's general polynomial complex solver
    double std_params[5] = { a0, a1, a2, a3, 1};
    double complexRoots[8];
@@ -187,6 +280,163 @@ Int_t Polynomial::QuarticRootFinder(const Double_t* params, Double_t* roots)
    return realroots.size();
 }
 
+//_____________________________________________________________________________
+Bool_t Polynomial::HasRootInInterval(const Double_t* params, const Int_t degree, const Double_t tmin, const Double_t tmax)
+{
+   // -- Whether params[0]*x^degree + ... + params[degree] crosses zero anywhere in (tmin, tmax].
+   // -- Used to ask whether a boundary can be reached within a step at all, without solving for
+   // -- the time at which it is. A root that only touches zero without crossing it is ignored.
+   Double_t root = 0.;
+   return this->SearchInterval(params, degree, tmin, tmax, kFALSE, root);
+}
+
+//_____________________________________________________________________________
+Bool_t Polynomial::FirstRootInInterval(const Double_t* params, const Int_t degree, const Double_t tmin, const Double_t tmax, Double_t& root)
+{
+   // -- Find the smallest real root of params[0]*x^degree + ... + params[degree] lying in
+   // -- (tmin, tmax]. Returns kFALSE, leaving 'root' untouched, if there is none. The roots
+   // -- outside of the interval are never computed, and when the whole interval can be excluded
+   // -- at once (the usual case for a boundary out of reach of the current step) this costs
+   // -- little more than a single evaluation of the polynomial. A root that only touches zero
+   // -- without crossing it is not reported.
+   return this->SearchInterval(params, degree, tmin, tmax, kTRUE, root);
+}
+
+//_____________________________________________________________________________
+Bool_t Polynomial::SearchInterval(const Double_t* params, const Int_t degree, const Double_t tmin, const Double_t tmax, const Bool_t refine, Double_t& root) const
+{
+   // -- Common part of HasRootInInterval and FirstRootInInterval
+   assert(degree >= 0 && degree <= 4);
+   if (tmax <= tmin) return kFALSE;
+   // Drop any vanishing leading coefficients
+   Int_t first = 0;
+   while (first < degree && params[first] == 0.0) first++;
+   const Double_t* p = &params[first];
+   const Int_t n = degree - first;
+   if (n < 1) return kFALSE;
+   // Derivative, used to tell when a piece of the interval is monotonic
+   Double_t dp[4];
+   for (Int_t i = 0; i < n; i++) dp[i] = (n - i)*p[i];
+   return this->IsolateFirstRoot(p, dp, n, tmin, tmax, 0, refine, root);
+}
+
+//_____________________________________________________________________________
+Int_t Polynomial::RealQuadraticRoots(const Double_t b, const Double_t c, Double_t* roots) const
+{
+   // -- Real roots of y^2 + b*y + c = 0. As with the general complex solver, a pair of complex
+   // -- roots whose imaginary part is below Units::tolerance is treated as a repeated real root.
+   const Double_t discriminant = b*b - 4.0*c;
+   if (discriminant < 0.0) {
+      if (0.5*TMath::Sqrt(-discriminant) >= Units::tolerance) return 0;
+      roots[0] = -0.5*b;
+      roots[1] = -0.5*b;
+      return 2;
+   }
+   // Avoid the cancellation between -b and the square root
+   const Double_t sqrtDiscriminant = TMath::Sqrt(discriminant);
+   const Double_t t = -0.5*(b + (b >= 0.0 ? sqrtDiscriminant : -sqrtDiscriminant));
+   if (t == 0.0) {
+      roots[0] = 0.0;
+      roots[1] = 0.0;
+   } else {
+      roots[0] = t;
+      roots[1] = c/t;
+   }
+   return 2;
+}
+
+//_____________________________________________________________________________
+Double_t Polynomial::PolishQuarticRoot(const Double_t* coeffs, const Double_t root) const
+{
+   // -- Refine a root of x^4 + a3*x^3 + a2*x^2 + a1*x + a0 with Newton steps, for as long as
+   // -- each step reduces the residual. Usually one or two steps are taken, but more are
+   // -- needed when a is small and the depressed quartic has lost precision.
+   const Double_t a3 = coeffs[0], a2 = coeffs[1], a1 = coeffs[2], a0 = coeffs[3];
+   Double_t x = root;
+   Double_t f = (((x + a3)*x + a2)*x + a1)*x + a0;
+   for (Int_t iter = 0; iter < 8 && f != 0.0; iter++) {
+      const Double_t df = ((4.0*x + 3.0*a3)*x + 2.0*a2)*x + a1;
+      if (df == 0.0) break;
+      const Double_t xNew = x - f/df;
+      const Double_t fNew = (((xNew + a3)*xNew + a2)*xNew + a1)*xNew + a0;
+      if (TMath::Abs(fNew) >= TMath::Abs(f)) break;
+      x = xNew;
+      f = fNew;
+   }
+   return x;
+}
+
+//_____________________________________________________________________________
+Bool_t Polynomial::ExcludesRoots(const Double_t* params, const Int_t degree, const Double_t tmin, const Double_t tmax) const
+{
+   // -- Cheap test for there being no root in [tmin, tmax]. Expanding the polynomial about tmin,
+   // -- p(tmin + h) = p(tmin) + sum_k c_k*h^k, and the sum can never exceed sum_k |c_k|*dt^k over
+   // -- the interval. When |p(tmin)| is larger than that, p cannot reach zero.
+   // Taylor coefficients about tmin, by repeated synthetic division
+   Double_t c[5];
+   for (Int_t i = 0; i <= degree; i++) c[i] = params[i];
+   for (Int_t k = 0; k < degree; k++) {
+      for (Int_t i = 1; i <= degree - k; i++) c[i] += c[i-1]*tmin;
+   }
+   // c[degree] is now p(tmin), and c[degree-k] the coefficient of h^k
+   const Double_t dt = tmax - tmin;
+   Double_t bound = 0.;
+   for (Int_t i = 0; i < degree; i++) bound = (bound + TMath::Abs(c[i]))*dt;
+   return (TMath::Abs(c[degree]) > bound ? kTRUE : kFALSE);
+}
+
+//_____________________________________________________________________________
+Bool_t Polynomial::IsolateFirstRoot(const Double_t* p, const Double_t* dp, const Int_t n, const Double_t lo, const Double_t hi, const Int_t depth, const Bool_t refine, Double_t& root) const
+{
+   // -- Look for the first crossing of zero in (lo, hi]. The interval is split until each piece
+   // -- either provably holds no root, or is monotonic and so holds at most one, which is then
+   // -- refined by Newton's method. The lower half is always searched before the upper half.
+   if (this->ExcludesRoots(p, n, lo, hi) == kTRUE) return kFALSE;
+   Double_t flo = 0., fhi = 0.;
+   for (Int_t i = 0; i <= n; i++) {flo = flo*lo + p[i]; fhi = fhi*hi + p[i];}
+   const Bool_t crossing = (fhi == 0.0 || (flo < 0.0 && fhi > 0.0) || (flo > 0.0 && fhi < 0.0));
+   if (crossing == kTRUE && refine == kFALSE) return kTRUE;
+   // If the derivative keeps one sign, p is monotonic here and has at most one root
+   const Bool_t monotonic = this->ExcludesRoots(dp, n - 1, lo, hi);
+   if (monotonic == kTRUE || depth >= 60 || hi - lo <= 4.0*DBL_EPSILON*TMath::Max(1.0, TMath::Abs(hi))) {
+      if (crossing == kFALSE) return kFALSE;
+      root = (fhi == 0.0 ? hi : this->RefineBracketedRoot(p, n, lo, hi, flo));
+      return kTRUE;
+   }
+   const Double_t mid = 0.5*(lo + hi);
+   if (this->IsolateFirstRoot(p, dp, n, lo, mid, depth + 1, refine, root) == kTRUE) return kTRUE;
+   return this->IsolateFirstRoot(p, dp, n, mid, hi, depth + 1, refine, root);
+}
+
+//_____________________________________________________________________________
+Double_t Polynomial::RefineBracketedRoot(const Double_t* p, const Int_t n, const Double_t lo, const Double_t hi, const Double_t flo) const
+{
+   // -- Newton's method for a root bracketed by a change of sign between lo and hi, falling
+   // -- back on bisection whenever a step would leave the bracket
+   Double_t xNeg = (flo < 0.0 ? lo : hi);
+   Double_t xPos = (flo < 0.0 ? hi : lo);
+   Double_t x = 0.5*(lo + hi);
+   Double_t dx = hi - lo, dxOld = dx;
+   Double_t f = 0., df = 0.;
+   for (Int_t i = 0; i <= n; i++) {df = df*x + f; f = f*x + p[i];}
+   for (Int_t iter = 0; iter < 100 && f != 0.0; iter++) {
+      if ((((x - xPos)*df - f)*((x - xNeg)*df - f) > 0.0) || (TMath::Abs(2.0*f) > TMath::Abs(dxOld*df))) {
+         dxOld = dx;
+         dx = 0.5*(xPos - xNeg);
+         x = xNeg + dx;
+      } else {
+         dxOld = dx;
+         dx = f/df;
+         x -= dx;
+      }
+      if (TMath::Abs(dx) <= DBL_EPSILON*TMath::Max(1.0, TMath::Abs(x))) break;
+      f = 0.; df = 0.;
+      for (Int_t i = 0; i <= n; i++) {df = df*x + f; f = f*x + p[i];}
+      if (f < 0.0) {xNeg = x;} else {xPos = x;}
+   }
+   return x;
+}
+
 //_____________________________________________________________________________
 Int_t Polynomial::AnalyticQuadraticAlgorithm(const Double_t a, const Double_t b, const Double_t c, Double_t* roots)
 {
@@ -25,3 +25,18 @@ void PopulationData::Fill(double currentTime, std::string statename)
    // Increment counter in table for this state
    tableIter->second += 1;
 }
+
+//______________________________________________________________________________
+void PopulationData::Add(const PopulationData& other)
+{
+   // -- Sum the population counts of another PopulationData into this one
+   typedef map<double, map<string, int> > popdata;
+   popdata::const_iterator timeBinIter;
+   for (timeBinIter = other.begin(); timeBinIter != other.end(); ++timeBinIter) {
+      map<string, int>& populationTable = (*this)[timeBinIter->first];
+      map<string, int>::const_iterator tableIter;
+      for (tableIter = timeBinIter->second.begin(); tableIter != timeBinIter->second.end(); ++tableIter) {
+         populationTable[tableIter->first] += tableIter->second;
+      }
+   }
+}
@@ -5,6 +5,10 @@
 #include <sstream>
 #include <cassert>
 #include <stdexcept>
+#include <algorithm>
+#include <ctime>
+
+#include <boost/scoped_ptr.hpp>
 
 #include "Run.h"
 #include "ConfigFile.h"
@@ -12,9 +16,19 @@
 #include "Particle.h"
 #include "Data.h"
 #include "Clock.h"
+#include "Polynomial.h"
+#include "Parabola.h"
+#include "ThreadPool.h"
+#include "OutputWriter.h"
+#include "FieldLookupContext.h"
+#include "RunStatistics.h"
 
 #include "TFile.h"
+#include "TClass.h"
+#include "TThread.h"
 #include "TRandom.h"
+#include "TRandomPhilox.h"
+#include "RVersion.h"
 
 #include "Algorithms.h"
 #include "Units.h"
@@ -83,21 +97,16 @@ Run::~Run()
 }
 
 //_____________________________________________________________________________
-Bool_t Run::Initialise()
+Bool_t Run::Initialise(const Bool_t resume)
 {
    // -- Initialise the Run. Build the Experiment Object which loads the Geometry and fields
    // -- into memory. Build the Data Object which loads the data files and initial particles.
    // -- Finally check Run parameters in the RunConfig object for further instructions.
+   // -- If resuming, the Data carries on from the output file's last checkpoint.
    cout << "-------------------------------------------" << endl;
    cout << "Initialising: " << this->GetName() << endl;
    cout << "-------------------------------------------" << endl;
    ///////////////////////////////////////////////////////////////////////////////////////
-   // -- Setup the Clock
-   if (Clock::Instance()->Initialise(this->GetRunConfig()) == kFALSE) {
-      Error("Initialise","Failed to initialise the Clock");
-      return kFALSE;
-   }
-   ///////////////////////////////////////////////////////////////////////////////////////
    // -- Build Geometry
    ///////////////////////////////////////////////////////////////////////////////////////
    if (fExperiment->Initialise(this->GetRunConfig()) == kFALSE) {
@@ -107,12 +116,14 @@ Bool_t Run::Initialise()
    ///////////////////////////////////////////////////////////////////////////////////////
    // -- Initialise the DataFile and load initial particles
    ///////////////////////////////////////////////////////////////////////////////////////
-   if (this->GetData().Initialise(this->GetRunConfig()) == kFALSE) {
+   if (this->GetData().Initialise(this->GetRunConfig(), resume) == kFALSE) {
       Error("Initialise","Failed to Load the Initial Particle Distribution from File");
       return kFALSE;
    }
    // -- Create any observers selected by user
    this->GetData().CreateObservers(this->GetRunConfig(), *fExperiment);
+   // -- Carry on from the data the 'PerRun' observers had recorded at the checkpoint
+   if (resume == kTRUE) this->GetData().RestoreRunObservers();
    ///////////////////////////////////////////////////////////////////////////////////////
    // -- Check Run Parameters
    // Run Time
@@ -136,82 +147,296 @@ Bool_t Run::Initialise()
 //_____________________________________________________________________________
 Bool_t Run::Start()
 {
-   // -- Initialise the Random number generator to a TRandom3a
-   gRandom = new TRandom3a();
-   TRandom3a* rndGenerator = dynamic_cast<TRandom3a*>(gRandom);
+   // -- Initialise the Random number generator to a TRandomPhilox
+   TRandomPhilox* rndGenerator = new TRandomPhilox(this->GetRunConfig().RandomSeed());
+   gRandom = rndGenerator;
    // -- Propagate the particles stored in the Run's Data, specified by configFile
    vector<int> selectedParticles = fData.GetListOfParticlesToLoad(fRunConfig);
+   // -- If resuming, skip the particles completed before the last checkpoint
+   const vector<int>& completedParticles = fData.CompletedIndexes();
+   if (completedParticles.size() > selectedParticles.size() ||
+       equal(completedParticles.begin(), completedParticles.end(), selectedParticles.begin()) == false) {
+      Error("Start","Particles completed at the checkpoint are not those selected by the runconfig");
+      return kFALSE;
+   }
+   const size_t firstParticle = completedParticles.size();
+   vector<int> remainingParticles(selectedParticles.begin() + firstParticle, selectedParticles.end());
+   if (fData.PrefetchParticles(remainingParticles) == kFALSE) return kFALSE;
    size_t totalParticles = selectedParticles.size();
+   Int_t threads = this->GetRunConfig().Threads();
+   #if ROOT_VERSION_CODE < ROOT_VERSION(5,34,0)
+      if (threads > 1) {
+         // Before 5.34, every navigator shares the same voxel finders, so they cannot be used concurrently
+         Warning("Start","Geometry navigation is not thread-safe before ROOT 5.34. Propagating on a single thread.");
+         threads = 1;
+      }
+   #endif
    cout << "-------------------------------------------" << endl;
    cout << "Starting Simulation of " << this->GetRunConfig().RunName() << endl;
    cout << "Particles to propagate: " << totalParticles << endl;
+   if (firstParticle > 0) cout << "Already propagated: " << firstParticle << endl;
    cout << "RunTime(s): " << this->GetRunConfig().RunTime() << endl;
    cout << "MaxStepTime(s): " << this->GetRunConfig().MaxStepTime() << endl;
    cout << "WallLosses: " << this->GetRunConfig().WallLossesOn() << endl;
+   cout << "Threads: " << threads << endl;
+   cout << "OutputQueueSize: " << this->GetRunConfig().OutputQueueSize() << endl;
    cout << "-------------------------------------------" << endl;
    ///////////////////////////////////////////////////////////////////////
    // Loop over all particles stored in InitialParticles Tree
+   // Each thread propagating counts into statistics of its own, summed at the end
+   RunStatistics statistics;
+   // Any thread besides this one needs ROOT's thread support in place before it starts
+   if (threads > 1 || this->GetRunConfig().OutputQueueSize() > 0) {
+      this->PrepareROOTForThreads();
+   }
+   // Write finished tracks out on a thread of their own, if a queue has been configured for them.
+   // The writer is stopped by its destructor, should propagation throw.
+   boost::scoped_ptr<OutputWriter> writer;
+   if (this->GetRunConfig().OutputQueueSize() > 0) {
+      writer.reset(new OutputWriter(fData, this->GetRunConfig().OutputQueueSize()));
+      writer->Start();
+   }
+   Bool_t propagated = kFALSE;
+   if (threads > 1) {
+      propagated = this->PropagateInParallel(selectedParticles, firstParticle, threads, writer.get(), statistics);
+   } else {
+      RunStatistics::Recording recording(statistics);
+      propagated = this->PropagateInSerial(selectedParticles, firstParticle, *rndGenerator, writer.get());
+   }
+   if (writer) {
+      writer->Stop();
+      writer->PrintStatistics();
+      writer.reset();
+   }
+   if (propagated == kFALSE) return kFALSE;
+   ///////////////////////////////////////////////////////////////////////
+   cout << "-------------------------------------------" << endl;
+   cout << "Propagation Results: " << endl;
+   cout << "Total Particles: " << this->GetData().FinalParticles() << endl;
+   cout << "Number Still Propagating: " << this->GetData().PropagatingParticles() << endl;
+   cout << "Number Detected: " << this->GetData().DetectedParticles() << endl;
+   cout << "Number Absorbed by Boundary: " << this->GetData().AbsorbedParticles() << endl;
+   cout << "Number Decayed: " << this->GetData().DecayedParticles() << endl;
+   cout << "Number Lost To Outer Geometry: " << this->GetData().LostParticles() << endl;
+   cout << "Number With Anomalous Behaviour: " << this->GetData().AnomalousParticles() << endl;
+   statistics.Print();
+   cout << "-------------------------------------------" << endl;
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t Run::PropagateInSerial(const vector<int>& selectedParticles, const size_t firstParticle, TRandomPhilox& rndGenerator, OutputWriter* writer)
+{
+   // -- Propagate each of the selected particles, from 'firstParticle' on, in turn on the
+   // -- current thread. If there is a writer, each track's output is buffered and handed to
+   // -- it, rather than written here.
+   const size_t totalParticles = selectedParticles.size();
+   size_t lastCheckpoint = firstParticle;
+   time_t lastCheckpointTime = time(NULL);
+   Data::ObjectBuffer output;
    vector<int>::const_iterator indexIter;
-   for (indexIter = selectedParticles.begin(); indexIter != selectedParticles.end(); indexIter++) {
+   for (indexIter = selectedParticles.begin() + firstParticle; indexIter != selectedParticles.end(); indexIter++) {
       // Count the number of particles we have propagated so far
       const int particleNumber = indexIter - selectedParticles.begin();
       // Get Particle from list
-      Particle* particle = fData.RetrieveParticle(*indexIter);
+      Particle* particle = NULL;
+      {
+         OutputWriter::FileLock lock(writer);
+         particle = fData.NextParticle();
+      }
       if (particle == NULL) {
          Error("Start","Failed to retrieve particle from Data");
-         return false;
+         return kFALSE;
+      }
+      // Propagate and save the particle's track
+      if (writer != NULL) fData.SetOutputBuffer(&output);
+      const Bool_t propagated = this->PropagateParticle(particle, fData, rndGenerator);
+      fData.SetOutputBuffer(NULL);
+      delete particle;
+      if (writer != NULL) writer->Submit(output);
+      if (propagated == kFALSE) {
+         return kFALSE;
+      }
+      if (this->CheckpointDue(particleNumber + 1, lastCheckpoint, lastCheckpointTime) == kTRUE) {
+         this->SaveCheckpoint(selectedParticles, particleNumber + 1, writer, lastCheckpoint, lastCheckpointTime);
       }
-      // If the particle has stored a previous random generator state, load it
-      const TRandom3State* previousRndState = particle->GetRandomGeneratorState();
-      if (previousRndState != NULL) {rndGenerator->SetState(*previousRndState);}
-      // Hold a copy of the Random Generator's state before particle's propagation
-      TRandom3State initialRndState = rndGenerator->GetState();
-      // Hold a copy of Particle's initial state before propagating
-      Particle initialParticle(*particle);
-      // Register Observers with Particle
-      fData.RegisterObservers(particle);
       ///////////////////////////////////////////////////////////////////////
-      // Attempt to Propagate track
-      try {
-         Bool_t propagated = particle->Propagate(this);
-         if (!propagated) {
-            Error("Start", "Propagation Failed to Begin.");
-            return kFALSE;
+      // Print Progress Bar to Screen
+      #ifndef VERBOSE_MODE
+         Algorithms::ProgressBar::PrintProgress(particleNumber, totalParticles, 2);
+      #endif
+   }
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t Run::PropagateInParallel(const vector<int>& selectedParticles, const size_t firstParticle, const Int_t threads, OutputWriter* writer, RunStatistics& statistics)
+{
+   // -- Hand the selected particles, from 'firstParticle' on, out to a pool of worker threads.
+   // -- Each track's output is written to the data tree in the order the particles were
+   // -- selected, so the output is identical to that of a serial run. The workers' statistics
+   // -- are added to 'statistics'.
+   #if ROOT_VERSION_CODE >= ROOT_VERSION(5,34,0)
+      fExperiment->GetGeoManager()->SetMaxThreads(threads);
+   #endif
+   // Create the shared singletons now, rather than leaving the workers to race to do so
+   Polynomial::Instance();
+   Parabola::Instance();
+   ThreadPool pool(*this, *fExperiment, threads);
+   pool.Start();
+   // Only allow a limited number of tracks to be in flight at once, so that one slow
+   // track cannot leave the rest of the run held in memory waiting to be written
+   const size_t maxTracksInFlight = 16*threads;
+   const size_t totalParticles = selectedParticles.size();
+   size_t submitted = firstParticle;
+   size_t written = firstParticle;
+   size_t lastCheckpoint = firstParticle;
+   time_t lastCheckpointTime = time(NULL);
+   Bool_t success = kTRUE;
+   while (success == kTRUE && written < totalParticles) {
+      // Once a checkpoint is due, let the tracks in flight finish rather than starting more,
+      // so that the workers' observers hold exactly the tracks written at the checkpoint
+      const Bool_t checkpointDue = this->CheckpointDue(written, lastCheckpoint, lastCheckpointTime);
+      // Keep the workers supplied with particles
+      while ((checkpointDue == kFALSE || submitted == written) &&
+             submitted < totalParticles && submitted - written < maxTracksInFlight) {
+         Particle* particle = NULL;
+         {
+            OutputWriter::FileLock lock(writer);
+            particle = fData.NextParticle();
+         }
+         if (particle == NULL) {
+            Error("Start","Failed to retrieve particle from Data");
+            success = kFALSE;
+            break;
          }
-      } catch (...) {
-         // Serious tracking errors (eg: particle cannot be located correctly) will be thrown
-         Error("Start","Particle %i has failed to propagate properly.", particleNumber);
-         // Store the initial random generator's state for this particle
-         initialParticle.SaveRandomGeneratorState(initialRndState);
+         pool.Submit(new TrackJob(submitted, particle));
+         submitted++;
       }
-      ///////////////////////////////////////////////////////////////////////
-      // Add Initial Particle State to data tree
-      fData.SaveInitialParticle(&initialParticle);
-      ///////////////////////////////////////////////////////////////////////
-      // Add Final Particle State to data tree
-      fData.SaveFinalParticle(particle, particle->GetState().GetName());
-      ///////////////////////////////////////////////////////////////////////
-      // Reset the clock
-      Clock::Instance()->Reset();
-      // Reset the observers
-      this->GetData().ResetObservers();
+      if (success == kFALSE) break;
+      // Write out the next track in sequence once its worker has finished with it
+      TrackJob* job = pool.WaitForJob(written);
+      success = job->fPropagated;
+      if (writer != NULL) {
+         writer->Submit(job->fOutput);
+      } else {
+         fData.WriteBufferToTree(job->fOutput);
+      }
+      delete job;
       ///////////////////////////////////////////////////////////////////////
       // Print Progress Bar to Screen
       #ifndef VERBOSE_MODE
-         Algorithms::ProgressBar::PrintProgress(particleNumber, totalParticles, 2);
+         Algorithms::ProgressBar::PrintProgress(written, totalParticles, 2);
       #endif
+      written++;
+      if (success == kTRUE && checkpointDue == kTRUE && written == submitted) {
+         pool.MergeObservers(fData);
+         this->SaveCheckpoint(selectedParticles, written, writer, lastCheckpoint, lastCheckpointTime);
+      }
+   }
+   pool.Stop();
+   // Combine the observers recording over the whole run, and the workers' statistics
+   pool.MergeObservers(fData);
+   pool.MergeStatistics(statistics);
+   return success;
+}
+
+//_____________________________________________________________________________
+void Run::PrepareROOTForThreads() const
+{
+   // -- ROOT only guards its global state (gROOT, gDirectory, the building of class
+   // -- dictionaries and streamer infos) once TThread has been initialised. Build the
+   // -- dictionaries of everything the threads create, clone and stream here, on the main
+   // -- thread, so that the threads never race to build them.
+   TThread::Initialize();
+   const char* classNames[] = {"Particle", "State", "Propagating", "Decayed", "Absorbed",
+                               "Detected", "Lost", "Anomalous", "Spin", "Spinor",
+                               "TRandomPhilox", "Track", "Point", "SpinData", "BounceData",
+                               "FieldData", "PopulationData", "Trajectory"};
+   const size_t numClasses = sizeof(classNames)/sizeof(classNames[0]);
+   for (size_t classNum = 0; classNum < numClasses; classNum++) {
+      TClass* cl = TClass::GetClass(classNames[classNum]);
+      if (cl != NULL) cl->GetStreamerInfo();
+   }
+}
+
+//_____________________________________________________________________________
+Bool_t Run::CheckpointDue(const size_t completed, const size_t lastCheckpoint, const time_t lastCheckpointTime) const
+{
+   // -- Whether enough particles or time have passed since the last checkpoint to save another
+   const int everyParticles = this->GetRunConfig().CheckpointParticles();
+   const double everyMinutes = this->GetRunConfig().CheckpointMinutes();
+   const Bool_t particlesDue = (everyParticles > 0 && completed - lastCheckpoint >= static_cast<size_t>(everyParticles));
+   const Bool_t timeDue = (everyMinutes > 0. && difftime(time(NULL), lastCheckpointTime) >= 60.*everyMinutes);
+   return (particlesDue == kTRUE || timeDue == kTRUE);
+}
+
+//_____________________________________________________________________________
+void Run::SaveCheckpoint(const vector<int>& selectedParticles, const size_t completed, OutputWriter* writer, size_t& lastCheckpoint, time_t& lastCheckpointTime)
+{
+   // -- Save a checkpoint once the first 'completed' selected particles, and no others, have
+   // -- been handed over to be written and recorded by the run's 'PerRun' observers
+   // The checkpoint must describe the output file exactly, so wait for the writer to catch up
+   if (writer != NULL) writer->Flush();
+   {
+      OutputWriter::FileLock lock(writer);
+      const vector<int> completedParticles(selectedParticles.begin(), selectedParticles.begin() + completed);
+      if (fData.Checkpoint(completedParticles) == kFALSE) {
+         Warning("SaveCheckpoint","Failed to save checkpoint after %i particles", static_cast<Int_t>(completed));
+      }
    }
+   lastCheckpoint = completed;
+   lastCheckpointTime = time(NULL);
+}
+
+//_____________________________________________________________________________
+Bool_t Run::PropagateParticle(Particle* particle, Data& data, TRandomPhilox& rndGenerator)
+{
+   // -- Propagate a single particle, saving its initial and final states and any observer data
+   // -- to data. Returns false only if the particle's propagation could not begin at all.
+   // Every particle draws from its own random stream, selected by its Id, so that its random
+   // numbers never depend on which particles were propagated before it, or on which thread.
+   // If the particle has stored a previous position in its stream, start from there.
+   if (particle->HasRandomGeneratorState()) {
+      rndGenerator.SetStream(particle->GetRandomSeed(), particle->Id(), particle->GetRandomDrawIndex());
+   } else {
+      rndGenerator.SetStream(this->GetRunConfig().RandomSeed(), particle->Id());
+   }
+   particle->SetRandomGenerator(&rndGenerator);
+   // Field lookups made for the previous track say nothing about where this one is
+   FieldLookupContext::BeginTrack();
+   // Hold a copy of the Random Generator's position before particle's propagation
+   const UInt_t initialRndSeed = rndGenerator.GetSeed();
+   const ULong64_t initialRndDrawIndex = rndGenerator.GetDrawIndex();
+   // Hold a copy of Particle's initial state before propagating
+   Particle initialParticle(*particle);
+   // Each particle keeps its own time, from the start of its propagation
+   Clock clock(this->GetRunConfig());
+   // Register Observers with Particle
+   data.RegisterObservers(particle, clock);
    ///////////////////////////////////////////////////////////////////////
-   cout << "-------------------------------------------" << endl;
-   cout << "Propagation Results: " << endl;
-   cout << "Total Particles: " << this->GetData().FinalParticles() << endl;
-   cout << "Number Still Propagating: " << this->GetData().PropagatingParticles() << endl;
-   cout << "Number Detected: " << this->GetData().DetectedParticles() << endl;
-   cout << "Number Absorbed by Boundary: " << this->GetData().AbsorbedParticles() << endl;
-   cout << "Number Decayed: " << this->GetData().DecayedParticles() << endl;
-   cout << "Number Lost To Outer Geometry: " << this->GetData().LostParticles() << endl;
-   cout << "Number With Anomalous Behaviour: " << this->GetData().AnomalousParticles() << endl;
-   cout << "-------------------------------------------" << endl;
+   // Attempt to Propagate track
+   try {
+      Bool_t propagated = particle->Propagate(this, clock);
+      if (!propagated) {
+         Error("Start", "Propagation Failed to Begin.");
+         return kFALSE;
+      }
+   } catch (...) {
+      // Serious tracking errors (eg: particle cannot be located correctly) will be thrown
+      Error("Start","Particle %i has failed to propagate properly.", particle->Id());
+      // Store the initial random generator's state for this particle
+      initialParticle.SaveRandomGeneratorState(initialRndSeed, initialRndDrawIndex);
+   }
+   ///////////////////////////////////////////////////////////////////////
+   // Add Initial Particle State to data tree
+   data.SaveInitialParticle(&initialParticle);
+   ///////////////////////////////////////////////////////////////////////
+   // Add Final Particle State to data tree
+   data.SaveFinalParticle(particle, particle->GetState().GetName());
+   ///////////////////////////////////////////////////////////////////////
+   // Reset the observers
+   data.ResetObservers();
    return kTRUE;
 }
 
@@ -146,6 +146,19 @@ void RunConfig::ReadInRunConfig(const ConfigFile& runConfigFile)
    // Option for whether wall losses are turned on
    bool betaDecay = runConfigFile.GetBool(RunParams::betaDecay,"Properties");
    fOptions.insert(OptionPair(RunParams::betaDecay, betaDecay));
+   // Option for whether steps that cannot reach any boundary are extended to the next event
+   bool safetySteps = runConfigFile.GetBool(RunParams::safetySteps,"Properties",false);
+   fOptions.insert(OptionPair(RunParams::safetySteps, safetySteps));
+   // Option for whether analytic fields are sampled onto grids before the run
+   bool bakeFields = runConfigFile.GetBool(RunParams::bakeFields,"Properties",false);
+   fOptions.insert(OptionPair(RunParams::bakeFields, bakeFields));
+   // Parameter to be set; Largest error of a baked field, relative to its largest value
+   double bakeTolerance = runConfigFile.GetFloat(RunParams::bakeTolerance,"Properties",1.0e-4);
+   if (bakeTolerance <= 0.) {throw runtime_error("Invalid BakeTolerance specified in runconfig");}
+   fParams.insert(ParamPair(RunParams::bakeTolerance, bakeTolerance));
+   // Option for whether fields that overlap are summed, rather than the first one found used
+   bool sumOverlappingFields = runConfigFile.GetBool(RunParams::sumOverlappingFields,"Properties",false);
+   fOptions.insert(OptionPair(RunParams::sumOverlappingFields, sumOverlappingFields));
    // Option for whether magnetic field is turned on
    bool magField = runConfigFile.GetBool(RunParams::magField,"Properties");
    fOptions.insert(OptionPair(RunParams::magField, magField));
@@ -164,6 +177,34 @@ void RunConfig::ReadInRunConfig(const ConfigFile& runConfigFile)
    double spinStepTime = runConfigFile.GetFloat(RunParams::spinStepTime,"Properties");
    if (spinStepTime < 0.) {throw runtime_error("Invalid SpinStepTime specified in runconfig");}
    fParams.insert(ParamPair(RunParams::spinStepTime, spinStepTime));
+   // Parameter to be set; Rotation allowed in each spin step from the field turning within it
+   // (radians). If zero, the spin is precessed in fixed steps of SpinStepTime, otherwise
+   // SpinStepTime is the first step tried
+   double spinTolerance = runConfigFile.GetFloat(RunParams::spinTolerance,"Properties",0.0);
+   if (spinTolerance < 0.) {throw runtime_error("Invalid SpinTolerance specified in runconfig");}
+   fParams.insert(ParamPair(RunParams::spinTolerance, spinTolerance));
+   // Parameter to be set; Number of worker threads to propagate particles with
+   int threads = runConfigFile.GetInt(RunParams::threads,"Properties",1);
+   if (threads < 1) {throw runtime_error("Invalid Threads specified in runconfig");}
+   fParams.insert(ParamPair(RunParams::threads, threads));
+   // Parameter to be set; Number of finished tracks that may wait to be written out by a
+   // separate writer thread. If zero, tracks are written out as soon as they finish.
+   int outputQueueSize = runConfigFile.GetInt(RunParams::outputQueueSize,"Properties",0);
+   if (outputQueueSize < 0) {throw runtime_error("Invalid OutputQueueSize specified in runconfig");}
+   fParams.insert(ParamPair(RunParams::outputQueueSize, outputQueueSize));
+   // Parameters to be set; Save the output so far, so that the run can be resumed, after every
+   // CheckpointParticles particles and every CheckpointMinutes minutes. Zero turns either off.
+   int checkpointParticles = runConfigFile.GetInt(RunParams::checkpointParticles,"Properties",0);
+   if (checkpointParticles < 0) {throw runtime_error("Invalid CheckpointParticles specified in runconfig");}
+   fParams.insert(ParamPair(RunParams::checkpointParticles, checkpointParticles));
+   double checkpointMinutes = runConfigFile.GetFloat(RunParams::checkpointMinutes,"Properties",0.0);
+   if (checkpointMinutes < 0.) {throw runtime_error("Invalid CheckpointMinutes specified in runconfig");}
+   fParams.insert(ParamPair(RunParams::checkpointMinutes, checkpointMinutes));
+   // Parameter to be set; Seed of the run's random number streams
+   int randomSeed = runConfigFile.GetInt(RunParams::randomSeed,"Properties",4357);
+   if (randomSeed <= 0) {throw runtime_error("Invalid RandomSeed specified in runconfig");}
+   // (ParamPair stores a float, which cannot hold every seed exactly)
+   fParams.insert(pair<string, double>(RunParams::randomSeed, randomSeed));
    // -----------------------------------
    // -- Observer Options
    // Option for whether to record numbers of Bounces
@@ -198,6 +239,13 @@ void RunConfig::ReadInRunConfig(const ConfigFile& runConfigFile)
    double populationMeasFreq = runConfigFile.GetFloat("PopulationMeasureFrequency(Hz)","Observables");
    double populationMeasInterval = (populationMeasFreq == 0.0 ? 0.0 : (1.0/populationMeasFreq));
    fParams.insert(ParamPair(RunParams::populationMeasFreq, populationMeasInterval));
+   // Option for whether to record each particle's trajectory, for replaying its spin later
+   bool recordTrajectory = runConfigFile.GetBool(RunParams::recordTrajectory,"Observables",false);
+   fOptions.insert(OptionPair(RunParams::recordTrajectory, recordTrajectory));
+   // Option for whether to write each particle's position, velocity, spin and state to plain
+   // columns of the data tree, alongside the particle itself
+   bool columnarOutput = runConfigFile.GetBool(RunParams::columnarOutput,"Observables",false);
+   fOptions.insert(OptionPair(RunParams::columnarOutput, columnarOutput));
    
    // -----------------------------------
    // -- Selected Particle IDs
@@ -327,8 +375,16 @@ string RunConfig::InputFileName() const
 //__________________________________________________________________________
 string RunConfig::OutputFileName() const
 {
+   // -- Each shard of a run writes to its own file, named after the shard
    map<string, string>::const_iterator it = fNames.find(RunParams::outputFile);
-   return (it == fNames.end()) ? "" : FolderPath() + it->second;
+   if (it == fNames.end()) return "";
+   string outputFileName = it->second;
+   if (IsSharded() == true) {
+      const size_t extension = outputFileName.rfind('.');
+      const size_t insertAt = (extension == string::npos ? outputFileName.size() : extension);
+      outputFileName.insert(insertAt, ShardName());
+   }
+   return FolderPath() + outputFileName;
 }
 
 //__________________________________________________________________________
@@ -380,6 +436,13 @@ double RunConfig::SpinStepTime() const
    return (it == fParams.end()) ? 0. : it->second;
 }
 
+//__________________________________________________________________________
+double RunConfig::SpinTolerance() const
+{
+   map<string, double>::const_iterator it = fParams.find(RunParams::spinTolerance);
+   return (it == fParams.end()) ? 0.0 : it->second;
+}
+
 //__________________________________________________________________________
 bool RunConfig::GravFieldOn() const
 {
@@ -415,6 +478,34 @@ bool RunConfig::BetaDecayOn() const
    return (it == fOptions.end()) ? true : it->second;
 }
 
+//__________________________________________________________________________
+bool RunConfig::SafetyStepsOn() const
+{
+   map<string, bool>::const_iterator it = fOptions.find(RunParams::safetySteps);
+   return (it == fOptions.end()) ? false : it->second;
+}
+
+//__________________________________________________________________________
+bool RunConfig::BakeFieldsOn() const
+{
+   map<string, bool>::const_iterator it = fOptions.find(RunParams::bakeFields);
+   return (it == fOptions.end()) ? false : it->second;
+}
+
+//__________________________________________________________________________
+double RunConfig::BakeTolerance() const
+{
+   map<string, double>::const_iterator it = fParams.find(RunParams::bakeTolerance);
+   return (it == fParams.end()) ? 1.0e-4 : it->second;
+}
+
+//__________________________________________________________________________
+bool RunConfig::SumOverlappingFields() const
+{
+   map<string, bool>::const_iterator it = fOptions.find(RunParams::sumOverlappingFields);
+   return (it == fOptions.end()) ? false : it->second;
+}
+
 //__________________________________________________________________________
 bool RunConfig::ObserveSpin() const
 {
@@ -450,6 +541,20 @@ bool RunConfig::ObservePopulation() const
    return (it == fOptions.end()) ? false : it->second;
 }
 
+//__________________________________________________________________________
+bool RunConfig::ObserveTrajectory() const
+{
+   map<string, bool>::const_iterator it = fOptions.find(RunParams::recordTrajectory);
+   return (it == fOptions.end()) ? false : it->second;
+}
+
+//__________________________________________________________________________
+bool RunConfig::ColumnarOutput() const
+{
+   map<string, bool>::const_iterator it = fOptions.find(RunParams::columnarOutput);
+   return (it == fOptions.end()) ? false : it->second;
+}
+
 //__________________________________________________________________________
 double RunConfig::TrackMeasureInterval() const
 {
@@ -478,6 +583,41 @@ double RunConfig::PopulationMeasureInterval() const
    return (it == fParams.end()) ? 0. : it->second;
 }
 
+//__________________________________________________________________________
+int RunConfig::Threads() const
+{
+   map<string, double>::const_iterator it = fParams.find(RunParams::threads);
+   return (it == fParams.end()) ? 1 : static_cast<int>(it->second);
+}
+
+//__________________________________________________________________________
+int RunConfig::OutputQueueSize() const
+{
+   map<string, double>::const_iterator it = fParams.find(RunParams::outputQueueSize);
+   return (it == fParams.end()) ? 0 : static_cast<int>(it->second);
+}
+
+//__________________________________________________________________________
+int RunConfig::CheckpointParticles() const
+{
+   map<string, double>::const_iterator it = fParams.find(RunParams::checkpointParticles);
+   return (it == fParams.end()) ? 0 : static_cast<int>(it->second);
+}
+
+//__________________________________________________________________________
+double RunConfig::CheckpointMinutes() const
+{
+   map<string, double>::const_iterator it = fParams.find(RunParams::checkpointMinutes);
+   return (it == fParams.end()) ? 0. : it->second;
+}
+
+//__________________________________________________________________________
+unsigned int RunConfig::RandomSeed() const
+{
+   map<string, double>::const_iterator it = fParams.find(RunParams::randomSeed);
+   return (it == fParams.end()) ? 4357 : static_cast<unsigned int>(it->second);
+}
+
 //__________________________________________________________________________
 void RunConfig::Print(Option_t* /*option*/) const
 {
@@ -497,3 +637,84 @@ void RunConfig::Print(Option_t* /*option*/) const
    }
    cout << "-------------------------------------------" << endl;
 }
+
+//__________________________________________________________________________
+void RunConfig::SelectShard(const int shard, const int shards)
+{
+   // -- Propagate only the 'shard'th of 'shards' equal, consecutive blocks of the selected
+   // -- particles, counting from 1
+   if (shards < 1 || shard < 1 || shard > shards) {throw runtime_error("Invalid shard specified");}
+   ClearShard();
+   fParams[RunParams::shard] = shard;
+   fParams[RunParams::shards] = shards;
+}
+
+//__________________________________________________________________________
+void RunConfig::SelectParticleRange(const int first, const int last)
+{
+   // -- Propagate only the selected particles at positions first to last-1 of the listing
+   if (first < 0 || last <= first) {throw runtime_error("Invalid particle range specified");}
+   ClearShard();
+   fParams[RunParams::firstParticle] = first;
+   fParams[RunParams::lastParticle] = last;
+}
+
+//__________________________________________________________________________
+void RunConfig::ClearShard()
+{
+   // -- Propagate all the selected particles
+   fParams.erase(RunParams::shard);
+   fParams.erase(RunParams::shards);
+   fParams.erase(RunParams::firstParticle);
+   fParams.erase(RunParams::lastParticle);
+}
+
+//__________________________________________________________________________
+bool RunConfig::IsSharded() const
+{
+   return (fParams.find(RunParams::shards) != fParams.end() ||
+           fParams.find(RunParams::lastParticle) != fParams.end());
+}
+
+//__________________________________________________________________________
+bool RunConfig::ShardRange(const size_t totalParticles, size_t& first, size_t& last) const
+{
+   // -- Find the positions, first to last-1, of the shard's particles among 'totalParticles'
+   // -- selected. Returns false if the run is not sharded.
+   first = 0;
+   last = totalParticles;
+   map<string, double>::const_iterator shardIt = fParams.find(RunParams::shard);
+   map<string, double>::const_iterator shardsIt = fParams.find(RunParams::shards);
+   if (shardIt != fParams.end() && shardsIt != fParams.end()) {
+      const size_t shard = static_cast<size_t>(shardIt->second);
+      const size_t shards = static_cast<size_t>(shardsIt->second);
+      first = (totalParticles*(shard - 1))/shards;
+      last = (totalParticles*shard)/shards;
+      return true;
+   }
+   map<string, double>::const_iterator firstIt = fParams.find(RunParams::firstParticle);
+   map<string, double>::const_iterator lastIt = fParams.find(RunParams::lastParticle);
+   if (firstIt != fParams.end() && lastIt != fParams.end()) {
+      first = std::min(static_cast<size_t>(firstIt->second), totalParticles);
+      last = std::min(static_cast<size_t>(lastIt->second), totalParticles);
+      return true;
+   }
+   return false;
+}
+
+//__________________________________________________________________________
+string RunConfig::ShardName() const
+{
+   // -- Suffix identifying the shard, eg: '_shard3of8' or '_particles1000-1999'
+   ostringstream name;
+   map<string, double>::const_iterator shardIt = fParams.find(RunParams::shard);
+   map<string, double>::const_iterator shardsIt = fParams.find(RunParams::shards);
+   map<string, double>::const_iterator firstIt = fParams.find(RunParams::firstParticle);
+   map<string, double>::const_iterator lastIt = fParams.find(RunParams::lastParticle);
+   if (shardIt != fParams.end() && shardsIt != fParams.end()) {
+      name << "_shard" << static_cast<int>(shardIt->second) << "of" << static_cast<int>(shardsIt->second);
+   } else if (firstIt != fParams.end() && lastIt != fParams.end()) {
+      name << "_particles" << static_cast<int>(firstIt->second) << "-" << static_cast<int>(lastIt->second) - 1;
+   }
+   return name.str();
+}
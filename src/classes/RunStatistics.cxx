@@ -0,0 +1,87 @@
+#include <iostream>
+
+#include <boost/thread/tss.hpp>
+
+#include "RunStatistics.h"
+
+using namespace std;
+
+namespace {
+   // Each thread's current statistics belong to whoever is propagating on it, so are never deleted here
+   void KeepStatistics(RunStatistics*) {}
+   boost::thread_specific_ptr<RunStatistics> gCurrentStatistics(&KeepStatistics);
+}
+
+//______________________________________________________________________________
+RunStatistics::Recording::Recording(RunStatistics& statistics)
+                         :fPrevious(RunStatistics::Current())
+{
+   // -- Constructor
+   RunStatistics::SetCurrent(&statistics);
+}
+
+//______________________________________________________________________________
+RunStatistics::Recording::~Recording()
+{
+   // -- Destructor. Hand the thread back to whatever it was recording into before
+   RunStatistics::SetCurrent(fPrevious);
+}
+
+//______________________________________________________________________________
+RunStatistics::RunStatistics()
+{
+   // -- Constructor
+   this->Reset();
+}
+
+//______________________________________________________________________________
+void RunStatistics::Reset()
+{
+   // -- Zero every count, ready for a new run
+   fShapesTested = 0;
+   fShapesCulled = 0;
+   fFieldLookups = 0;
+   fFieldMisses = 0;
+   fMapLookups = 0;
+   fMapRepeatHits = 0;
+   fMapHintHits = 0;
+}
+
+//______________________________________________________________________________
+void RunStatistics::Add(const RunStatistics& other)
+{
+   // -- Add the counts of another thread
+   fShapesTested += other.fShapesTested;
+   fShapesCulled += other.fShapesCulled;
+   fFieldLookups += other.fFieldLookups;
+   fFieldMisses += other.fFieldMisses;
+   fMapLookups += other.fMapLookups;
+   fMapRepeatHits += other.fMapRepeatHits;
+   fMapHintHits += other.fMapHintHits;
+}
+
+//______________________________________________________________________________
+void RunStatistics::Print() const
+{
+   // -- Print the counts, leaving out those of lookups the run never made
+   cout << "Shape Solves Skipped As Out Of Reach: " << fShapesCulled << " of " << fShapesTested << endl;
+   if (fFieldMisses > 0) {
+      cout << "Field Lookups Outside Every Field: " << fFieldMisses << " of " << fFieldLookups << endl;
+   }
+   if (fMapLookups > 0) {
+      cout << "Field Map Lookups: " << fMapLookups << "\t Repeated Point: " << fMapRepeatHits;
+      cout << "\t Answered From Previous Leaf/Cell: " << fMapHintHits << endl;
+   }
+}
+
+//______________________________________________________________________________
+RunStatistics* RunStatistics::Current()
+{
+   return gCurrentStatistics.get();
+}
+
+//______________________________________________________________________________
+void RunStatistics::SetCurrent(RunStatistics* statistics)
+{
+   gCurrentStatistics.reset(statistics);
+}
@@ -69,6 +69,13 @@ Bool_t Spin::Precess(const TVector3& avgMagField, const Double_t precessTime)
    return kTRUE;
 }
 
+//_____________________________________________________________________________
+Bool_t Spin::Rotate(const TVector3& angle)
+{
+   // -- Precess through the rotation vector 'angle' (radians), as accumulated over a step
+   return fSpinor.Rotate(angle);
+}
+
 //_____________________________________________________________________________
 void Spin::Print(Option_t* /*option*/) const
 {
@@ -220,12 +227,33 @@ Bool_t Spinor::Precess(const TVector3& avgMagField, const Double_t precessTime)
    // If no field exists, no precession is made
    if (Precision::IsEqual(omega, 0.0)) return kFALSE;
    
-   const Double_t precessAngle = (omega*precessTime)/2.0;
-   const Double_t costheta = TMath::Cos(precessAngle);
-   const Double_t sintheta = TMath::Sin(precessAngle);
-   const Double_t omX = omegaX/omega;
-   const Double_t omY = omegaY/omega;
-   const Double_t omZ = omegaZ/omega;
+   this->Rotate(TVector3(omegaX*precessTime, omegaY*precessTime, omegaZ*precessTime));
+   
+   #ifdef VERBOSE
+      cout << "Precess Time: " << precessTime << endl;
+      cout << "Mag Field - Bx: " << avgMagField.X() << "\t";
+      cout << "By: " << avgMagField.Y() << "\t Bz: " << avgMagField.Z() << endl;
+      cout << "Omega - X: " << omegaX << "\t";
+      cout << "Y: " << omegaY << "\t Z: " << omegaZ << "\t Mag: " << omega << endl;
+      this->Print();
+      cout << "-----------------------------------------------" << endl;
+   #endif
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t Spinor::Rotate(const TVector3& angle)
+{
+   // -- Rotate the spinor about the axis of 'angle' by its magnitude, as precession through
+   // -- that angle would
+   const Double_t angleMag = angle.Mag();
+   if (Precision::IsEqual(angleMag, 0.0)) return kFALSE;
+   
+   const Double_t costheta = TMath::Cos(angleMag/2.0);
+   const Double_t sintheta = TMath::Sin(angleMag/2.0);
+   const Double_t omX = angle.X()/angleMag;
+   const Double_t omY = angle.Y()/angleMag;
+   const Double_t omZ = angle.Z()/angleMag;
    
    // Spin Up Real Part
    const Double_t newUpRe = fUpRe*costheta + ((fUpIm*omZ + fDownIm*omX) - fDownRe*omY)*sintheta;
@@ -244,17 +272,7 @@ Bool_t Spinor::Precess(const TVector3& avgMagField, const Double_t precessTime)
    fDownIm = newDownIm;
    
    #ifdef VERBOSE
-      cout << "Precess Time: " << precessTime << endl;
-      cout << "Mag Field - Bx: " << avgMagField.X() << "\t";
-      cout << "By: " << avgMagField.Y() << "\t Bz: " << avgMagField.Z() << endl;
-      cout << "Omega - X: " << omegaX << "\t";
-      cout << "Y: " << omegaY << "\t Z: " << omegaZ << "\t Mag: " << omega << endl;
-      cout << "Precess Angle: " << precessAngle << endl;
-      this->Print();
-      cout << "-----------------------------------------------" << endl;
-   #endif
-   
-   #ifdef VERBOSE
+      cout << "Rotation Angle: " << angleMag << endl;
       cout << "costheta: " << costheta << endl;
       cout << "sintheta: " << sintheta << endl;
       cout << "omX: " << omX << endl;
@@ -262,10 +280,6 @@ Bool_t Spinor::Precess(const TVector3& avgMagField, const Double_t precessTime)
       cout << "omZ: " << omZ << endl;
       cout << "-----------------------------------------------" << endl;
    #endif
-   
-   this->CalculateProbSpinUp(TVector3(1.,0.,0.));
-   this->CalculateProbSpinUp(TVector3(0.,1.,0.));
-   this->CalculateProbSpinUp(TVector3(0.,0.,1.));
    return kTRUE;
 }
 
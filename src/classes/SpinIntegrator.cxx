@@ -0,0 +1,64 @@
+// SpinIntegrator class
+#include <algorithm>
+
+#include "Constants.h"
+
+#include "SpinIntegrator.h"
+#include "Spin.h"
+
+#include "TMath.h"
+
+using namespace std;
+
+namespace {
+   // Gauss-Legendre points either side of the centre of a step, as a fraction of the step
+   const Double_t kGaussOffset = 0.5/TMath::Sqrt(3.0);
+   const Double_t kCommutatorFactor = TMath::Sqrt(3.0)/12.0;
+   // Shortest step taken, whatever the error estimate (s)
+   const Double_t kMinStep = 1.0E-9;
+   // Step size controller: safety factor, and the limits on the change from one step to the next
+   const Double_t kSafety = 0.9;
+   const Double_t kMaxGrowth = 5.0;
+   const Double_t kMaxShrink = 0.2;
+}
+
+//______________________________________________________________________________
+SpinIntegrator::SpinIntegrator(const Double_t tolerance)
+               :fTolerance(tolerance),
+                fEvaluations(0),
+                fSteps(0),
+                fRejections(0)
+{
+   // -- Constructor
+}
+
+//______________________________________________________________________________
+Double_t SpinIntegrator::Step(Spin& spin, FieldSource& source, const Double_t time,
+                              const Double_t maxInterval, Double_t& trialStep)
+{
+   // -- Precess the spin through one step starting at 'time', no longer than 'maxInterval',
+   // -- and return the length of the step taken. 'trialStep' holds the step to try first
+   // -- (the full interval if it is not positive), and is updated with the step the commutator
+   // -- term suggests for next time. The commutator term scales as the cube of the step.
+   Double_t interval = (trialStep > 0. ? min(trialStep, maxInterval) : maxInterval);
+   Bool_t truncated = (trialStep > maxInterval);
+   for (;;) {
+      const TVector3 omega1 = Neutron::gyromag_ratio*source.GetField(time + (0.5 - kGaussOffset)*interval);
+      const TVector3 omega2 = Neutron::gyromag_ratio*source.GetField(time + (0.5 + kGaussOffset)*interval);
+      fEvaluations += 2;
+      const TVector3 commutator = (kCommutatorFactor*interval*interval)*omega2.Cross(omega1);
+      const Double_t error = commutator.Mag();
+      const Double_t scale = (error > 0. ? kSafety*TMath::Power(fTolerance/error, 1.0/3.0) : kMaxGrowth);
+      if (error <= fTolerance || interval <= kMinStep) {
+         spin.Rotate((0.5*interval)*(omega1 + omega2) + commutator);
+         fSteps++;
+         const Double_t nextStep = interval*min(scale, kMaxGrowth);
+         // A step cut short by the end of the interval says nothing against the step tried
+         trialStep = (truncated == kTRUE ? max(trialStep, nextStep) : nextStep);
+         return interval;
+      }
+      fRejections++;
+      truncated = kFALSE;
+      interval = max(interval*max(scale, kMaxShrink), kMinStep);
+   }
+}
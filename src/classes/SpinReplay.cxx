@@ -0,0 +1,98 @@
+// SpinReplay class
+
+#include <iostream>
+#include <cassert>
+
+#include "SpinReplay.h"
+#include "MagFieldArray.h"
+#include "ElecFieldArray.h"
+#include "Trajectory.h"
+#include "Point.h"
+#include "Spin.h"
+#include "SpinData.h"
+
+#include "TMath.h"
+
+using namespace std;
+
+//#define VERBOSE_MODE
+
+//______________________________________________________________________________
+SpinReplay::SpinReplay(const vector<const MagFieldArray*>& magFields, const vector<const ElecFieldArray*>& elecFields,
+                       const Double_t spinStepTime, const Double_t measureInterval)
+           :fMagFields(magFields),
+            fElecFields(elecFields),
+            fSpinStepTime(spinStepTime),
+            fMeasureInterval(measureInterval),
+            fBatch(static_cast<Int_t>(magFields.size())),
+            fFieldX(magFields.size()),
+            fFieldY(magFields.size()),
+            fFieldZ(magFields.size())
+{
+   // -- Constructor. Configuration i is made of magFields[i] and elecFields[i].
+   assert(fSpinStepTime > 0.);
+   assert(fMagFields.size() == fElecFields.size());
+}
+
+//______________________________________________________________________________
+Bool_t SpinReplay::Replay(const Trajectory& trajectory, const Spin& initialSpin, vector<SpinData*>& results)
+{
+   // -- Precess the spin along the trajectory in every field configuration. Times in the
+   // -- results are measured from the start of the trajectory, as the SpinObserver's are.
+   if (results.size() != fMagFields.size()) {
+      ::Error("SpinReplay::Replay", "Expected results for %i configurations", this->Configurations());
+      return kFALSE;
+   }
+   if (trajectory.Segments() == 0) return kFALSE;
+   const Int_t configurations = this->Configurations();
+   for (Int_t i = 0; i < configurations; i++) {fBatch.Load(i, initialSpin);}
+   const Double_t startTime = trajectory.StartTime();
+   const Double_t endTime = trajectory.EndTime();
+   this->Measure(0., results);
+   // Count measurements, rather than adding up intervals, so that their times do not drift
+   Int_t measurements = 0;
+   Double_t nextMeasTime = (fMeasureInterval > 0. ? startTime + fMeasureInterval : endTime);
+   Double_t time = startTime;
+   Int_t segment = 0;
+   TVector3 position, velocity;
+   while (time < endTime) {
+      // End the step at the next bounce or measurement, if one comes first
+      Double_t stepEnd = TMath::Min(time + fSpinStepTime, trajectory.SegmentEnd(segment));
+      stepEnd = TMath::Min(stepEnd, TMath::Min(nextMeasTime, endTime));
+      const Double_t halfwayTime = 0.5*(time + stepEnd);
+      trajectory.GetState(halfwayTime, segment, position, velocity);
+      const Point halfwayPoint(position, halfwayTime);
+      for (Int_t i = 0; i < configurations; i++) {
+         TVector3 field(0.,0.,0.);
+         if (fMagFields[i] != NULL) field += fMagFields[i]->GetMagField(halfwayPoint, velocity);
+         if (fElecFields[i] != NULL) field += fElecFields[i]->GetMagField(halfwayPoint, velocity);
+         fFieldX[i] = field.X();
+         fFieldY[i] = field.Y();
+         fFieldZ[i] = field.Z();
+      }
+      fBatch.Precess(&fFieldX[0], &fFieldY[0], &fFieldZ[0], stepEnd - time);
+      time = stepEnd;
+      segment = trajectory.FindSegment(time, segment);
+      if (fMeasureInterval > 0. && time >= nextMeasTime) {
+         measurements++;
+         this->Measure(measurements*fMeasureInterval, results);
+         nextMeasTime = startTime + (measurements + 1)*fMeasureInterval;
+      }
+   }
+   #ifdef VERBOSE_MODE
+      cout << "Replayed " << trajectory.Segments() << " segments from " << startTime;
+      cout << " to " << endTime << " s, with " << measurements << " measurements" << endl;
+   #endif
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+void SpinReplay::Measure(const Double_t time, vector<SpinData*>& results) const
+{
+   // -- Add a copy of each configuration's current spin to its results
+   for (Int_t i = 0; i < this->Configurations(); i++) {
+      Spin* spin = new Spin();
+      fBatch.Store(i, *spin);
+      results[i]->insert(pair<const Double_t, const Spin*>(time, spin));
+   }
+}
@@ -0,0 +1,161 @@
+// SpinorBatch class
+#include <cmath>
+
+#include "Constants.h"
+
+#include "SpinorBatch.h"
+#include "Spin.h"
+
+using namespace std;
+
+namespace {
+   // Cody-Waite split of pi/2, so that subtracting multiples of it stays exact
+   const Double_t kPiOver2A = 1.57079625129699707031E+0;
+   const Double_t kPiOver2B = 7.54978941586159635336E-8;
+   const Double_t kPiOver2C = 5.39030285815811905290E-15;
+   const Double_t kTwoOverPi = 6.36619772367581343076E-1;
+   
+   //______________________________________________________________________________
+   inline void SinCos(const Double_t x, Double_t& sinx, Double_t& cosx)
+   {
+      // -- sin and cos of x, to within an ulp or two for |x| up to ~1E8, written without branches
+      // -- or calls so that a loop calling it can be vectorised. Reduce x to r in [-pi/4, pi/4]
+      // -- about the nearest multiple j of pi/2, then evaluate the minimax polynomials
+      // -- (from Cephes) for sin and cos of r and pick the pair for the quadrant of j.
+      const Double_t j = floor(x*kTwoOverPi + 0.5);
+      const Double_t r = ((x - j*kPiOver2A) - j*kPiOver2B) - j*kPiOver2C;
+      const Double_t z = r*r;
+      const Double_t sinr = r + r*z*((((((1.58962301576546568060E-10*z - 2.50507477628578072866E-8)*z
+                                 + 2.75573136213857245213E-6)*z - 1.98412698295895385996E-4)*z
+                                 + 8.33333333332211858878E-3)*z - 1.66666666666666307295E-1));
+      const Double_t cosr = 1.0 - 0.5*z + z*z*((((((-1.13585365213876817300E-11*z + 2.08757008419747316778E-9)*z
+                                 - 2.75573141792967388112E-7)*z + 2.48015872888517045348E-5)*z
+                                 - 1.38888888888730564116E-3)*z + 4.16666666666665929218E-2));
+      const Double_t quadrant = j - 4.0*floor(0.25*j);
+      const Double_t swap = (quadrant == 1.0 || quadrant == 3.0) ? 1.0 : 0.0;
+      const Double_t sinSign = (quadrant >= 2.0) ? -1.0 : 1.0;
+      const Double_t cosSign = (quadrant == 1.0 || quadrant == 2.0) ? -1.0 : 1.0;
+      sinx = sinSign*(swap*cosr + (1.0 - swap)*sinr);
+      cosx = cosSign*(swap*sinr + (1.0 - swap)*cosr);
+   }
+   
+   // -- Time each spinor precesses for, from an array or common to all
+   struct TimeArray {
+      const Double_t* fTimes;
+      Double_t operator[](const Int_t i) const {return fTimes[i];}
+   };
+   struct CommonTime {
+      Double_t fTime;
+      Double_t operator[](const Int_t /*i*/) const {return fTime;}
+   };
+   
+   //______________________________________________________________________________
+   template <class Times>
+   void PrecessKernel(const Int_t size, Double_t* upRe, Double_t* upIm, Double_t* downRe,
+                      Double_t* downIm, const Double_t* fieldX, const Double_t* fieldY,
+                      const Double_t* fieldZ, const Times& times)
+   {
+      // -- The rotation of Spinor::Rotate applied to every spinor. A spinor in no field has a
+      // -- zero axis and angle, and so is left unchanged without a test. The arrays never
+      // -- overlap, which the compiler cannot check for itself with this many of them.
+      #pragma GCC ivdep
+      for (Int_t i = 0; i < size; i++) {
+         const Double_t omegaX = Neutron::gyromag_ratio*fieldX[i];
+         const Double_t omegaY = Neutron::gyromag_ratio*fieldY[i];
+         const Double_t omegaZ = Neutron::gyromag_ratio*fieldZ[i];
+         const Double_t omega = sqrt(omegaX*omegaX + omegaY*omegaY + omegaZ*omegaZ);
+         const Double_t invOmega = (omega > 0. ? 1.0/omega : 0.);
+         const Double_t omX = omegaX*invOmega;
+         const Double_t omY = omegaY*invOmega;
+         const Double_t omZ = omegaZ*invOmega;
+         Double_t sintheta, costheta;
+         SinCos(0.5*omega*times[i], sintheta, costheta);
+         const Double_t oldUpRe = upRe[i], oldUpIm = upIm[i];
+         const Double_t oldDownRe = downRe[i], oldDownIm = downIm[i];
+         upRe[i] = oldUpRe*costheta + ((oldUpIm*omZ + oldDownIm*omX) - oldDownRe*omY)*sintheta;
+         upIm[i] = oldUpIm*costheta - (oldDownRe*omX + oldUpRe*omZ + oldDownIm*omY)*sintheta;
+         downRe[i] = oldDownRe*costheta + ((oldUpIm*omX + oldUpRe*omY) - oldDownIm*omZ)*sintheta;
+         downIm[i] = oldDownIm*costheta + ((oldDownRe*omZ + oldUpIm*omY) - oldUpRe*omX)*sintheta;
+      }
+   }
+}
+
+//______________________________________________________________________________
+SpinorBatch::SpinorBatch(const Int_t size)
+            :fUpRe(size, 0.), fUpIm(size, 0.), fDownRe(size, 0.), fDownIm(size, 0.)
+{
+   // -- Constructor
+}
+
+//______________________________________________________________________________
+void SpinorBatch::Resize(const Int_t size)
+{
+   // -- Change the number of spinors held. New spinors are zero.
+   fUpRe.resize(size, 0.);
+   fUpIm.resize(size, 0.);
+   fDownRe.resize(size, 0.);
+   fDownIm.resize(size, 0.);
+}
+
+//______________________________________________________________________________
+void SpinorBatch::Load(const Int_t index, const Spinor& spinor)
+{
+   // -- Copy the spinor into position 'index'
+   fUpRe[index] = spinor.fUpRe;
+   fUpIm[index] = spinor.fUpIm;
+   fDownRe[index] = spinor.fDownRe;
+   fDownIm[index] = spinor.fDownIm;
+}
+
+//______________________________________________________________________________
+void SpinorBatch::Load(const Int_t index, const Spin& spin)
+{
+   // -- Copy the spin's spinor into position 'index'
+   this->Load(index, spin.fSpinor);
+}
+
+//______________________________________________________________________________
+void SpinorBatch::Store(const Int_t index, Spinor& spinor) const
+{
+   // -- Copy the spinor at position 'index' back out
+   spinor.fUpRe = fUpRe[index];
+   spinor.fUpIm = fUpIm[index];
+   spinor.fDownRe = fDownRe[index];
+   spinor.fDownIm = fDownIm[index];
+}
+
+//______________________________________________________________________________
+void SpinorBatch::Store(const Int_t index, Spin& spin) const
+{
+   // -- Copy the spinor at position 'index' back into the spin
+   this->Store(index, spin.fSpinor);
+}
+
+//______________________________________________________________________________
+void SpinorBatch::Precess(const Double_t* fieldX, const Double_t* fieldY, const Double_t* fieldZ,
+                          const Double_t* precessTime)
+{
+   // -- Precess each spinor about its own field, for its own time
+   if (fUpRe.empty()) return;
+   const TimeArray times = {precessTime};
+   PrecessKernel(this->Size(), &fUpRe[0], &fUpIm[0], &fDownRe[0], &fDownIm[0], fieldX, fieldY, fieldZ, times);
+}
+
+//______________________________________________________________________________
+void SpinorBatch::Precess(const Double_t* fieldX, const Double_t* fieldY, const Double_t* fieldZ,
+                          const Double_t precessTime)
+{
+   // -- Precess each spinor about its own field, all for the same time
+   if (fUpRe.empty()) return;
+   const CommonTime times = {precessTime};
+   PrecessKernel(this->Size(), &fUpRe[0], &fUpIm[0], &fDownRe[0], &fDownIm[0], fieldX, fieldY, fieldZ, times);
+}
+
+//______________________________________________________________________________
+Double_t SpinorBatch::CalculateProbSpinUp(const Int_t index, const TVector3& axis) const
+{
+   // -- Probability of spinor 'index' being spin 'up' along the axis
+   Spinor spinor;
+   this->Store(index, spinor);
+   return spinor.CalculateProbSpinUp(axis);
+}
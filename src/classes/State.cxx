@@ -11,6 +11,9 @@
 #include "TRandom.h"
 
 #include "Run.h"
+#include "Experiment.h"
+#include "VolumeTree.h"
+#include "VolumeGravity.h"
 #include "RunConfig.h"
 #include "Volume.h"
 #include "FieldManager.h"
@@ -90,7 +93,7 @@ void State::ChangeState(Particle* particle, State* newState)
 }
 
 //_____________________________________________________________________________
-Bool_t State::Propagate(Particle* /*particle*/, Run* /*run*/)
+Bool_t State::Propagate(Particle* /*particle*/, Run* /*run*/, Clock& /*clock*/)
 {
    // Default behaviour - don't propagate
    return kFALSE;
@@ -145,7 +148,9 @@ Propagating::Propagating()
                 :State(),
                  fIsStepEntering(kFALSE),
                  fIsStepExiting(kFALSE),
-                 fIsOnBoundary(kFALSE)
+                 fIsOnBoundary(kFALSE),
+                 fCandidates(),
+                 fInitialCursor()
 {
    // Constructor
 //   Info("Propagating","Constructor");
@@ -156,7 +161,9 @@ Propagating::Propagating(const Propagating& s)
                 :State(s),
                  fIsStepEntering(s.fIsStepEntering),
                  fIsStepExiting(s.fIsStepExiting),
-                 fIsOnBoundary(s.fIsOnBoundary)
+                 fIsOnBoundary(s.fIsOnBoundary),
+                 fCandidates(),
+                 fInitialCursor()
 {
    // Copy Constructor
 //   Info("Propagating","Copy Constructor");
@@ -190,7 +197,7 @@ Propagating* Propagating::Clone() const
 }
 
 //_____________________________________________________________________________
-Bool_t Propagating::Propagate(Particle* particle, Run* run)
+Bool_t Propagating::Propagate(Particle* particle, Run* run, Clock& clock)
 {
    // -- Propagate particle through geometry until it is either stopped by some decay process
    // -- or the runTime defined int he RunConfig has been reached
@@ -219,11 +226,11 @@ Bool_t Propagating::Propagate(Particle* particle, Run* run)
          cout << "-------------------------------------------------------" << endl;
       #endif
       // Check clock for time to the next event. Set this as the maximum step time
-      Double_t stepTime = Clock::Instance()->GetTimeToNextEvent();
+      Double_t stepTime = clock.GetTimeToNextEvent();
       // -- Check if run has ended
       if (stepTime == 0.0) break;
       // -- Make a step
-      if (this->MakeStep(stepTime, particle, run) == kFALSE) {
+      if (this->MakeStep(stepTime, particle, run, clock) == kFALSE) {
          // -- Particle has reached a final state (decay,detected)
          break; // -- End Propagation Loop
       }
@@ -233,7 +240,7 @@ Bool_t Propagating::Propagate(Particle* particle, Run* run)
 }
 
 //_____________________________________________________________________________
-Bool_t Propagating::MakeStep(Double_t stepTime, Particle* particle, Run* run)
+Bool_t Propagating::MakeStep(Double_t stepTime, Particle* particle, Run* run, Clock& clock)
 {
    // -- Find time to reach next boundary and step along parabola
    
@@ -245,21 +252,19 @@ Bool_t Propagating::MakeStep(Double_t stepTime, Particle* particle, Run* run)
       
    // -- Store the initial particle's position
    const TVector3 initialPosition(particle->X(), particle->Y(), particle->Z());
-   // -- Save initial node and its name
-   const TGeoNode* initialNode = navigator->GetCurrentNode();
-   const string initialVolumeName = initialNode->GetVolume()->GetName();
-   // -- Save Initial node's matrix
-   TGeoHMatrix initMatrix = *(navigator->GetCurrentMatrix()); // Copy the initial matrix here
-   const TGeoMatrix* initialMatrix = &initMatrix; // Hold pointer to the stored matrix
-   // -- Save Path to current node - we will want to return to this in the event we make a bounce
-   const char* initialPath = navigator->GetPath();
+   // -- Save initial node, its matrix, and its place in the geometry tree - we will want to
+   // -- return to it in the event we make a bounce. Nothing is copied if we have not left the
+   // -- node since the last step.
+   fInitialCursor.Save(navigator);
+   const TGeoNode* initialNode = fInitialCursor.GetNode();
+   const TGeoMatrix* initialMatrix = fInitialCursor.GetMatrix();
    #ifdef VERBOSE_MODE
       cout << "------------------- START OF STEP ----------------------" << endl;
       particle->Print(); // Print state
       cout << "Steptime (s): " << stepTime << endl;
       cout << "-----------------------------" << endl;
       cout << "Navigator's Initial Node: " << initialNode->GetName() << endl;
-      cout << "Initial Node PATH: " << initialPath << endl;
+      cout << "Initial Node PATH: " << navigator->GetPath() << endl;
       cout << "Initial Matrix: " << endl;
       initialMatrix->Print();
       cout << "Is On Boundary?  " << fIsOnBoundary << endl;
@@ -290,17 +295,28 @@ Bool_t Propagating::MakeStep(Double_t stepTime, Particle* particle, Run* run)
       stepTime = timeTravelled;
    } else {
       // CASE 2; Grav Field present - tracking along parabolic trajectories
-      // -- Propagate Point by StepTime along Parabola
-      TGeoNode* nextNode = this->ParabolicBoundaryFinder(stepTime, *particle, navigator, crossedNode, gravField);
-      if (nextNode == NULL) {
-         #ifdef VERBOSE_MODE
-            Error("MakeStep", "MakeStep has failed to find the next node");
-         #endif
-         this->IsAnomalous(particle);;
-         throw runtime_error("Failed to find next node");
+      // -- If no boundary can be reached within the step, there is nothing to solve for. The
+      // -- step is then free to run on to the next event, even beyond the maximum step time.
+      Double_t freeFlightTime = 0.;
+      if (run->GetRunConfig().SafetyStepsOn() == true) {
+         freeFlightTime = this->FreeFlightTime(*particle, navigator, gravField);
+      }
+      if (freeFlightTime >= stepTime) {
+         stepTime = clock.GetTimeToNextEventWithin(freeFlightTime);
+         this->FreeFlight(stepTime, *particle, navigator, gravField);
+      } else {
+         // -- Propagate Point by StepTime along Parabola
+         TGeoNode* nextNode = this->ParabolicBoundaryFinder(stepTime, *particle, navigator, crossedNode, gravField, run->GetExperiment());
+         if (nextNode == NULL) {
+            #ifdef VERBOSE_MODE
+               Error("MakeStep", "MakeStep has failed to find the next node");
+            #endif
+            this->IsAnomalous(particle);;
+            throw runtime_error("Failed to find next node");
+         }
+         // Assert that the returned node is also the current node
+         assert(nextNode == navigator->GetCurrentNode());
       }
-      // Assert that the returned node is also the current node
-      assert(nextNode == navigator->GetCurrentNode());
    }
    
    // -- We should now have propagated our point by some stepsize and be inside the correct volume 
@@ -328,7 +344,7 @@ Bool_t Propagating::MakeStep(Double_t stepTime, Particle* particle, Run* run)
    // -- Move Particle to next position.
    // -- Along the way, if a MagField is present, precess the spin
    ///////////////////////////////////////////////////////////////////////////////////////
-   particle->Move(stepTime, run);
+   particle->Move(stepTime, run, clock);
    #ifdef VERBOSE_MODE	
       cout << "------------------- AFTER STEP ----------------------" << endl;
       particle->Print(); // Print verbose
@@ -377,12 +393,12 @@ Bool_t Propagating::MakeStep(Double_t stepTime, Particle* particle, Run* run)
    }
    // -- Interact with Boundary
    Volume* currentVolume = static_cast<Volume*>(navigator->GetCurrentVolume());
-   if (currentVolume->Interact(particle, normal, navigator, crossedNode, initialPath, run->GetRunConfig()) == kFALSE) {
+   if (currentVolume->Interact(particle, normal, navigator, crossedNode, fInitialCursor, run->GetRunConfig(), clock) == kFALSE) {
       // Particle reached a final state
       return kFALSE;
    }
    // -- Notify observers
-   particle->NotifyObservers(particle->GetPoint(), particle->GetVelocity(), Context::Population);
+   particle->NotifyObservers(particle->GetPoint(), particle->GetVelocity(), Context::Population, clock);
    // End of MakeStep.
    return kTRUE;
 }
@@ -402,7 +418,55 @@ Double_t Propagating::DetermineNextStepTime(const Particle& particle, const RunC
 }
 
 //_____________________________________________________________________________
-TGeoNode* Propagating::ParabolicBoundaryFinder(Double_t& stepTime, const Particle& particle, TGeoNavigator* navigator, TGeoNode* crossedNode, const GravField* const field)
+Double_t Propagating::FreeFlightTime(const Particle& particle, TGeoNavigator* navigator, const GravField* const field)
+{
+   // -- Longest time for which the particle is certain not to reach any boundary of the current
+   // -- volume or of its daughters. The safety distance is the radius of a sphere about the point
+   // -- that no boundary enters, and in a time t the parabola can get no further from its start
+   // -- than |v|t + |g|t^2/2.
+   const Double_t safety = navigator->Safety() - TGeoShape::Tolerance();
+   if (safety <= 0.) return 0.;
+   const Double_t v = particle.V();
+   const Double_t g = TMath::Sqrt(field->Gx()*field->Gx() + field->Gy()*field->Gy() + field->Gz()*field->Gz());
+   // Positive root of g*t^2/2 + v*t - safety = 0, in a form that doesn't suffer cancellation
+   const Double_t denominator = v + TMath::Sqrt(v*v + 2.*g*safety);
+   if (denominator <= 0.) return TGeoShape::Big();
+   const Double_t freeFlightTime = 2.*safety/denominator;
+   #ifdef VERBOSE_MODE
+      cout << "Safety: " << safety << "\t" << "Free Flight Time: " << freeFlightTime << endl;
+   #endif
+   return freeFlightTime;
+}
+
+//_____________________________________________________________________________
+void Propagating::FreeFlight(const Double_t stepTime, const Particle& particle, TGeoNavigator* navigator, const GravField* const field)
+{
+   // -- Move the navigator's point along the parabola by a step that is known to stay inside the
+   // -- current node, without looking for any boundaries
+   fIsStepExiting  = kFALSE;
+   fIsStepEntering = kFALSE;
+   fIsOnBoundary   = kFALSE;
+   const Double_t globalField[3] = {field->Gx(), field->Gy(), field->Gz()};
+   Double_t point[3]    = {particle.X(), particle.Y(), particle.Z()};
+   Double_t velocity[3] = {particle.Vx(), particle.Vy(), particle.Vz()};
+   navigator->SetStep(Parabola::Instance()->ArcLength(velocity, globalField, stepTime));
+   for (Int_t i = 0; i < 3; i++) {
+      point[i] += velocity[i]*stepTime + 0.5*globalField[i]*stepTime*stepTime;
+      velocity[i] += globalField[i]*stepTime;
+   }
+   const Double_t velocityMag = TMath::Sqrt(velocity[0]*velocity[0] + velocity[1]*velocity[1] + velocity[2]*velocity[2]);
+   assert(velocityMag != 0.);
+   Double_t dir[3];
+   for (Int_t i = 0; i < 3; i++) dir[i] = velocity[i]/velocityMag;
+   navigator->SetCurrentPoint(point);
+   navigator->SetCurrentDirection(dir);
+   #ifdef VERBOSE_MODE
+      cout << "Free flight for Step Time: " << stepTime << " within " << navigator->GetCurrentNode()->GetName() << endl;
+   #endif
+}
+
+//_____________________________________________________________________________
+TGeoNode* Propagating::ParabolicBoundaryFinder(Double_t& stepTime, const Particle& particle, TGeoNavigator* navigator, TGeoNode* crossedNode, const GravField* const field, const Experiment& experiment)
 {
 // Compute distance to next boundary within STEPMAX. If no boundary is found,
 // propagate current point along current direction with fStep=STEPMAX. Otherwise
@@ -459,10 +523,18 @@ TGeoNode* Propagating::ParabolicBoundaryFinder(Double_t& stepTime, const Particl
    // -- distance to boundary of current node.
    // *********************************************************************
    Double_t localPoint[3], localVelocity[3], localField[3]; // Containers for the local coords
+   TGeoVolume *vol = navigator->GetCurrentNode()->GetVolume();
    navigator->GetCurrentMatrix()->MasterToLocal(currentPoint, &localPoint[0]);
    navigator->GetCurrentMatrix()->MasterToLocalVect(currentVelocity, &localVelocity[0]);
-   navigator->GetCurrentMatrix()->MasterToLocalVect(currentField, &localField[0]);
-   TGeoVolume *vol = navigator->GetCurrentNode()->GetVolume();
+   // -- Gravity in the local frame is found once for each volume, unless the volume is placed
+   // -- in frames of different orientations
+   const VolumeGravity* volumeGravity = experiment.GetVolumeGravity(vol);
+   if (volumeGravity != NULL) {
+      const Double_t* volumeField = volumeGravity->GetField();
+      for (Int_t i = 0; i < 3; i++) localField[i] = volumeField[i];
+   } else {
+      navigator->GetCurrentMatrix()->MasterToLocalVect(currentField, &localField[0]);
+   }
    
    // -- Find distance to exiting current node
    #ifdef VERBOSE_MODE
@@ -530,7 +602,7 @@ TGeoNode* Propagating::ParabolicBoundaryFinder(Double_t& stepTime, const Particl
       cout << "Check daughter volumes of " << crossedNode->GetName() << " to see if there are any further intersection" << endl;
    #endif
    Int_t daughterIndex = -1;
-   TGeoNode *crossed = this->ParabolicDaughterBoundaryFinder(stepTime, navigator, localPoint, localVelocity, localField, daughterIndex, kTRUE);
+   TGeoNode *crossed = this->ParabolicDaughterBoundaryFinder(stepTime, navigator, localPoint, localVelocity, localField, experiment.GetVolumeTree(vol), volumeGravity, daughterIndex, kTRUE);
    if (crossed) {
       #ifdef VERBOSE_MODE
          cout << "Particle will intersect " << crossed->GetName() << " volume first." << endl;
@@ -633,11 +705,13 @@ TGeoNode* Propagating::ParabolicBoundaryFinder(Double_t& stepTime, const Particl
 }
 
 //_____________________________________________________________________________
-TGeoNode* Propagating::ParabolicDaughterBoundaryFinder(Double_t& stepTime, TGeoNavigator* navigator, Double_t* point, Double_t* velocity, Double_t* field, Int_t &daughterIndex, Bool_t compmatrix)
+TGeoNode* Propagating::ParabolicDaughterBoundaryFinder(Double_t& stepTime, TGeoNavigator* navigator, Double_t* point, Double_t* velocity, Double_t* field, const VolumeTree* daughterTree, const VolumeGravity* daughterGravity, Int_t &daughterIndex, Bool_t compmatrix)
 {
 // Computes as fStep the distance to next daughter of the current volume. 
 // The point and direction must be converted in the coordinate system of the current volume.
-// The proposed step limit is fStep.
+// The proposed step limit is fStep. If the volume has a daughterTree, only those daughters
+// whose bounding boxes meet the bounding box of the step's arc are considered. If the volume
+// has its daughterGravity, the field in each daughter's frame is taken from it.
    
    // -- First Get the current local and global fields
    Double_t motherField[3] = {field[0], field[1], field[2]}; 
@@ -666,22 +740,41 @@ TGeoNode* Propagating::ParabolicDaughterBoundaryFinder(Double_t& stepTime, TGeoN
    #endif
    if (numberOfDaughters == 0) return 0;  // No daughter 
    
+   // ************************************************************************************
+   // Find the daughters that the step could reach. The arc only ever gets shorter as
+   // closer daughters are found, so its initial bounding box covers the whole search.
+   // ************************************************************************************
+   if (daughterTree != NULL) {
+      Double_t arcLower[3], arcUpper[3];
+      Parabola::Instance()->BoundingBox(motherPoint, motherVelocity, motherField, stepTime, arcLower, arcUpper);
+      daughterTree->FindCandidates(arcLower, arcUpper, fCandidates);
+   } else {
+      fCandidates.clear();
+      for (Int_t i = 0; i < numberOfDaughters; i++) fCandidates.push_back(i);
+   }
+   #ifdef VERBOSE_MODE
+      cout << "Candidate Daughters: " << fCandidates.size() << endl;
+   #endif
+   
    Double_t localPoint[3], localVelocity[3], localField[3];
    TGeoNode *current = 0;
    Int_t i=0;
    // ************************************************************************************
-   // Calculate distance to all daughters of current volume
+   // Calculate distance to all candidate daughters of current volume
    // If any daughters will be reached within current step, return the closest of these
    // ************************************************************************************
-   #ifdef VERBOSE_MODE
-      cout << "Only Few daughters. Calculate distance from outside to all." << endl;
-   #endif
-   for (i=0; i<numberOfDaughters; i++) {
+   for (std::vector<Int_t>::const_iterator candidate = fCandidates.begin(); candidate != fCandidates.end(); ++candidate) {
+      i = *candidate;
       current = vol->GetNode(i);
       current->cd();
       current->MasterToLocal(motherPoint, localPoint);
       current->MasterToLocalVect(motherVelocity, localVelocity);
-      current->MasterToLocalVect(motherField, localField);
+      if (daughterGravity != NULL) {
+         const Double_t* daughterField = daughterGravity->GetDaughterField(i);
+         for (Int_t j = 0; j < 3; j++) localField[j] = daughterField[j];
+      } else {
+         current->MasterToLocalVect(motherField, localField);
+      }
       if (current->IsOverlapping() && current->GetVolume()->Contains(localPoint)) continue;
       tnext = static_cast<Box*>(current->GetVolume()->GetShape())->TimeFromOutside(localPoint, localVelocity, localField, stepTime, fIsOnBoundary);
       if (tnext <= 0.0) {
@@ -0,0 +1,121 @@
+// TRandomPhilox class
+#include <cassert>
+
+#include "TRandomPhilox.h"
+
+ClassImp(TRandomPhilox);
+
+namespace {
+   // Multipliers and Weyl sequence constants of Philox4x32, from Salmon et al.
+   const UInt_t kPhiloxM0 = 0xD2511F53;
+   const UInt_t kPhiloxM1 = 0xCD9E8D57;
+   const UInt_t kPhiloxW0 = 0x9E3779B9;
+   const UInt_t kPhiloxW1 = 0xBB67AE85;
+   const Int_t  kPhiloxRounds = 10;
+}
+
+//______________________________________________________________________________
+TRandomPhilox::TRandomPhilox(UInt_t seed, UInt_t stream)
+{
+   // -- Constructor. Position the generator at the start of the given stream
+   SetName("RandomPhilox");
+   SetTitle("Random number generator: Philox4x32-10");
+   this->SetStream(seed, stream, 0);
+}
+
+//______________________________________________________________________________
+TRandomPhilox::~TRandomPhilox()
+{
+   // -- Destructor
+}
+
+//______________________________________________________________________________
+void TRandomPhilox::Philox4x32(const UInt_t* counter, const UInt_t* key, UInt_t* output)
+{
+   // -- Encrypt the 128 bit counter with the 64 bit key, writing four 32 bit numbers to output
+   UInt_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+   UInt_t k0 = key[0], k1 = key[1];
+   for (Int_t round = 0; round < kPhiloxRounds; round++) {
+      const ULong64_t product0 = static_cast<ULong64_t>(kPhiloxM0) * c0;
+      const ULong64_t product1 = static_cast<ULong64_t>(kPhiloxM1) * c2;
+      const UInt_t hi0 = static_cast<UInt_t>(product0 >> 32);
+      const UInt_t lo0 = static_cast<UInt_t>(product0);
+      const UInt_t hi1 = static_cast<UInt_t>(product1 >> 32);
+      const UInt_t lo1 = static_cast<UInt_t>(product1);
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = lo0;
+      k0 += kPhiloxW0;
+      k1 += kPhiloxW1;
+   }
+   output[0] = c0; output[1] = c1; output[2] = c2; output[3] = c3;
+}
+
+//______________________________________________________________________________
+void TRandomPhilox::GenerateBlock()
+{
+   // -- Fill the block with the next four numbers of the stream
+   const UInt_t counter[4] = {static_cast<UInt_t>(fCounter), static_cast<UInt_t>(fCounter >> 32), 0, 0};
+   Philox4x32(counter, fKey, fBlock);
+   fCounter++;
+   fBlockPos = 0;
+}
+
+//______________________________________________________________________________
+UInt_t TRandomPhilox::NextInteger()
+{
+   // -- Return the next 32 bit number of the stream
+   if (fBlockPos >= 4) this->GenerateBlock();
+   return fBlock[fBlockPos++];
+}
+
+//______________________________________________________________________________
+Double_t TRandomPhilox::Rndm(Int_t)
+{
+   // -- Produces uniformly-distributed floating points in ]0,1], as TRandom3 does
+   UInt_t y = this->NextInteger();
+   while (y == 0) {y = this->NextInteger();}
+   return ( (Double_t) y * 2.3283064365386963e-10); // * Power(2,-32)
+}
+
+//______________________________________________________________________________
+void TRandomPhilox::RndmArray(Int_t n, Float_t *array)
+{
+   // -- Return an array of n random numbers uniformly distributed in ]0,1]
+   for(Int_t i=0; i<n; i++) array[i]=(Float_t)Rndm();
+}
+
+//______________________________________________________________________________
+void TRandomPhilox::RndmArray(Int_t n, Double_t *array)
+{
+   // -- Return an array of n random numbers uniformly distributed in ]0,1]
+   for(Int_t i=0; i<n; i++) array[i]=Rndm();
+}
+
+//______________________________________________________________________________
+void TRandomPhilox::SetSeed(UInt_t seed)
+{
+   // -- Change the seed, keeping the current stream, and return to the start of the stream
+   this->SetStream(seed, fKey[1], 0);
+}
+
+//______________________________________________________________________________
+void TRandomPhilox::SetStream(UInt_t seed, UInt_t stream, ULong64_t drawIndex)
+{
+   // -- Position the generator at the number 'drawIndex' of the stream keyed by (seed, stream)
+   TRandom::SetSeed(seed);
+   fKey[0] = seed;
+   fKey[1] = stream;
+   this->SetDrawIndex(drawIndex);
+}
+
+//______________________________________________________________________________
+void TRandomPhilox::SetDrawIndex(ULong64_t drawIndex)
+{
+   // -- Jump directly to any point in the current stream
+   fCounter = drawIndex / 4;
+   this->GenerateBlock();
+   fBlockPos = static_cast<Int_t>(drawIndex % 4);
+   assert(this->GetDrawIndex() == drawIndex);
+}
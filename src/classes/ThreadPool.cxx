@@ -0,0 +1,213 @@
+// ThreadPool class
+#include <iostream>
+#include <cassert>
+
+#include <boost/bind.hpp>
+
+#include "ThreadPool.h"
+#include "Run.h"
+#include "Experiment.h"
+#include "Particle.h"
+#include "TRandomPhilox.h"
+
+using namespace std;
+
+//#define VERBOSE_MODE
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    TrackJob                                                             //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+//______________________________________________________________________________
+TrackJob::TrackJob(size_t sequence, Particle* particle)
+         :fSequence(sequence),
+          fParticle(particle),
+          fPropagated(false),
+          fOutput()
+{
+   // -- Constructor
+}
+
+//______________________________________________________________________________
+TrackJob::~TrackJob()
+{
+   // -- Destructor. Delete anything in the output buffer that was never written out
+   if (fParticle) delete fParticle;
+   Data::ObjectBuffer::iterator entryIter;
+   for (entryIter = fOutput.begin(); entryIter != fOutput.end(); ++entryIter) {
+      delete entryIter->fObject;
+   }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//                                                                         //
+//    ThreadPool                                                           //
+//                                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+//______________________________________________________________________________
+ThreadPool::ThreadPool(Run& run, Experiment& experiment, const int numThreads)
+           :fRun(run),
+            fExperiment(experiment),
+            fNumThreads(numThreads),
+            fThreads(),
+            fMutex(),
+            fJobAvailable(),
+            fJobCompleted(),
+            fPendingJobs(),
+            fCompletedJobs(),
+            fWorkerData(),
+            fWorkerStatistics(),
+            fStopping(false)
+{
+   // -- Constructor
+   for (int workerId = 0; workerId < fNumThreads; workerId++) {
+      fWorkerData.push_back(new Data());
+      fWorkerStatistics.push_back(new RunStatistics());
+   }
+}
+
+//______________________________________________________________________________
+ThreadPool::~ThreadPool()
+{
+   // -- Destructor
+   this->Stop();
+   vector<Data*>::iterator dataIter;
+   for (dataIter = fWorkerData.begin(); dataIter != fWorkerData.end(); ++dataIter) {
+      delete *dataIter;
+   }
+   fWorkerData.clear();
+   vector<RunStatistics*>::iterator statisticsIter;
+   for (statisticsIter = fWorkerStatistics.begin(); statisticsIter != fWorkerStatistics.end(); ++statisticsIter) {
+      delete *statisticsIter;
+   }
+   fWorkerStatistics.clear();
+}
+
+//______________________________________________________________________________
+void ThreadPool::Start()
+{
+   // -- Launch the worker threads
+   #ifdef VERBOSE_MODE
+      cout << "Starting " << fNumThreads << " worker threads" << endl;
+   #endif
+   for (int workerId = 0; workerId < fNumThreads; workerId++) {
+      fThreads.create_thread(boost::bind(&ThreadPool::WorkerLoop, this, workerId));
+   }
+}
+
+//______________________________________________________________________________
+void ThreadPool::Submit(TrackJob* job)
+{
+   // -- Queue a particle to be propagated by the next free worker
+   {
+      boost::mutex::scoped_lock lock(fMutex);
+      fPendingJobs.push_back(job);
+   }
+   fJobAvailable.notify_one();
+}
+
+//______________________________________________________________________________
+TrackJob* ThreadPool::WaitForJob(const size_t sequence)
+{
+   // -- Block until the job submitted at position 'sequence' has been completed, and
+   // -- hand it back to the caller, who then owns it
+   boost::mutex::scoped_lock lock(fMutex);
+   map<size_t, TrackJob*>::iterator jobIter;
+   while ((jobIter = fCompletedJobs.find(sequence)) == fCompletedJobs.end()) {
+      fJobCompleted.wait(lock);
+   }
+   TrackJob* job = jobIter->second;
+   fCompletedJobs.erase(jobIter);
+   return job;
+}
+
+//______________________________________________________________________________
+void ThreadPool::Stop()
+{
+   // -- Stop the workers once they have finished their current track, and discard any
+   // -- jobs that have not been collected
+   {
+      boost::mutex::scoped_lock lock(fMutex);
+      fStopping = true;
+   }
+   fJobAvailable.notify_all();
+   fThreads.join_all();
+   while (fPendingJobs.empty() == false) {
+      delete fPendingJobs.front();
+      fPendingJobs.pop_front();
+   }
+   map<size_t, TrackJob*>::iterator jobIter;
+   for (jobIter = fCompletedJobs.begin(); jobIter != fCompletedJobs.end(); ++jobIter) {
+      delete jobIter->second;
+   }
+   fCompletedJobs.clear();
+}
+
+//______________________________________________________________________________
+void ThreadPool::MergeObservers(Data& data)
+{
+   // -- Move the data of each worker's 'PerRun' observers into those of the provided Data.
+   // -- Only call while no tracks are in flight.
+   vector<Data*>::iterator dataIter;
+   for (dataIter = fWorkerData.begin(); dataIter != fWorkerData.end(); ++dataIter) {
+      data.MergeObservers(**dataIter);
+      (*dataIter)->ResetRunObservers();
+   }
+}
+
+//______________________________________________________________________________
+void ThreadPool::MergeStatistics(RunStatistics& statistics)
+{
+   // -- Add each worker's statistics to those provided, and zero the worker's.
+   // -- Only call while no tracks are in flight.
+   vector<RunStatistics*>::iterator statisticsIter;
+   for (statisticsIter = fWorkerStatistics.begin(); statisticsIter != fWorkerStatistics.end(); ++statisticsIter) {
+      statistics.Add(**statisticsIter);
+      (*statisticsIter)->Reset();
+   }
+}
+
+//______________________________________________________________________________
+void ThreadPool::WorkerLoop(const int workerId)
+{
+   // -- Body of each worker thread. Take particles from the queue and propagate them,
+   // -- buffering their output, until the pool is stopped.
+   Data& data = *(fWorkerData[workerId]);
+   RunStatistics::Recording recording(*(fWorkerStatistics[workerId]));
+   TRandomPhilox rndGenerator(fRun.GetRunConfig().RandomSeed());
+   {
+      // The geometry and fields are shared between the workers, so set up each
+      // worker's navigator and observers one at a time
+      boost::mutex::scoped_lock lock(fMutex);
+      fExperiment.GetGeoManager()->AddNavigator();
+      data.CreateObservers(fRun.GetRunConfig(), fExperiment);
+   }
+   for (;;) {
+      // Wait for the next particle
+      TrackJob* job = NULL;
+      {
+         boost::mutex::scoped_lock lock(fMutex);
+         while (fPendingJobs.empty() && fStopping == false) {
+            fJobAvailable.wait(lock);
+         }
+         if (fStopping == true) break;
+         job = fPendingJobs.front();
+         fPendingJobs.pop_front();
+      }
+      #ifdef VERBOSE_MODE
+         cout << "Worker " << workerId << " propagating track " << job->fSequence << endl;
+      #endif
+      // Propagate the particle, holding on to its output until it can be written in order
+      data.SetOutputBuffer(&job->fOutput);
+      job->fPropagated = fRun.PropagateParticle(job->fParticle, data, rndGenerator);
+      data.SetOutputBuffer(NULL);
+      {
+         boost::mutex::scoped_lock lock(fMutex);
+         fCompletedJobs.insert(pair<size_t, TrackJob*>(job->fSequence, job));
+      }
+      fJobCompleted.notify_all();
+   }
+}
@@ -0,0 +1,147 @@
+// Trajectory
+
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+
+#include "Trajectory.h"
+#include "Point.h"
+
+//#define PRINT_CONSTRUCTORS
+
+using namespace std;
+
+ClassImp(Trajectory)
+
+//_____________________________________________________________________________
+Trajectory::Trajectory()
+           :TObject(),
+            fT(), fX(), fY(), fZ(), fVx(), fVy(), fVz(),
+            fEndTime(0.), fGx(0.), fGy(0.), fGz(0.)
+{
+// -- Default constructor
+   #ifdef PRINT_CONSTRUCTORS
+      Info("Trajectory", "Default Constructor");
+   #endif
+}
+
+//_____________________________________________________________________________
+Trajectory::Trajectory(const TVector3& gravity)
+           :TObject(),
+            fT(), fX(), fY(), fZ(), fVx(), fVy(), fVz(),
+            fEndTime(0.), fGx(gravity.X()), fGy(gravity.Y()), fGz(gravity.Z())
+{
+// -- Constructor
+   #ifdef PRINT_CONSTRUCTORS
+      Info("Trajectory", "Constructor");
+   #endif
+}
+
+//_____________________________________________________________________________
+Trajectory::Trajectory(const Trajectory& other)
+           :TObject(other),
+            fT(other.fT), fX(other.fX), fY(other.fY), fZ(other.fZ),
+            fVx(other.fVx), fVy(other.fVy), fVz(other.fVz),
+            fEndTime(other.fEndTime), fGx(other.fGx), fGy(other.fGy), fGz(other.fGz)
+{
+// -- Copy Constructor
+   #ifdef PRINT_CONSTRUCTORS
+      Info("Trajectory", "Copy Constructor");
+   #endif
+}
+
+//_____________________________________________________________________________
+Trajectory& Trajectory::operator=(const Trajectory& other)
+{
+// --assignment operator
+   if(this!=&other) {
+      TObject::operator=(other);
+      fT = other.fT;
+      fX = other.fX;
+      fY = other.fY;
+      fZ = other.fZ;
+      fVx = other.fVx;
+      fVy = other.fVy;
+      fVz = other.fVz;
+      fEndTime = other.fEndTime;
+      fGx = other.fGx;
+      fGy = other.fGy;
+      fGz = other.fGz;
+   }
+   return *this;
+}
+
+//______________________________________________________________________________
+Trajectory::~Trajectory()
+{
+// -- Destructor
+   #ifdef PRINT_CONSTRUCTORS
+      Info("Trajectory", "Destructor");
+   #endif
+}
+
+//______________________________________________________________________________
+void Trajectory::AddSegment(const Point& point, const TVector3& velocity)
+{
+   // -- Begin a new segment of free fall at 'point', with 'velocity'. Segments must be
+   // -- added in the order they occur.
+   assert(fT.empty() || point.T() >= fT.back());
+   fT.push_back(point.T());
+   fX.push_back(point.X());
+   fY.push_back(point.Y());
+   fZ.push_back(point.Z());
+   fVx.push_back(velocity.X());
+   fVy.push_back(velocity.Y());
+   fVz.push_back(velocity.Z());
+   fEndTime = point.T();
+}
+
+//______________________________________________________________________________
+void Trajectory::Clear(Option_t* /*option*/)
+{
+   // -- Remove every segment, keeping the gravitational field
+   fT.clear();
+   fX.clear();
+   fY.clear();
+   fZ.clear();
+   fVx.clear();
+   fVy.clear();
+   fVz.clear();
+   fEndTime = 0.;
+}
+
+//______________________________________________________________________________
+Double_t Trajectory::SegmentEnd(const Int_t segment) const
+{
+   // -- Time at which the segment ends, either at the next bounce or at the end of the track
+   return (segment + 1 < this->Segments() ? fT[segment + 1] : fEndTime);
+}
+
+//______________________________________________________________________________
+Int_t Trajectory::FindSegment(const Double_t time, const Int_t hint) const
+{
+   // -- Index of the last segment to begin at or before 'time'. Replays move forward in time,
+   // -- so first try the segment 'hint' and those just after it, before a binary search.
+   if (fT.empty()) return -1;
+   const Int_t segments = this->Segments();
+   if (hint >= 0 && hint < segments && fT[hint] <= time) {
+      Int_t segment = hint;
+      for (Int_t steps = 0; steps < 4 && segment + 1 < segments && fT[segment + 1] <= time; steps++) {
+         segment++;
+      }
+      if (segment + 1 == segments || fT[segment + 1] > time) return segment;
+   }
+   const Int_t segment = static_cast<Int_t>(upper_bound(fT.begin(), fT.end(), time) - fT.begin()) - 1;
+   return max(segment, 0);
+}
+
+//______________________________________________________________________________
+void Trajectory::GetState(const Double_t time, const Int_t segment, TVector3& position, TVector3& velocity) const
+{
+   // -- Position and velocity at 'time', falling freely from the beginning of 'segment'
+   const Double_t dt = time - fT[segment];
+   position.SetXYZ(fX[segment] + fVx[segment]*dt + 0.5*fGx*dt*dt,
+                   fY[segment] + fVy[segment]*dt + 0.5*fGy*dt*dt,
+                   fZ[segment] + fVz[segment]*dt + 0.5*fGz*dt*dt);
+   velocity.SetXYZ(fVx[segment] + fGx*dt, fVy[segment] + fGy*dt, fVz[segment] + fGz*dt);
+}
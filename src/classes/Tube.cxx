@@ -180,14 +180,11 @@ Double_t Tube::TimeFromOutside(const Double_t* point, const Double_t* velocity,
 	#ifdef VERBOSE_MODE
 		cout << "-----------------------------" << endl;
 	   cout << "-- " << this->GetName() << " -- Starting Tube::TimeFromOutside -- " << endl;
-		cout << "Checking if Bounding box is within maximum step distance..." << endl;
+		cout << "Checking if tube can be reached within maximum step time..." << endl;
 	#endif
-	// Check if the bounding box is crossed within the requested distance
-   Double_t tBox = Box::TimeFromOutsideS(point, velocity, field, fDX, fDY, fDZ, fOrigin, onBoundary);
-   #ifdef VERBOSE_MODE
-		cout << "Time to Boundary Box: " << tBox << endl;
-	#endif
-	if (tBox > stepTime + TGeoShape::Tolerance()) return TGeoShape::Big();
+	// Check if the bounding box, and then the curved surfaces, can be crossed within the step
+	if (Box::ReachesBoxS(point, velocity, field, fDX, fDY, fDZ, fOrigin, stepTime) == kFALSE) return TGeoShape::Big();
+	if (Tube::ReachesRadiusS(point, velocity, field, fRmin, fRmax, stepTime) == kFALSE) return TGeoShape::Big();
    // find time to shape
 	return TimeFromOutsideS(point, velocity, field, fRmin, fRmax, fDz, onBoundary);
 }
@@ -289,6 +286,38 @@ Double_t Tube::TimeFromOutsideS(const Double_t* point, const Double_t* velocity,
 	}
 }
 
+//_____________________________________________________________________________
+Bool_t Tube::ReachesRadiusS(const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t rmin, const Double_t rmax, const Double_t stepTime)
+{
+	// Quick test of whether the tube can be reached from outside within stepTime. A point lying
+	// radially beyond rmax (or inside rmin) has to cross that cylinder before the end of the step
+	// to reach the tube, which is settled by the sign of the quartic for the radius, without
+	// solving it. Points at either end of the tube are left to the bounding box test.
+	const Double_t rCurrent = TMath::Sqrt(point[0]*point[0] + point[1]*point[1]);
+	Double_t rBoundary = 0.;
+	if (rCurrent > rmax + 10.*TGeoShape::Tolerance()) {
+		rBoundary = rmax;
+	} else if (rmin > 0. && rCurrent < rmin - 10.*TGeoShape::Tolerance()) {
+		rBoundary = rmin;
+	} else {
+		return kTRUE;
+	}
+	// Same quartic as in OutsideTimeToRBoundary
+	Double_t params[5];
+	params[0] = 0.25*(field[0]*field[0] + field[1]*field[1]);
+	params[1] = velocity[0]*field[0] + velocity[1]*field[1];
+	params[2] = point[0]*field[0] + point[1]*field[1] + velocity[0]*velocity[0] + velocity[1]*velocity[1];
+	params[3] = 2.0*(point[0]*velocity[0] + point[1]*velocity[1]);
+	params[4] = point[0]*point[0] + point[1]*point[1] - rBoundary*rBoundary;
+	if (Polynomial::Instance()->HasRootInInterval(params, 4, 0., stepTime) == kFALSE) {
+		#ifdef VERBOSE_MODE
+			cout << "R boundary " << rBoundary << " cannot be reached within step time: " << stepTime << endl;
+		#endif
+		return kFALSE;
+	}
+	return kTRUE;
+}
+
 //_____________________________________________________________________________
 Bool_t Tube::IsNextPointOnTube(const Double_t* point, const Double_t* velocity, const Double_t* field, const Double_t radius, const Double_t dz, const Double_t t)
 {
@@ -99,7 +99,7 @@ Double_t Volume::LossFactor() const
 }
 
 //_____________________________________________________________________________
-Bool_t Volume::Interact(Particle* /*particle*/, const Double_t* /*normal*/, TGeoNavigator* /*navigator*/, TGeoNode* /*crossedNode*/, const char* /*initialPath*/, const RunConfig& /*runconfig*/)
+Bool_t Volume::Interact(Particle* /*particle*/, const Double_t* /*normal*/, TGeoNavigator* /*navigator*/, TGeoNode* /*crossedNode*/, const NavigationCursor& /*initialCursor*/, const RunConfig& /*runconfig*/, const Clock& /*clock*/)
 {
    // Default, no interaction
    return kTRUE;
@@ -164,7 +164,7 @@ TrackingVolume::~TrackingVolume()
 }
 
 //_____________________________________________________________________________
-Bool_t TrackingVolume::Interact(Particle* /*particle*/, const Double_t* /*normal*/, TGeoNavigator* /*navigator*/, TGeoNode* /*crossedNode*/, const char* /*initialPath*/, const RunConfig& /*runconfig*/)
+Bool_t TrackingVolume::Interact(Particle* /*particle*/, const Double_t* /*normal*/, TGeoNavigator* /*navigator*/, TGeoNode* /*crossedNode*/, const NavigationCursor& /*initialCursor*/, const RunConfig& /*runconfig*/, const Clock& /*clock*/)
 {
    // Default, no interaction
    return kTRUE;
@@ -233,7 +233,7 @@ Boundary::~Boundary()
 }
 
 //_____________________________________________________________________________
-Bool_t Boundary::Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const char* initialPath, const RunConfig& runConfig)
+Bool_t Boundary::Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const NavigationCursor& initialCursor, const RunConfig& runConfig, const Clock& clock)
 {
 // -- Interaction of particle with the boundary material
    // -- Is Track on the surface of a boundary?
@@ -256,7 +256,7 @@ Bool_t Boundary::Interact(Particle* particle, const Double_t* normal, TGeoNaviga
    }
    //------------------------------------------------------
    // 2. -- Reflect particle
-   if (particle->Reflect(normal, navigator, crossedNode, initialPath) == kFALSE) {
+   if (particle->Reflect(normal, navigator, crossedNode, initialCursor, clock) == kFALSE) {
       Error("Interact","Reflect particle failed");
       throw runtime_error("Reflection of particle failed");
    }  
@@ -282,7 +282,7 @@ Bool_t Boundary::AbsorbParticle(Particle* particle, const Double_t* normal)
       return kFALSE;
    }
    Double_t lossProb = 2.*eta*(TMath::Sqrt(energyPerp/(this->FermiPotential() - energyPerp)));
-   if (gRandom->Uniform(0.0, 1.0) <= lossProb) {
+   if (particle->GetRandomGenerator()->Uniform(0.0, 1.0) <= lossProb) {
       // Particle absorbed/upscattered by nuclei
       return kTRUE;
    }
@@ -352,17 +352,17 @@ Detector::~Detector()
 }
 
 //_____________________________________________________________________________
-Bool_t Detector::Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const char* initialPath, const RunConfig& /*runconfig*/)
+Bool_t Detector::Interact(Particle* particle, const Double_t* normal, TGeoNavigator* navigator, TGeoNode* crossedNode, const NavigationCursor& initialCursor, const RunConfig& /*runconfig*/, const Clock& clock)
 {   
 // -- Was particle detected?
-   if (gRandom->Uniform(0.0,1.0) <= fDetectionEfficiency) {
+   if (particle->GetRandomGenerator()->Uniform(0.0,1.0) <= fDetectionEfficiency) {
       // -- Particle detected
       particle->IsDetected();
       return kFALSE;
    }
    
    // If not detected, reflect particle.
-   if (particle->Reflect(normal, navigator, crossedNode, initialPath) == kFALSE) {
+   if (particle->Reflect(normal, navigator, crossedNode, initialCursor, clock) == kFALSE) {
       Error("Interact","Reflect particle failed");
       throw runtime_error("Reflect particle failed");
    }
@@ -428,7 +428,7 @@ BlackHole::~BlackHole()
 }
 
 //_____________________________________________________________________________
-Bool_t BlackHole::Interact(Particle* particle, const Double_t* /*normal*/, TGeoNavigator* /*navigator*/, TGeoNode* /*crossedNode*/, const char* /*initialPath*/, const RunConfig& /*runconfig*/)
+Bool_t BlackHole::Interact(Particle* particle, const Double_t* /*normal*/, TGeoNavigator* /*navigator*/, TGeoNode* /*crossedNode*/, const NavigationCursor& /*initialCursor*/, const RunConfig& /*runconfig*/, const Clock& /*clock*/)
 {
 // -- Particle is Lost if it finds itself in BlackHole
    particle->IsLost();
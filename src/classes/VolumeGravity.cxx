@@ -0,0 +1,47 @@
+// VolumeGravity class
+#include "VolumeGravity.h"
+
+#include "TMath.h"
+#include "TGeoVolume.h"
+#include "TGeoNode.h"
+#include "TGeoMatrix.h"
+
+using namespace std;
+
+//#define VERBOSE_MODE
+
+//______________________________________________________________________________
+VolumeGravity::VolumeGravity()
+              :fIsUnique(kFALSE),
+               fDaughterFields()
+{
+   // -- Default Constructor. Never valid.
+   fField[0] = 0.; fField[1] = 0.; fField[2] = 0.;
+}
+
+//______________________________________________________________________________
+VolumeGravity::VolumeGravity(const TGeoVolume& volume, const Double_t* field)
+              :fIsUnique(kTRUE),
+               fDaughterFields()
+{
+   // -- Constructor. Store the field in the volume's frame and transform it into the frame
+   // -- of each daughter, exactly as the daughter's node would during propagation.
+   for (Int_t i = 0; i < 3; i++) fField[i] = field[i];
+   const Int_t numDaughters = volume.GetNdaughters();
+   fDaughterFields.resize(3*numDaughters);
+   for (Int_t i = 0; i < numDaughters; i++) {
+      volume.GetNode(i)->MasterToLocalVect(fField, &fDaughterFields[3*i]);
+   }
+}
+
+//______________________________________________________________________________
+Bool_t VolumeGravity::Matches(const Double_t* field) const
+{
+   // -- Whether another placement's field agrees with the stored one, to rounding error
+   const Double_t magnitude = TMath::Sqrt(fField[0]*fField[0] + fField[1]*fField[1] + fField[2]*fField[2]);
+   const Double_t tolerance = 1.e-12*(magnitude > 1. ? magnitude : 1.);
+   for (Int_t i = 0; i < 3; i++) {
+      if (TMath::Abs(field[i] - fField[i]) > tolerance) return kFALSE;
+   }
+   return kTRUE;
+}
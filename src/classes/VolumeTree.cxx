@@ -0,0 +1,189 @@
+// VolumeTree class
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+
+#include "VolumeTree.h"
+
+#include "TGeoVolume.h"
+#include "TGeoNode.h"
+#include "TGeoMatrix.h"
+#include "TGeoBBox.h"
+#include "TGeoShape.h"
+#include "TMath.h"
+
+using namespace std;
+
+//#define VERBOSE_MODE
+
+namespace {
+   // -- Orders daughters by the centre of their bounding box along one axis
+   struct CentreLess {
+      const vector<Double_t>& fBounds;
+      const Int_t fAxis;
+      CentreLess(const vector<Double_t>& bounds, const Int_t axis) : fBounds(bounds), fAxis(axis) {}
+      bool operator()(const Int_t a, const Int_t b) const {
+         return (fBounds[6*a + fAxis] + fBounds[6*a + 3 + fAxis])
+                  < (fBounds[6*b + fAxis] + fBounds[6*b + 3 + fAxis]);
+      }
+   };
+}
+
+//______________________________________________________________________________
+VolumeTree::VolumeTree()
+           :fNodes(),
+            fDaughters(),
+            fBounds()
+{
+   // -- Default Constructor. Empty tree.
+}
+
+//______________________________________________________________________________
+VolumeTree::VolumeTree(const TGeoVolume& volume)
+           :fNodes(),
+            fDaughters(),
+            fBounds()
+{
+   // -- Constructor. Compute the box bounding each daughter of the volume, in the volume's
+   // -- frame, and build the hierarchy over them.
+   const Int_t numDaughters = volume.GetNdaughters();
+   if (numDaughters == 0) return;
+   fBounds.resize(6*numDaughters);
+   for (Int_t i = 0; i < numDaughters; i++) {
+      const TGeoNode* daughter = volume.GetNode(i);
+      // Every TGeoShape is a TGeoBBox, holding the shape's own bounding box
+      const TGeoBBox* shape = static_cast<const TGeoBBox*>(daughter->GetVolume()->GetShape());
+      const Double_t* origin = shape->GetOrigin();
+      const Double_t halfLength[3] = {shape->GetDX(), shape->GetDY(), shape->GetDZ()};
+      Double_t* lower = &fBounds[6*i];
+      Double_t* upper = &fBounds[6*i + 3];
+      for (Int_t axis = 0; axis < 3; axis++) {
+         lower[axis] = TGeoShape::Big();
+         upper[axis] = -TGeoShape::Big();
+      }
+      // Transform the eight corners of the box into the mother's frame
+      for (Int_t corner = 0; corner < 8; corner++) {
+         Double_t local[3], master[3];
+         for (Int_t axis = 0; axis < 3; axis++) {
+            const Double_t sign = ((corner >> axis) & 1) ? 1.0 : -1.0;
+            local[axis] = origin[axis] + sign*halfLength[axis];
+         }
+         daughter->GetMatrix()->LocalToMaster(local, master);
+         for (Int_t axis = 0; axis < 3; axis++) {
+            lower[axis] = TMath::Min(lower[axis], master[axis]);
+            upper[axis] = TMath::Max(upper[axis], master[axis]);
+         }
+      }
+      // Pad by the geometry tolerance, so that points sitting on a daughter's surface
+      // are never missed
+      for (Int_t axis = 0; axis < 3; axis++) {
+         lower[axis] -= TGeoShape::Tolerance();
+         upper[axis] += TGeoShape::Tolerance();
+      }
+   }
+   this->Build();
+   #ifdef VERBOSE_MODE
+      cout << "Built tree over " << numDaughters << " daughters of " << volume.GetName();
+      cout << " with " << fNodes.size() << " nodes" << endl;
+   #endif
+}
+
+//______________________________________________________________________________
+VolumeTree::VolumeTree(const vector<Double_t>& bounds)
+           :fNodes(),
+            fDaughters(),
+            fBounds(bounds)
+{
+   // -- Constructor. Build the hierarchy over a list of boxes, given as the lower then the
+   // -- upper corner of each box. Box i is reported as 'daughter' i.
+   this->Build();
+}
+
+//______________________________________________________________________________
+void VolumeTree::Build()
+{
+   // -- Build the hierarchy over the boxes in fBounds
+   const Int_t numDaughters = static_cast<Int_t>(fBounds.size()/6);
+   if (numDaughters == 0) return;
+   fDaughters.resize(numDaughters);
+   for (Int_t i = 0; i < numDaughters; i++) {fDaughters[i] = i;}
+   fNodes.reserve(2*numDaughters/kLeafSize + 1);
+   this->BuildNode(0, numDaughters);
+}
+
+//______________________________________________________________________________
+Int_t VolumeTree::BuildNode(const Int_t first, const Int_t count)
+{
+   // -- Create the node holding fDaughters[first, first+count), splitting it at the median
+   // -- of the daughters' centres along the longest side of the node. Returns its index.
+   const Int_t index = static_cast<Int_t>(fNodes.size());
+   fNodes.push_back(TreeNode());
+   TreeNode node;
+   for (Int_t axis = 0; axis < 3; axis++) {
+      node.fLower[axis] = TGeoShape::Big();
+      node.fUpper[axis] = -TGeoShape::Big();
+   }
+   for (Int_t i = first; i < first + count; i++) {
+      const Int_t daughter = fDaughters[i];
+      for (Int_t axis = 0; axis < 3; axis++) {
+         node.fLower[axis] = TMath::Min(node.fLower[axis], fBounds[6*daughter + axis]);
+         node.fUpper[axis] = TMath::Max(node.fUpper[axis], fBounds[6*daughter + 3 + axis]);
+      }
+   }
+   node.fLeft = -1;
+   node.fRight = -1;
+   node.fFirst = first;
+   node.fCount = count;
+   if (count > kLeafSize) {
+      Int_t splitAxis = 0;
+      for (Int_t axis = 1; axis < 3; axis++) {
+         if (node.fUpper[axis] - node.fLower[axis] > node.fUpper[splitAxis] - node.fLower[splitAxis]) {
+            splitAxis = axis;
+         }
+      }
+      const Int_t half = count/2;
+      vector<Int_t>::iterator begin = fDaughters.begin() + first;
+      nth_element(begin, begin + half, begin + count, CentreLess(fBounds, splitAxis));
+      node.fLeft = this->BuildNode(first, half);
+      node.fRight = this->BuildNode(first + half, count - half);
+      node.fCount = 0;
+   }
+   fNodes[index] = node;
+   return index;
+}
+
+//______________________________________________________________________________
+void VolumeTree::FindCandidates(const Double_t* lower, const Double_t* upper, vector<Int_t>& candidates) const
+{
+   // -- Fill 'candidates' with the index of every daughter whose bounding box overlaps the
+   // -- box [lower, upper], in increasing order of index
+   candidates.clear();
+   if (fNodes.empty()) return;
+   // The tree is balanced, so its depth is far below the size of this stack
+   Int_t stack[64];
+   Int_t stackSize = 0;
+   stack[stackSize++] = 0;
+   while (stackSize > 0) {
+      const TreeNode& node = fNodes[stack[--stackSize]];
+      if (node.fLower[0] > upper[0] || node.fUpper[0] < lower[0] ||
+          node.fLower[1] > upper[1] || node.fUpper[1] < lower[1] ||
+          node.fLower[2] > upper[2] || node.fUpper[2] < lower[2]) continue;
+      if (node.fLeft < 0) {
+         for (Int_t i = node.fFirst; i < node.fFirst + node.fCount; i++) {
+            const Int_t daughter = fDaughters[i];
+            const Double_t* boxLower = &fBounds[6*daughter];
+            const Double_t* boxUpper = &fBounds[6*daughter + 3];
+            if (boxLower[0] > upper[0] || boxUpper[0] < lower[0] ||
+                boxLower[1] > upper[1] || boxUpper[1] < lower[1] ||
+                boxLower[2] > upper[2] || boxUpper[2] < lower[2]) continue;
+            candidates.push_back(daughter);
+         }
+      } else {
+         assert(stackSize + 2 <= 64);
+         stack[stackSize++] = node.fRight;
+         stack[stackSize++] = node.fLeft;
+      }
+   }
+   // Keep the order in which the daughters would be tested without the tree
+   sort(candidates.begin(), candidates.end());
+}
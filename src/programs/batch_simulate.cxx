@@ -15,15 +15,22 @@ Int_t main(Int_t argc, Char_t **argv)
 {
    ///////////////////////////////////////////////////////////////////////////////////////
    // -- batch_process takes a config file and submits each run inside it to the feynman cluster
-   // -- as an individual job. It will only work if launched from the feynman cluster itself
+   // -- as an individual job. It will only work if launched from the feynman cluster itself.
+   // -- Optionally, each run is split into a number of shards, each submitted as its own job,
+   // -- whose outputs can be combined afterwards with merge_shards.
    ///////////////////////////////////////////////////////////////////////////////////////
-   // Fetch the configfile name and queue name from commandline args
+   // Fetch the configfile name, queue name and number of shards from commandline args
    string configFileName, queueName;
-   if (argc == 3) {
+   int shards = 1;
+   if (argc == 3 || argc == 4) {
       configFileName = argv[1];
       queueName = argv[2];
+      if (argc == 4 && (Algorithms::String::ConvertToInt(argv[3], shards) == false || shards < 1)) {
+         cerr << "Number of shards must be a positive integer" << endl;
+         return EXIT_FAILURE;
+      }
    } else {
-      cerr << "Usage, batch_process <configFile.cfg> <queue name>" << endl;
+      cerr << "Usage, batch_process <configFile.cfg> <queue name> [shards per run]" << endl;
       return EXIT_FAILURE;
    }
    // Check formatting of queue name
@@ -44,32 +51,38 @@ Int_t main(Int_t argc, Char_t **argv)
    cout << "Beginning Batch Job on Feynman" << endl;
    cout << "ConfigFile: " << configFileName << endl;
    cout << "Number of Runs: " << numberOfRuns << endl;
+   cout << "Shards per Run: " << shards << endl;
    // Loop over all runs in the config file
    for (int runNum = 1; runNum <= numberOfRuns; runNum++) {
       // Get the current run name and check that a section for this run exists in the config file
-      ostringstream runName, jobName;
+      ostringstream runName;
       boost::gregorian::date today_date(boost::gregorian::day_clock::local_day());
       runName << "Run" << runNum;
-      jobName << "job_" << today_date << "_Run" << runNum;
       map<string,string> section = configFile.GetSection(runName.str());
       if (section.empty()) {
          cerr << "Error: Could not find Section - " << runName.str() << endl;
          return EXIT_FAILURE;
       }
-      // Format a string that will specify the qsub command we wish to issue on feynman
-      // that will submit a job
-      string script = Algorithms::FileSystem::ExpandFilePath("$UCN_DIR");
-      script += "/scripts/submit_job.sh";
-      ostringstream command;
-      command << "qsub -q " << queueName << ".q ";
-      command << "-N " << jobName.str() << " ";
-      command << script << " ";
-      command << configFileName << " ";
-      command << runNum;
-      // Submit qsub command to enter job into queue
-      cout << "Executing command: " << command.str() << endl;
-      int errorcode = system(command.str().c_str());
-      cout << "The value returned was: " << (errorcode % 256) << endl;
+      for (int shard = 1; shard <= shards; shard++) {
+         ostringstream jobName;
+         jobName << "job_" << today_date << "_Run" << runNum;
+         if (shards > 1) jobName << "_Shard" << shard;
+         // Format a string that will specify the qsub command we wish to issue on feynman
+         // that will submit a job
+         string script = Algorithms::FileSystem::ExpandFilePath("$UCN_DIR");
+         script += "/scripts/submit_job.sh";
+         ostringstream command;
+         command << "qsub -q " << queueName << ".q ";
+         command << "-N " << jobName.str() << " ";
+         command << script << " ";
+         command << configFileName << " ";
+         command << runNum;
+         if (shards > 1) command << " " << shard << "/" << shards;
+         // Submit qsub command to enter job into queue
+         cout << "Executing command: " << command.str() << endl;
+         int errorcode = system(command.str().c_str());
+         cout << "The value returned was: " << (errorcode % 256) << endl;
+      }
    }
    cout << "-------------------------------------------" << endl;
    return EXIT_SUCCESS;
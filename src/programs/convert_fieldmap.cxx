@@ -0,0 +1,63 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+#include "TGeoMatrix.h"
+#include "TBenchmark.h"
+
+#include "FieldMap.h"
+#include "FlatKDTree.h"
+
+using std::cout;
+using std::endl;
+using std::cerr;
+using std::string;
+
+//__________________________________________________________________________
+Int_t main(Int_t argc,Char_t **argv)
+{
+   ///////////////////////////////////////////////////////////////////////////////////////
+   // -- Convert a text field map, as read by MagFieldMap::BuildMap, into a binary map.
+   // -- The binary map holds the vertices already placed in the global frame, by the same
+   // -- translation and rotation (Euler angles in degrees) the field is given in the
+   // -- geometry, along with the map's search tree. BuildMap maps such a file in place, and
+   // -- refuses it if the field is placed differently from the placement recorded here.
+   ///////////////////////////////////////////////////////////////////////////////////////
+   if (argc != 3 && argc != 6 && argc != 9) {
+      cerr << "Usage, convert_fieldmap <fieldmap.txt> <fieldmap.bin> [dx dy dz [phi theta psi]]" << endl;
+      return EXIT_FAILURE;
+   }
+   const string inputFileName = argv[1];
+   const string outputFileName = argv[2];
+   Double_t translation[3] = {0.,0.,0.};
+   Double_t angles[3] = {0.,0.,0.};
+   for (Int_t i = 0; i < 3 && argc >= 6; i++) {translation[i] = atof(argv[3 + i]);}
+   for (Int_t i = 0; i < 3 && argc == 9; i++) {angles[i] = atof(argv[6 + i]);}
+   TGeoRotation rotation("FieldMapRotation", angles[0], angles[1], angles[2]);
+   TGeoCombiTrans matrix(translation[0], translation[1], translation[2], &rotation);
+   TBenchmark benchmark;
+   benchmark.Start("Convert");
+   MagFieldMap field("FieldMap", NULL, &matrix);
+   if (field.BuildMap(inputFileName) == kFALSE) {
+      cerr << "Error: Failed to build field map from: " << inputFileName << endl;
+      return EXIT_FAILURE;
+   }
+   if (field.WriteBinaryMap(outputFileName) == kFALSE) {
+      cerr << "Error: Failed to write binary field map: " << outputFileName << endl;
+      return EXIT_FAILURE;
+   }
+   benchmark.Stop("Convert");
+   // Check the new file can be mapped back in
+   benchmark.Start("Map");
+   FlatKDTree* tree = FlatKDTree::Map(outputFileName);
+   benchmark.Stop("Map");
+   if (tree == NULL) {
+      cerr << "Error: Failed to map binary field map: " << outputFileName << endl;
+      return EXIT_FAILURE;
+   }
+   cout << "Wrote " << tree->Size() << " vertices to: " << outputFileName << endl;
+   cout << "Time to parse text map and build tree: " << benchmark.GetRealTime("Convert") << " s" << endl;
+   cout << "Time to map binary map: " << benchmark.GetRealTime("Map") << " s" << endl;
+   delete tree;
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,405 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <cstdio>
+#include <stdexcept>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TKey.h"
+#include "TClass.h"
+#include "TROOT.h"
+#include "TObjArray.h"
+
+#include "RunConfig.h"
+#include "ParticleManifest.h"
+#include "PopulationData.h"
+
+#include "ValidStates.h"
+#include "DataAnalysis.h"
+
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+using namespace std;
+
+bool MergeShards(const vector<string>& shardFileNames, const string& outputFileName, const int jobs);
+bool StartSummaryWorkers(const vector<string>& shardFileNames, const string& outputFileName, const int jobs,
+                         vector<string>& summaryFileNames, vector<pid_t>& workers);
+bool CollectSummaries(const vector<string>& summaryFileNames, const vector<pid_t>& workers,
+                      ParticleManifest& mergedManifest, PopulationData*& mergedPopulation);
+bool WaitForWorkers(const vector<pid_t>& workers);
+void RemoveFiles(const vector<string>& fileNames);
+bool SummariseShards(const vector<string>& shardFileNames, ParticleManifest& mergedManifest,
+                     PopulationData*& mergedPopulation);
+bool CopyParticleTrees(const vector<string>& shardFileNames, TFile& outputFile, TTree*& mergedTree);
+Long64_t CountShardParticles(TTree& tree);
+void CopyRunObjects(TFile& shardFile, TFile& outputFile);
+
+//_____________________________________________________________________________
+Int_t main(Int_t argc,Char_t **argv)
+{
+   // -- Combine the outputs of the shards of a run (simulate_ucn --shard/--range) into a
+   // -- single datafile, identical in layout to that of the run propagated in one go. The
+   // -- shards must be given in the order of the particles they propagated.
+   try {
+      // -- Create a description for all command-line options
+      po::options_description description("Allowed options");
+      description.add_options()
+        ("help", "produce help message")
+        ("shards", po::value<vector<string> >()->multitoken(), "filenames of the shards' datafiles, in order")
+        ("output", po::value<string>(), "filename of the merged datafile")
+        ("jobs", po::value<int>()->default_value(1), "number of processes to merge with")
+      ;
+
+      // -- Create a description for all command-line options
+      po::variables_map variables;
+      po::store(po::parse_command_line(argc, argv, description), variables);
+      po::notify(variables);
+
+      // -- If user requests help, print the options description
+      if (variables.count("help")) {
+         cout << description << "\n";
+         return 1;
+      }
+
+      // -- Check whether any shards were given. If not, exit with a warning
+      if (variables.count("shards") == 0) {
+         cout << "No shard datafiles have been given.\n";
+         return EXIT_FAILURE;
+      }
+
+      // -- Check whether an output file was given. If not, exit with a warning
+      if (variables.count("output")) {
+         cout << "Merged DataFile name was set to: "
+              << variables["output"].as<string>() << "\n";
+      } else {
+         cout << "Merged DataFile name was not set.\n";
+         return EXIT_FAILURE;
+      }
+
+      if (MergeShards(variables["shards"].as<vector<string> >(), variables["output"].as<string>(),
+                      variables["jobs"].as<int>()) == false) {
+         return EXIT_FAILURE;
+      }
+   }
+   catch(exception& e) {
+      cerr << "error: " << e.what() << "\n";
+      return 1;
+   }
+   catch(...) {
+      cerr << "Exception of unknown type!\n";
+   }
+   return EXIT_SUCCESS;
+}
+
+//_____________________________________________________________________________
+bool MergeShards(const vector<string>& shardFileNames, const string& outputFileName, const int jobs)
+{
+   // -- Append each shard's particle tree to the output's, copying its baskets without
+   // -- unpacking them, and its manifest with the tree indexes moved along to match. Sum the
+   // -- shards' population data, and take everything else from the first shard.
+   // -- With more than one job, the shards are checked and their manifests and populations
+   // -- summed by worker processes, while this process copies the trees.
+   vector<string> summaryFileNames;
+   vector<pid_t> workers;
+   if (StartSummaryWorkers(shardFileNames, outputFileName, jobs, summaryFileNames, workers) == false) {
+      return false;
+   }
+   TFile* outputFile = Analysis::DataFile::OpenRootFile(outputFileName, "RECREATE");
+   TTree* mergedTree = NULL;
+   bool success = (outputFile != NULL && CopyParticleTrees(shardFileNames, *outputFile, mergedTree));
+   ParticleManifest mergedManifest;
+   PopulationData* mergedPopulation = NULL;
+   if (workers.empty() == true) {
+      success = success && SummariseShards(shardFileNames, mergedManifest, mergedPopulation);
+   } else {
+      // Always wait for the workers, even if copying failed
+      const bool summarised = CollectSummaries(summaryFileNames, workers, mergedManifest, mergedPopulation);
+      success = success && summarised;
+   }
+   const Long64_t mergedParticles = static_cast<Long64_t>(mergedManifest.GetListing(States::initial).Entries());
+   if (success == true && mergedTree != NULL && mergedTree->GetEntries() != mergedParticles) {
+      cerr << "Error: The shards' manifests list " << mergedParticles << " particles, but their trees hold ";
+      cerr << mergedTree->GetEntries() << endl;
+      success = false;
+   }
+   if (success == true) {
+      // Write out in the same order as Data::Export
+      outputFile->cd();
+      if (mergedTree == NULL) mergedTree = new TTree("Particles","Tree of Particle Data");
+      mergedTree->Write(mergedTree->GetName(), TObject::kOverwrite);
+      mergedManifest.Write(mergedManifest.GetName(), TObject::kOverwrite);
+      if (mergedPopulation != NULL) mergedPopulation->Write(mergedPopulation->GetName(), TObject::kOverwrite);
+      cout << "Total particles merged: " << mergedParticles << endl;
+      mergedManifest.Print();
+   }
+   if (mergedPopulation) delete mergedPopulation;
+   if (outputFile) {
+      outputFile->Close();
+      delete outputFile;
+   }
+   return success;
+}
+
+//_____________________________________________________________________________
+bool StartSummaryWorkers(const vector<string>& shardFileNames, const string& outputFileName, const int jobs,
+                         vector<string>& summaryFileNames, vector<pid_t>& workers)
+{
+   // -- Split the shards into consecutive groups, and start a process for each that checks
+   // -- its group and writes the group's manifest and population to a summary file. Starts
+   // -- none if there is only one job to merge with.
+   // -- (ROOT's I/O cannot be shared between threads, so processes are used instead)
+   const size_t groups = min(static_cast<size_t>(max(jobs, 1)), shardFileNames.size());
+   if (groups <= 1) return true;
+   cout << "Checking " << shardFileNames.size() << " shards in " << groups << " processes" << endl;
+   cout.flush();
+   for (size_t group = 0; group < groups; group++) {
+      const size_t first = (shardFileNames.size()*group)/groups;
+      const size_t last = (shardFileNames.size()*(group + 1))/groups;
+      ostringstream summaryFileName;
+      summaryFileName << outputFileName << ".summary" << group + 1;
+      const pid_t worker = fork();
+      if (worker < 0) {
+         cerr << "Error: Failed to start a process to merge with" << endl;
+         WaitForWorkers(workers);
+         RemoveFiles(summaryFileNames);
+         return false;
+      } else if (worker == 0) {
+         bool summarised = false;
+         try {
+            const vector<string> groupFileNames(shardFileNames.begin() + first, shardFileNames.begin() + last);
+            ParticleManifest manifest;
+            PopulationData* population = NULL;
+            summarised = SummariseShards(groupFileNames, manifest, population);
+            TFile* summaryFile = (summarised ? Analysis::DataFile::OpenRootFile(summaryFileName.str(), "RECREATE") : NULL);
+            if (summaryFile != NULL) {
+               manifest.Write(manifest.GetName());
+               if (population != NULL) population->Write(population->GetName());
+               summaryFile->Close();
+               delete summaryFile;
+            } else {
+               summarised = false;
+            }
+            if (population) delete population;
+         }
+         catch(exception& e) {
+            cerr << "error: " << e.what() << "\n";
+            summarised = false;
+         }
+         cout.flush();
+         _exit(summarised ? EXIT_SUCCESS : EXIT_FAILURE);
+      }
+      summaryFileNames.push_back(summaryFileName.str());
+      workers.push_back(worker);
+   }
+   return true;
+}
+//_____________________________________________________________________________
+bool CollectSummaries(const vector<string>& summaryFileNames, const vector<pid_t>& workers,
+                      ParticleManifest& mergedManifest, PopulationData*& mergedPopulation)
+{
+   // -- Wait for the workers, then append the manifests and sum the populations of their
+   // -- groups of shards, in order. The summary files are removed afterwards.
+   bool success = WaitForWorkers(workers);
+   if (success == false) cerr << "Error: Failed to check every group of shards" << endl;
+   vector<string>::const_iterator summaryIter;
+   for (summaryIter = summaryFileNames.begin(); success == true && summaryIter != summaryFileNames.end(); ++summaryIter) {
+      TFile* summaryFile = Analysis::DataFile::OpenRootFile(*summaryIter, "READ");
+      if (summaryFile == NULL) {success = false; break;}
+      ParticleManifest* manifest = NULL;
+      PopulationData* population = NULL;
+      summaryFile->GetObject("ParticleManifest", manifest);
+      summaryFile->GetObject("PopulationData", population);
+      if (manifest == NULL) {
+         cerr << "Error: No manifest in " << *summaryIter << endl;
+         success = false;
+      } else {
+         mergedManifest.Append(*manifest, static_cast<int>(mergedManifest.GetListing(States::initial).Entries()));
+      }
+      if (population != NULL && mergedPopulation == NULL) {
+         mergedPopulation = population;
+         population = NULL;
+      } else if (population != NULL) {
+         mergedPopulation->Add(*population);
+      }
+      if (manifest) delete manifest;
+      if (population) delete population;
+      summaryFile->Close();
+      delete summaryFile;
+   }
+   RemoveFiles(summaryFileNames);
+   return success;
+}
+
+//_____________________________________________________________________________
+bool WaitForWorkers(const vector<pid_t>& workers)
+{
+   // -- Wait for every worker to finish. Returns false if any of them failed.
+   bool success = true;
+   vector<pid_t>::const_iterator workerIter;
+   for (workerIter = workers.begin(); workerIter != workers.end(); ++workerIter) {
+      int status = 0;
+      if (waitpid(*workerIter, &status, 0) < 0 || WIFEXITED(status) == false || WEXITSTATUS(status) != EXIT_SUCCESS) {
+         success = false;
+      }
+   }
+   return success;
+}
+
+//_____________________________________________________________________________
+void RemoveFiles(const vector<string>& fileNames)
+{
+   vector<string>::const_iterator fileIter;
+   for (fileIter = fileNames.begin(); fileIter != fileNames.end(); ++fileIter) {
+      remove(fileIter->c_str());
+   }
+}
+
+//_____________________________________________________________________________
+bool SummariseShards(const vector<string>& shardFileNames, ParticleManifest& mergedManifest,
+                     PopulationData*& mergedPopulation)
+{
+   // -- Check that each shard is the output of a completed run, whose manifest agrees with its
+   // -- tree, then append its manifest, with the tree indexes moved along past the shards before
+   // -- it, and add its population data to the sum
+   vector<string>::const_iterator shardIter;
+   for (shardIter = shardFileNames.begin(); shardIter != shardFileNames.end(); ++shardIter) {
+      TFile* shardFile = Analysis::DataFile::OpenRootFile(*shardIter, "READ");
+      if (shardFile == NULL) return false;
+      // A shard still holding a checkpoint never finished
+      Listing* checkpoint = NULL;
+      shardFile->GetObject("Checkpoint", checkpoint);
+      TTree* shardTree = NULL;
+      shardFile->GetObject("Particles", shardTree);
+      if (checkpoint != NULL || shardTree == NULL) {
+         cerr << "Error: " << *shardIter << " is not the output of a completed run" << endl;
+         if (checkpoint) delete checkpoint;
+         shardFile->Close();
+         delete shardFile;
+         return false;
+      }
+      const ParticleManifest& manifest = Analysis::DataFile::LoadParticleManifest(*shardFile);
+      const Long64_t shardParticles = static_cast<Long64_t>(manifest.GetListing(States::initial).Entries());
+      bool success = true;
+      if (CountShardParticles(*shardTree) != shardParticles) {
+         cerr << "Error: Branches of the particle tree in " << *shardIter << " do not match its manifest" << endl;
+         success = false;
+      } else {
+         mergedManifest.Append(manifest, static_cast<int>(mergedManifest.GetListing(States::initial).Entries()));
+         // Sum the populations over all the shards
+         TKey *key;
+         TIter folderIter(shardFile->GetListOfKeys());
+         while ((key = dynamic_cast<TKey*>(folderIter.Next()))) {
+            TClass *cl = gROOT->GetClass(key->GetClassName());
+            if (!cl || cl->InheritsFrom("PopulationData") == false) continue;
+            PopulationData* population = dynamic_cast<PopulationData*>(key->ReadObj());
+            if (population == NULL) continue;
+            if (mergedPopulation == NULL) {
+               mergedPopulation = population;
+            } else {
+               mergedPopulation->Add(*population);
+               delete population;
+            }
+            break;
+         }
+      }
+      delete &manifest;
+      shardFile->Close();
+      delete shardFile;
+      if (success == false) return false;
+      cout << "Checked " << *shardIter << ": " << shardParticles << " particles" << endl;
+   }
+   return true;
+}
+
+//_____________________________________________________________________________
+bool CopyParticleTrees(const vector<string>& shardFileNames, TFile& outputFile, TTree*& mergedTree)
+{
+   // -- Append each shard's particle tree to the merged tree, copying its baskets without
+   // -- unpacking them, and copy the objects describing the whole run from the first shard
+   vector<string>::const_iterator shardIter;
+   for (shardIter = shardFileNames.begin(); shardIter != shardFileNames.end(); ++shardIter) {
+      TFile* shardFile = Analysis::DataFile::OpenRootFile(*shardIter, "READ");
+      if (shardFile == NULL) return false;
+      TTree* shardTree = NULL;
+      shardFile->GetObject("Particles", shardTree);
+      const Long64_t shardParticles = (shardTree == NULL ? -1 : CountShardParticles(*shardTree));
+      bool success = true;
+      if (shardParticles < 0) {
+         cerr << "Error: Branches of the particle tree in " << *shardIter << " differ in length" << endl;
+         success = false;
+      } else {
+         outputFile.cd();
+         if (shardIter == shardFileNames.begin()) CopyRunObjects(*shardFile, outputFile);
+         // An empty shard's tree has no branches yet, so take the layout from the first that has
+         if (shardParticles > 0) {
+            if (mergedTree == NULL) {
+               mergedTree = shardTree->CloneTree(0);
+               mergedTree->SetDirectory(&outputFile);
+            }
+            const Long64_t mergedEntries = mergedTree->GetEntries();
+            mergedTree->CopyEntries(shardTree, -1, "fast");
+            if (mergedTree->GetEntries() - mergedEntries != shardParticles) {
+               cerr << "Error: Failed to copy the particle tree of " << *shardIter << endl;
+               success = false;
+            }
+         }
+      }
+      shardFile->Close();
+      delete shardFile;
+      if (success == false) return false;
+      cout << "Merged " << *shardIter << ": " << shardParticles << " particles" << endl;
+   }
+   return true;
+}
+
+//_____________________________________________________________________________
+Long64_t CountShardParticles(TTree& tree)
+{
+   // -- Every branch of a run's particle tree holds one entry per particle. Set the tree's own
+   // -- entry count to match, since its branches are filled individually, so that the tree
+   // -- can be copied whole. Returns -1 if the branches differ in length.
+   TObjArray* branches = tree.GetListOfBranches();
+   Long64_t particles = 0;
+   for (Int_t branchNum = 0; branchNum < branches->GetEntriesFast(); branchNum++) {
+      TBranch* branch = static_cast<TBranch*>(branches->UncheckedAt(branchNum));
+      if (branchNum > 0 && branch->GetEntries() != particles) return -1;
+      particles = branch->GetEntries();
+   }
+   tree.SetEntries(particles);
+   return particles;
+}
+
+//_____________________________________________________________________________
+void CopyRunObjects(TFile& shardFile, TFile& outputFile)
+{
+   // -- Copy the objects describing the whole run, such as its geometry, from a shard to the
+   // -- output. The RunConfig no longer refers to any one shard.
+   set<string> copied;
+   TKey *key;
+   TIter folderIter(shardFile.GetListOfKeys());
+   while ((key = dynamic_cast<TKey*>(folderIter.Next()))) {
+      // Only take the latest cycle of each object
+      if (copied.insert(key->GetName()).second == false) continue;
+      TClass *cl = gROOT->GetClass(key->GetClassName());
+      if (!cl) continue;
+      // The particles and populations are merged separately
+      if (cl->InheritsFrom("TTree") || cl->InheritsFrom("ParticleManifest") ||
+          cl->InheritsFrom("PopulationData")) continue;
+      TObject* object = key->ReadObj();
+      if (object == NULL) continue;
+      RunConfig* runConfig = dynamic_cast<RunConfig*>(object);
+      if (runConfig != NULL) runConfig->ClearShard();
+      outputFile.cd();
+      object->Write(key->GetName(), TObject::kOverwrite);
+      delete object;
+   }
+}
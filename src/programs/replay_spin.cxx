@@ -0,0 +1,302 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TMath.h"
+#include "TVector3.h"
+
+#include "Particle.h"
+#include "RunConfig.h"
+#include "ParticleManifest.h"
+#include "MagFieldArray.h"
+#include "ElecFieldArray.h"
+#include "Trajectory.h"
+#include "Spin.h"
+#include "SpinData.h"
+#include "SpinReplay.h"
+
+#include "ValidStates.h"
+#include "DataAnalysis.h"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+using namespace std;
+
+bool ReplaySpin(const string& filename, const string& state, const vector<string>& fieldsFiles,
+                const bool compare, const double tolerance);
+bool LoadFields(const string& fieldsFile, const RunConfig& runConfig, MagFieldArray*& magFieldArray,
+                ElecFieldArray*& elecFieldArray);
+double PolarisationDifference(const SpinData& replayed, const SpinData& tracked);
+
+//_____________________________________________________________________________
+Int_t main(Int_t argc,Char_t **argv)
+{
+   // -- Replay the spin of every particle in a state, along the trajectories recorded in a
+   // -- datafile (RecordTrajectory = YES), in each of the fields files given, and report
+   // -- the T2 found in each. With --compare, the run's own fields are replayed too, and the
+   // -- result checked against the spin the run tracked (RecordSpin = YES).
+   try {
+      // -- Create a description for all command-line options
+      po::options_description description("Allowed options");
+      description.add_options()
+        ("help", "produce help message")
+        ("file", po::value<string>(), "filename of the datafile holding the trajectories")
+        ("state", po::value<string>(), "state of the particles to be replayed")
+        ("fields", po::value<vector<string> >()->multitoken(), "fields files, each holding the MagFieldArray and ElecFieldArray to replay the spin in")
+        ("compare", "also replay in the run's own fields file, and compare with the spin tracked by the run")
+        ("tolerance", po::value<double>()->default_value(1.0E-3), "largest difference in polarisation accepted by --compare")
+      ;
+      
+      // -- Create a description for all command-line options
+      po::variables_map variables;
+      po::store(po::parse_command_line(argc, argv, description), variables);
+      po::notify(variables);
+      
+      // -- If user requests help, print the options description
+      if (variables.count("help")) {
+         cout << description << "\n";
+         return 1;
+      }
+      
+      // -- Check whether a datafile was given. If not, exit with a warning
+      if (variables.count("file")) {
+         cout << "DataFile name was set to: "
+              << variables["file"].as<string>() << "\n";
+      } else {
+         cout << "DataFile name was not set.\n";
+         return EXIT_FAILURE;
+      }
+      
+      // -- Check whether a state was given. If not, exit with a warning
+      if (variables.count("state")) {
+         cout << "State to be replayed is: " 
+              << variables["state"].as<string>() << "\n";
+      } else {
+         cout << "No states have been selected.\n";
+         return EXIT_FAILURE;
+      }
+      
+      // -- Check whether any fields were given. If not, exit with a warning
+      const bool compare = (variables.count("compare") > 0);
+      if (variables.count("fields") == 0 && compare == false) {
+         cout << "No fields files have been given.\n";
+         return EXIT_FAILURE;
+      }
+      vector<string> fieldsFiles;
+      if (variables.count("fields")) fieldsFiles = variables["fields"].as<vector<string> >();
+      if (ReplaySpin(variables["file"].as<string>(), variables["state"].as<string>(), fieldsFiles,
+                     compare, variables["tolerance"].as<double>()) == false) {
+         return EXIT_FAILURE;
+      }
+   }
+   catch(exception& e) {
+      cerr << "error: " << e.what() << "\n";
+      return 1;
+   }
+   catch(...) {
+      cerr << "Exception of unknown type!\n";
+   }
+   return EXIT_SUCCESS;
+}
+
+//_____________________________________________________________________________
+bool ReplaySpin(const string& filename, const string& state, const vector<string>& fieldsFiles,
+                const bool compare, const double tolerance)
+{
+   // Read in Filename and check that it is a .root file
+   if (Analysis::DataFile::IsRootFile(filename) == false) {return false;}
+   if (Analysis::DataFile::IsValidStateName(state) == false) {return false;}
+   string stateName = boost::to_lower_copy(state);
+   //////////////////////////////////////////////////////////////////////////////////////
+   // -- Open Data File
+   TFile* file = Analysis::DataFile::OpenRootFile(filename,"READ");
+   if (file == NULL) return false;
+   const RunConfig& runConfig = Analysis::DataFile::LoadRunConfig(*file);
+   // The replay precesses the spin in fixed steps of SpinStepTime, so it would not reproduce
+   // the steps chosen by a run's adaptive spin integrator
+   if (runConfig.SpinTolerance() > 0.) {
+      cerr << "Error - The run chose its spin steps adaptively (SpinTolerance = " << runConfig.SpinTolerance();
+      cerr << "), but spins can only be replayed in fixed steps of SpinStepTime" << endl;
+      delete &runConfig;
+      file->Close();
+      delete file;
+      return false;
+   }
+   const ParticleManifest& manifest = Analysis::DataFile::LoadParticleManifest(*file);
+   vector<int> particleIndexes = manifest.GetListing(stateName).GetTreeIndexes();
+   TTree* dataTree = Analysis::DataFile::LoadParticleDataTree(*file);
+   //////////////////////////////////////////////////////////////////////////////////////
+   // -- Prepare to read each particle's trajectory, and its initial spin
+   Trajectory* trajectory = new Trajectory();
+   TBranch* trajectoryBranch = dataTree->GetBranch(trajectory->ClassName());
+   if (trajectoryBranch == NULL) {
+      cerr << "Error - Could not find branch: " << trajectory->ClassName() << " in input tree" << endl;
+      cerr << "Trajectories are only recorded by runs with RecordTrajectory = YES" << endl;
+      return false;
+   }
+   dataTree->SetBranchAddress(trajectoryBranch->GetName(), &trajectory);
+   Particle* initialParticle = new Particle();
+   TBranch* initialBranch = Analysis::DataFile::GetParticleBranch(States::initial, dataTree);
+   dataTree->SetBranchAddress(initialBranch->GetName(), &initialParticle);
+   // -- The spin tracked by the run, to compare the replay in its own fields against
+   SpinData* trackedSpin = new SpinData();
+   TBranch* spinBranch = NULL;
+   if (compare == true) {
+      spinBranch = dataTree->GetBranch(trackedSpin->ClassName());
+      if (spinBranch == NULL) {
+         cerr << "Error - Could not find branch: " << trackedSpin->ClassName() << " in input tree" << endl;
+         cerr << "Spin is only recorded by runs with RecordSpin = YES" << endl;
+         return false;
+      }
+      dataTree->SetBranchAddress(spinBranch->GetName(), &trackedSpin);
+   }
+   //////////////////////////////////////////////////////////////////////////////////////
+   // -- Load each field configuration. When comparing, the run's own fields come first.
+   vector<string> configurations;
+   if (compare == true) configurations.push_back(runConfig.FieldsFileName());
+   configurations.insert(configurations.end(), fieldsFiles.begin(), fieldsFiles.end());
+   vector<const MagFieldArray*> magFields;
+   vector<const ElecFieldArray*> elecFields;
+   vector<string>::const_iterator fileIter;
+   for (fileIter = configurations.begin(); fileIter != configurations.end(); fileIter++) {
+      MagFieldArray* magFieldArray = NULL;
+      ElecFieldArray* elecFieldArray = NULL;
+      if (LoadFields(*fileIter, runConfig, magFieldArray, elecFieldArray) == false) return false;
+      magFields.push_back(magFieldArray);
+      elecFields.push_back(elecFieldArray);
+   }
+   //////////////////////////////////////////////////////////////////////////////////////
+   // -- Replay every particle in every configuration in a single pass over the trajectories
+   SpinReplay replay(magFields, elecFields, runConfig.SpinStepTime(), runConfig.SpinMeasureInterval());
+   vector<vector<const SpinData*> > spinData(configurations.size());
+   double maxDifference = 0.;
+   int measurementsDiffer = 0;
+   vector<int>::const_iterator indexIter;
+   for (indexIter = particleIndexes.begin(); indexIter != particleIndexes.end(); indexIter++) {
+      trajectoryBranch->GetEntry(*indexIter);
+      initialBranch->GetEntry(*indexIter);
+      vector<SpinData*> results;
+      for (unsigned int i = 0; i < configurations.size(); i++) {results.push_back(new SpinData());}
+      replay.Replay(*trajectory, initialParticle->GetSpin(), results);
+      if (compare == true) {
+         spinBranch->GetEntry(*indexIter);
+         const double difference = PolarisationDifference(*results[0], *trackedSpin);
+         if (difference > maxDifference) maxDifference = difference;
+         if (results[0]->size() != trackedSpin->size()) measurementsDiffer++;
+      }
+      for (unsigned int i = 0; i < configurations.size(); i++) {spinData[i].push_back(results[i]);}
+   }
+   cout << "Replayed " << particleIndexes.size() << " particles in " << configurations.size();
+   cout << " field configurations" << endl;
+   //////////////////////////////////////////////////////////////////////////////////////
+   // -- Calculate T2 in each configuration
+   vector<double> t2(configurations.size(), 0.), t2error(configurations.size(), 0.);
+   for (unsigned int i = 0; i < configurations.size(); i++) {
+      cout << "-------------------------------------------" << endl;
+      cout << "Fields: " << configurations[i] << endl;
+      Analysis::Polarisation::CalculateT2(spinData[i], runConfig.RunTime(), runConfig.SpinMeasureInterval(), t2[i], t2error[i]);
+   }
+   cout << "-------------------------------------------" << endl;
+   cout << setw(40) << "Fields" << setw(16) << "T2 (s)" << setw(16) << "Error (s)" << endl;
+   for (unsigned int i = 0; i < configurations.size(); i++) {
+      cout << setw(40) << configurations[i] << setw(16) << t2[i] << setw(16) << t2error[i] << endl;
+   }
+   bool agrees = true;
+   if (compare == true) {
+      cout << "-------------------------------------------" << endl;
+      cout << "Largest difference in polarisation between the replayed and tracked spin: ";
+      cout << maxDifference << endl;
+      if (measurementsDiffer > 0) {
+         cout << "Particles measured a different number of times by the replay and the run: ";
+         cout << measurementsDiffer << endl;
+      }
+      agrees = (maxDifference <= tolerance);
+      if (agrees == false) {
+         cerr << "Error - Replay in the run's own fields differs from the tracked spin by more than ";
+         cerr << tolerance << endl;
+      }
+   }
+   //////////////////////////////////////////////////////////////////////////////////////
+   // -- Clean up
+   for (unsigned int i = 0; i < configurations.size(); i++) {
+      vector<const SpinData*>::iterator dataIter;
+      for (dataIter = spinData[i].begin(); dataIter != spinData[i].end(); dataIter++) {delete *dataIter;}
+      if (magFields[i]) delete magFields[i];
+      if (elecFields[i]) delete elecFields[i];
+   }
+   delete trajectory;
+   delete initialParticle;
+   delete trackedSpin;
+   file->Close();
+   delete file;
+   return agrees;
+}
+
+//_____________________________________________________________________________
+bool LoadFields(const string& fieldsFile, const RunConfig& runConfig, MagFieldArray*& magFieldArray, ElecFieldArray*& elecFieldArray)
+{
+   // -- Read the fields switched on by the run from a fields file, as FieldManager::Initialise
+   // -- does, so that the spin is replayed in the fields the run would have seen
+   magFieldArray = NULL;
+   elecFieldArray = NULL;
+   if (runConfig.MagFieldOn() == false && runConfig.ElecFieldOn() == false) return true;
+   TFile* f = TFile::Open(fieldsFile.c_str(), "read");
+   if (!f || f->IsZombie()) {
+      cerr << "Error - Cannot open file: " << fieldsFile << endl;
+      if (f) delete f;
+      return false;
+   }
+   bool success = true;
+   if (runConfig.MagFieldOn() == true) {
+      f->GetObject("MagFieldArray", magFieldArray);
+      if (magFieldArray == NULL) {
+         cerr << "Error - Could not find: MagFieldArray in file " << fieldsFile << endl;
+         success = false;
+      } else if (magFieldArray->Initialise() == kFALSE ||
+          (runConfig.BakeFieldsOn() == true && magFieldArray->BakeFields(runConfig.BakeTolerance()) == kFALSE)) {
+         success = false;
+      }
+   }
+   if (success == true && runConfig.ElecFieldOn() == true) {
+      f->GetObject("ElecFieldArray", elecFieldArray);
+      if (elecFieldArray == NULL || elecFieldArray->Initialise() == kFALSE) {
+         cerr << "Error - Could not load: ElecFieldArray from file " << fieldsFile << endl;
+         success = false;
+      }
+   }
+   if (success == false) {
+      if (elecFieldArray) delete elecFieldArray;
+      if (magFieldArray) delete magFieldArray;
+      elecFieldArray = NULL;
+      magFieldArray = NULL;
+   }
+   // The fields read are owned by the caller, not the file
+   f->Close();
+   delete f;
+   return success;
+}
+
+//_____________________________________________________________________________
+double PolarisationDifference(const SpinData& replayed, const SpinData& tracked)
+{
+   // -- Largest difference between the two spins' polarisations along x, y or z, taking their
+   // -- measurements in order. Measurements beyond the end of the shorter are left out.
+   const TVector3 axes[3] = {TVector3(1.,0.,0.), TVector3(0.,1.,0.), TVector3(0.,0.,1.)};
+   double maxDifference = 0.;
+   SpinData::const_iterator replayedIter = replayed.begin(), trackedIter = tracked.begin();
+   for (; replayedIter != replayed.end() && trackedIter != tracked.end(); ++replayedIter, ++trackedIter) {
+      for (int axis = 0; axis < 3; axis++) {
+         // Polarisation along an axis is 2P(up) - 1
+         const double difference = 2.*TMath::Abs(replayedIter->second->CalculateProbSpinUp(axes[axis])
+                                                 - trackedIter->second->CalculateProbSpinUp(axes[axis]));
+         if (difference > maxDifference) maxDifference = difference;
+      }
+   }
+   return maxDifference;
+}
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <string>
+#include <vector>
+#include <stdexcept>
 #include "TBenchmark.h"
 
 #include "ConfigFile.h"
@@ -12,8 +14,11 @@ using std::cout;
 using std::endl;
 using std::cerr;
 using std::string;
+using std::vector;
 
-bool PerformSimulation(const ConfigFile& configFile, const int runNumber);
+bool PerformSimulation(const ConfigFile& configFile, const int runNumber, const bool resume,
+                       const string& shardOption, const string& shardSpec);
+bool SelectShard(RunConfig& runConfig, const string& shardOption, const string& shardSpec);
 
 //__________________________________________________________________________
 Int_t main(Int_t argc, Char_t **argv)
@@ -26,17 +31,33 @@ Int_t main(Int_t argc, Char_t **argv)
    ///////////////////////////////////////////////////////////////////////////////////////
    // Build the ConfigFile
    ///////////////////////////////////////////////////////////////////////////////////////
+   // -- '--resume' may be given anywhere, to carry on from the run's last checkpoint
+   // -- '--shard k/n' or '--range first:last' propagate only part of the selected particles
+   bool resume = false;
+   string shardOption, shardSpec;
+   vector<string> args;
+   for (int i = 1; i < argc; i++) {
+      const string arg = argv[i];
+      if (arg == "--resume") {
+         resume = true;
+      } else if ((arg == "--shard" || arg == "--range") && i + 1 < argc) {
+         shardOption = arg;
+         shardSpec = argv[++i];
+      } else {
+         args.push_back(arg);
+      }
+   }
    string configFileName;
    string suppliedRun = "";
-   if (argc == 2) {
-      configFileName = argv[1];
+   if (args.size() == 1) {
+      configFileName = args[0];
       suppliedRun = "1";
-   } else if (argc == 3) {
-      configFileName = argv[1];
-      suppliedRun = argv[2];
+   } else if (args.size() == 2) {
+      configFileName = args[0];
+      suppliedRun = args[1];
    } else {
       cerr << "Error: No configuration file has been specified." << endl;
-      cerr << "Usage, ucnsim <configFile.cfg> <run no.>" << endl;
+      cerr << "Usage, ucnsim <configFile.cfg> <run no.> [--resume] [--shard k/n | --range first:last]" << endl;
       return EXIT_FAILURE;
    }
    cout << "-------------------------------------------" << endl;
@@ -61,7 +82,7 @@ Int_t main(Int_t argc, Char_t **argv)
    }
    ///////////////////////////////////////////////////////////////////////////////////////
    // -- Create the Runs
-   if (PerformSimulation(configFile, specifiedRunNumber) == false) {
+   if (PerformSimulation(configFile, specifiedRunNumber, resume, shardOption, shardSpec) == false) {
       return EXIT_FAILURE;
    }
    ///////////////////////////////////////////////////////////////////////////////////////
@@ -74,20 +95,25 @@ Int_t main(Int_t argc, Char_t **argv)
 }
 
 //__________________________________________________________________________
-bool PerformSimulation(const ConfigFile& configFile, const int runNumber)
+bool PerformSimulation(const ConfigFile& configFile, const int runNumber, const bool resume,
+                       const string& shardOption, const string& shardSpec)
 {
    // -- Perform a simulation for the given run number
    // Read in the Run Configuration
    cout << "-------------------------------------------" << endl;
    cout << "Reading in Run Configuration " << runNumber << endl;
    RunConfig runConfig(configFile, runNumber);
+   if (shardOption.empty() == false && SelectShard(runConfig, shardOption, shardSpec) == false) {
+      cerr << "Invalid " << shardOption << " specified: " << shardSpec << endl;
+      return false;
+   }
    // Create the Run
    cout << "Creating Run" << endl;
    Run run(runConfig);
    ///////////////////////////////////////////////////////////////////////////////////////
    // -- Initialise Run
    ///////////////////////////////////////////////////////////////////////////////////////
-   if (!(run.Initialise())) {
+   if (!(run.Initialise(resume))) {
       cerr << "Run" << runNumber << " failed to initialise successfully." << endl;
       return false;
    }
@@ -109,3 +135,27 @@ bool PerformSimulation(const ConfigFile& configFile, const int runNumber)
    cout << "-------------------------------------------" << endl;
    return true;
 }
+
+//__________________________________________________________________________
+bool SelectShard(RunConfig& runConfig, const string& shardOption, const string& shardSpec)
+{
+   // -- Restrict the run to one shard of its selected particles. '--shard k/n' takes the kth
+   // -- of n equal blocks, counting from 1. '--range first:last' takes the particles at
+   // -- positions first to last-1 of the selected listing.
+   const char separator = (shardOption == "--shard" ? '/' : ':');
+   const size_t split = shardSpec.find(separator);
+   if (split == string::npos) return false;
+   int first = 0, second = 0;
+   if (Algorithms::String::ConvertToInt(shardSpec.substr(0, split), first) == false) return false;
+   if (Algorithms::String::ConvertToInt(shardSpec.substr(split + 1), second) == false) return false;
+   try {
+      if (shardOption == "--shard") {
+         runConfig.SelectShard(first, second);
+      } else {
+         runConfig.SelectParticleRange(first, second);
+      }
+   } catch (std::runtime_error&) {
+      return false;
+   }
+   return true;
+}
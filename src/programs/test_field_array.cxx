@@ -0,0 +1,159 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "ConfigFile.h"
+#include "RunConfig.h"
+#include "FieldManager.h"
+#include "MagFieldArray.h"
+#include "UniformMagField.h"
+#include "Box.h"
+#include "Point.h"
+
+#include "TFile.h"
+#include "TGeoMatrix.h"
+#include "TVector3.h"
+
+#include "Units.h"
+#include "DataAnalysis.h"
+
+using namespace std;
+
+//#define VERBOSE
+
+Bool_t BuildFields(const string& fileName);
+Bool_t WriteConfigFiles(const string& folder);
+int CheckFields(const string& batchFileName, const int runNumber, const Bool_t summed);
+int CheckPoint(const FieldManager& fieldManager, const TVector3& position, const TVector3& expected);
+
+namespace {
+   const string kFolder = "temp/test_field_array/";
+   // -- Two unit boxes of uniform field, the second moved 1m along x, so that they overlap
+   // -- between x = 0 and x = 1
+   const TVector3 kFieldA(1.0*Units::uT, 0., 0.);
+   const TVector3 kFieldB(0., 2.0*Units::uT, 0.);
+   const Double_t kOffsetB = 1.0*Units::m;
+}
+
+//______________________________________________________________________________
+int main(int /*argc*/, char ** /*argv*/) {
+   // -- Load two overlapping fields through the FieldManager, as a run would, and check the
+   // -- field seen in and around their overlap, both with and without SumOverlappingFields
+   mkdir("temp", 0755);
+   mkdir(kFolder.c_str(), 0755);
+   if (BuildFields(kFolder + "fields.root") == kFALSE) return 1;
+   if (WriteConfigFiles(kFolder) == kFALSE) return 1;
+   const string batchFileName = kFolder + "batch.cfg";
+   int failures = 0;
+   cout << "--------------------" << endl;
+   cout << "First field holding the point" << endl;
+   failures += CheckFields(batchFileName, 1, kFALSE);
+   cout << "--------------------" << endl;
+   cout << "Sum of the fields holding the point" << endl;
+   failures += CheckFields(batchFileName, 2, kTRUE);
+   cout << "--------------------" << endl;
+   cout << "Failures: " << failures << endl;
+   return (failures == 0 ? 0 : 1);
+}
+
+//______________________________________________________________________________
+Bool_t BuildFields(const string& fileName) {
+   // -- Write the two fields to file in a MagFieldArray. Field 'A' comes first by name.
+   TFile* file = Analysis::DataFile::OpenRootFile(fileName, "RECREATE");
+   if (file == NULL) return kFALSE;
+   MagFieldArray magFieldArray;
+   Box* shapeA = new Box("FieldShapeA", 1.0*Units::m, 1.0*Units::m, 1.0*Units::m);
+   Box* shapeB = new Box("FieldShapeB", 1.0*Units::m, 1.0*Units::m, 1.0*Units::m);
+   TGeoMatrix* matrixA = new TGeoTranslation(0., 0., 0.);
+   TGeoMatrix* matrixB = new TGeoTranslation(kOffsetB, 0., 0.);
+   magFieldArray.AddField(new UniformMagField("A", kFieldA, shapeA, matrixA));
+   magFieldArray.AddField(new UniformMagField("B", kFieldB, shapeB, matrixB));
+   magFieldArray.Write(magFieldArray.GetName());
+   file->Close();
+   delete file;
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t WriteConfigFiles(const string& folder) {
+   // -- A run configuration with only magnetic fields on, and a second run that sums them
+   ofstream run((folder + "run.cfg").c_str());
+   run << "[Name]" << endl;
+   run << "   RunName = TestFieldArray" << endl;
+   run << "[Files]" << endl;
+   run << "   GeomFile = geometry.root" << endl;
+   run << "   InputDataFile = particles.root" << endl;
+   run << "   OutputDataFile = data.root" << endl;
+   run << "   FieldsFile = fields.root" << endl;
+   run << "[Particles]" << endl;
+   run << "   InputParticleState = initial" << endl;
+   run << "   AllParticles = YES" << endl;
+   run << "   RunFromBeginning = YES" << endl;
+   run << "[Properties]" << endl;
+   run << "   GravField = OFF" << endl;
+   run << "   WallLosses = OFF" << endl;
+   run << "   BetaDecay = OFF" << endl;
+   run << "   MagFields = ON" << endl;
+   run << "   ElecFields = OFF" << endl;
+   run << "   SumOverlappingFields = NO" << endl;
+   run << "   RunTime(s) = 1.0" << endl;
+   run << "   MaxStepTime(s) = 0.01" << endl;
+   run << "   SpinStepTime(s) = 0.001" << endl;
+   run << "[Observables]" << endl;
+   run << "   RecordSpin = NO" << endl;
+   run << "   RecordField = NO" << endl;
+   run << "   RecordPopulation = NO" << endl;
+   run.close();
+   ofstream batch((folder + "batch.cfg").c_str());
+   batch << "[Folder]" << endl;
+   batch << "   Path = " << folder << endl;
+   batch << "[Runs]" << endl;
+   batch << "   NumberOfRuns = 2" << endl;
+   batch << "[Run1]" << endl;
+   batch << "   Config = run.cfg" << endl;
+   batch << "[Run2]" << endl;
+   batch << "   Config = run.cfg" << endl;
+   batch << "   SumOverlappingFields = YES" << endl;
+   batch.close();
+   return (run.fail() == false && batch.fail() == false);
+}
+
+//______________________________________________________________________________
+int CheckFields(const string& batchFileName, const int runNumber, const Bool_t summed) {
+   // -- Check the field inside each box alone, in their overlap, and outside both
+   ConfigFile configFile(batchFileName);
+   RunConfig runConfig(configFile, runNumber);
+   FieldManager fieldManager;
+   if (fieldManager.Initialise(runConfig) == kFALSE) {
+      cout << "Failed to initialise the fields" << endl;
+      return 1;
+   }
+   int failures = 0;
+   failures += CheckPoint(fieldManager, TVector3(-0.5*Units::m, 0., 0.), kFieldA);
+   failures += CheckPoint(fieldManager, TVector3(1.5*Units::m, 0., 0.), kFieldB);
+   failures += CheckPoint(fieldManager, TVector3(0.5*Units::m, 0.2*Units::m, -0.3*Units::m),
+                          (summed == kTRUE ? kFieldA + kFieldB : kFieldA));
+   failures += CheckPoint(fieldManager, TVector3(3.0*Units::m, 0., 0.), TVector3(0., 0., 0.));
+   cout << "Points checked: 4. Failures: " << failures << endl;
+   return failures;
+}
+
+//______________________________________________________________________________
+int CheckPoint(const FieldManager& fieldManager, const TVector3& position, const TVector3& expected) {
+   // -- Whether the field at the position differs from that expected
+   const TVector3 field = fieldManager.GetMagField(Point(position, 0.), TVector3(0., 0., 0.));
+   #ifdef VERBOSE
+      cout << "Point: (" << position.X() << ", " << position.Y() << ", " << position.Z() << ")\t";
+      cout << "Field: (" << field.X() << ", " << field.Y() << ", " << field.Z() << ")" << endl;
+   #endif
+   if ((field - expected).Mag() > 1.E-9*expected.Mag()) {
+      cout << "Field at (" << position.X() << ", " << position.Y() << ", " << position.Z() << ") is (";
+      cout << field.X() << ", " << field.Y() << ", " << field.Z() << "), expected (";
+      cout << expected.X() << ", " << expected.Y() << ", " << expected.Z() << ")" << endl;
+      return 1;
+   }
+   return 0;
+}
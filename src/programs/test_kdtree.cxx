@@ -9,6 +9,8 @@
 #include <cassert>
 
 #include "KDTree.h"
+#include "FlatKDTree.h"
+#include "NeighbourHeap.h"
 #include "KDTreeNode.h"
 #include "FieldVertex.h"
 #include "VertexStack.h"
@@ -20,6 +22,7 @@ using namespace std;
 //#define VERBOSE
 
 void BenchMark(const int numPoints, const int repetitions, const int numNeighbours, ostream& out); 
+void FlatBenchMark(const int numPoints, const int repetitions, const int numNeighbours, ostream& out);
 VertexStack* BruteForceNearestNeighbours(const vector<const FieldVertex*>& pointList, const FieldVertex& point, const int nearestNeighbours);
 void InternetExample1(vector<const FieldVertex*>& points);
 
@@ -39,6 +42,18 @@ int main(int /*argc*/, char ** /*argv*/) {
    BenchMark(100000, repetitions, numNeighbours, out);
    BenchMark(1000000, repetitions, numNeighbours, out);
 //   BenchMark(10000000, repetitions, numNeighbours, out);
+   // Compare the pointer-based tree with the flat, bucketed tree
+   ofstream flatOut("temp/flat_benchmark_data.txt");
+   flatOut << "Num Points" << "\t" << "Tree Build Time" << "\t" << "Flat Tree Build Time" << "\t";
+   flatOut << "Tree Search Time" << "\t" << "Flat Tree Search Time" << "\t";
+   flatOut << "Average Nodes Visited" << "\t" << "Average Flat Tree Points Examined" << endl;
+   const int flatRepetitions = 10000;
+   FlatBenchMark(10, flatRepetitions, numNeighbours, flatOut);
+   FlatBenchMark(100, flatRepetitions, numNeighbours, flatOut);
+   FlatBenchMark(1000, flatRepetitions, numNeighbours, flatOut);
+   FlatBenchMark(10000, flatRepetitions, numNeighbours, flatOut);
+   FlatBenchMark(100000, flatRepetitions, numNeighbours, flatOut);
+   FlatBenchMark(1000000, flatRepetitions, numNeighbours, flatOut);
    return 0;
 }
 
@@ -198,6 +213,105 @@ void BenchMark(const int numPoints, const int repetitions, const int numNeighbou
    return;
 }
 
+//______________________________________________________________________________
+void FlatBenchMark(const int numPoints, const int repetitions, const int numNeighbours, ostream& out) {
+   // -- Benchmark builds 'numPoints' random points, and compares the time taken to build and
+   // -- search the pointer-based KDTree with that of the FlatKDTree. Single searches are too quick
+   // -- to time with clock(), so each tree's searches are timed together over the same set of
+   // -- random search points. Every search is checked against the other tree.
+   vector<const FieldVertex*> points;
+   for (int i=0; i<numPoints; i++) {
+      points.push_back(new FieldVertex(gRandom->Rndm(),gRandom->Rndm(),gRandom->Rndm(),0,0,0,0));
+   }
+   vector<FieldVertex> searchPoints;
+   for (int iter = 0; iter < repetitions; iter++) {
+      searchPoints.push_back(FieldVertex(gRandom->Rndm(),gRandom->Rndm(),gRandom->Rndm(),0,0,0,0));
+   }
+   //-----------------------------------------------------------
+   // -- Build Trees. The flat tree copies the points, so build it before KDTree takes ownership
+   clock_t start, end;
+   start = clock();
+   FlatKDTree flatTree(points);
+   end = clock();
+   const double flatTreeBuildTime = (double)(end-start)/CLOCKS_PER_SEC;
+   start = clock();
+   KDTree tree(points);
+   end = clock();
+   const double treeBuildTime = (double)(end-start)/CLOCKS_PER_SEC;
+   cout << "--------------------" << endl;
+   cout << "Number of points in Tree: " << numPoints << endl;
+   cout << "Time required to build Tree: " << treeBuildTime << " seconds." << endl;
+   cout << "Time required to build Flat Tree: " << flatTreeBuildTime << " seconds." << endl;
+   //-----------------------------------------------------------
+   // -- Search pointer-based tree, keeping the distances found for comparison
+   vector<double> treeDistances;
+   double totVisited = 0.;
+   start = clock();
+   for (int iter = 0; iter < repetitions; iter++) {
+      const VertexStack* treeList = tree.NearestNeighbours(searchPoints[iter], numNeighbours);
+      totVisited += tree.GetVisited();
+      list<StackElement>::const_iterator stackIter;
+      for (stackIter = treeList->begin(); stackIter != treeList->end(); stackIter++) {
+         treeDistances.push_back(stackIter->second);
+      }
+      delete treeList;
+   }
+   end = clock();
+   const double treeSearchTime = (double)(end-start)/CLOCKS_PER_SEC;
+   //-----------------------------------------------------------
+   // -- Search flat tree
+   vector<double> flatDistances;
+   NeighbourHeap neighbours(numNeighbours);
+   double totExamined = 0.;
+   start = clock();
+   for (int iter = 0; iter < repetitions; iter++) {
+      const double point[3] = {searchPoints[iter].X(), searchPoints[iter].Y(), searchPoints[iter].Z()};
+      totExamined += flatTree.NearestNeighbours(point, neighbours);
+      neighbours.Sort();
+      for (int i = 0; i < neighbours.Size(); i++) {
+         flatDistances.push_back(sqrt(neighbours.SquaredDistance(i)));
+      }
+   }
+   end = clock();
+   const double flatTreeSearchTime = (double)(end-start)/CLOCKS_PER_SEC;
+   //-----------------------------------------------------------
+   // -- Both trees must find the same neighbours, in the same order
+   assert(treeDistances.size() == flatDistances.size());
+   for (size_t i = 0; i < treeDistances.size(); i++) {
+      assert(fabs(treeDistances[i] - flatDistances[i]) <= 1.0E-12);
+   }
+   //-----------------------------------------------------------
+   // -- Searches along a short random walk, each started from the leaf of the one before, must
+   // -- find the same neighbours as searches from the root
+   NeighbourHeap hinted(numNeighbours);
+   int leaf = -1, hintsSufficed = 0;
+   double walk[3] = {0.5, 0.5, 0.5};
+   for (int iter = 0; iter < repetitions; iter++) {
+      for (int axis = 0; axis < 3; axis++) {walk[axis] += 0.01*(gRandom->Rndm() - 0.5);}
+      bool hintSufficed = false;
+      flatTree.NearestNeighbours(walk, hinted, leaf, hintSufficed);
+      flatTree.NearestNeighbours(walk, neighbours);
+      if (hintSufficed) hintsSufficed++;
+      hinted.Sort();
+      neighbours.Sort();
+      assert(hinted.Size() == neighbours.Size());
+      for (int i = 0; i < neighbours.Size(); i++) {
+         assert(hinted.SquaredDistance(i) == neighbours.SquaredDistance(i));
+      }
+   }
+   cout << "Walk searches kept below the root by the leaf hint: " << hintsSufficed << " of " << repetitions << endl;
+   const double avgTreeSearchTime = treeSearchTime/((double)repetitions);
+   const double avgFlatTreeSearchTime = flatTreeSearchTime/((double)repetitions);
+   const double avgVisited = totVisited/((double)repetitions);
+   const double avgExamined = totExamined/((double)repetitions);
+   cout << "Average Time required for Tree search: " << avgTreeSearchTime << " seconds." << endl;
+   cout << "Average Time required for Flat Tree search: " << avgFlatTreeSearchTime << " seconds." << endl;
+   out << numPoints << "\t" << treeBuildTime << "\t" << flatTreeBuildTime << "\t";
+   out << avgTreeSearchTime << "\t" << avgFlatTreeSearchTime << "\t";
+   out << avgVisited << "\t" << avgExamined << endl;
+   return;
+}
+
 //______________________________________________________________________________
 VertexStack* BruteForceNearestNeighbours(const vector<const FieldVertex*>& pointList, const FieldVertex& point, const int nearestNeighbours)
 {
@@ -0,0 +1,283 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <time.h>
+#include <cassert>
+
+#include "Polynomial.h"
+
+#include "TRandom.h"
+
+using namespace std;
+
+//#define VERBOSE
+
+void RandomQuartic(Double_t* params);
+void TubeQuartic(Double_t* params);
+int AccuracyTest(const int numQuartics, void (*generator)(Double_t*), const double tolerance);
+void BenchMark(const int numQuartics, const int repetitions, void (*generator)(Double_t*));
+int BoundedSearchTest(const int numQuartics, void (*generator)(Double_t*), const double maxInterval, const double tolerance);
+void BoundedBenchMark(const int numQuartics, const int repetitions, void (*generator)(Double_t*), const double interval);
+
+//______________________________________________________________________________
+int main(int /*argc*/, char ** /*argv*/) {
+   // -- Compare the closed-form quartic solver against GSL's general complex solver,
+   // -- which it replaced, then time the two of them. Then check the search for the first
+   // -- root in an interval against the closed-form solver, and time it.
+   // Near-repeated roots are only found to ~sqrt(machine epsilon) by either solver, and whether
+   // they count as real depends on the sign of a rounding error, so allow for a handful of them
+   const double tolerance = 1.E-6;
+   const int allowedFailures = 20;
+   int failures = 0;
+   cout << "--------------------" << endl;
+   cout << "Accuracy - Random coefficients" << endl;
+   failures += AccuracyTest(1000000, RandomQuartic, tolerance);
+   cout << "--------------------" << endl;
+   cout << "Accuracy - Parabola intersecting a tilted tube" << endl;
+   failures += AccuracyTest(1000000, TubeQuartic, tolerance);
+   cout << "--------------------" << endl;
+   cout << "Benchmark - Random coefficients" << endl;
+   BenchMark(10000, 100, RandomQuartic);
+   cout << "--------------------" << endl;
+   cout << "Benchmark - Parabola intersecting a tilted tube" << endl;
+   BenchMark(10000, 100, TubeQuartic);
+   cout << "--------------------" << endl;
+   cout << "Bounded search - Random coefficients" << endl;
+   failures += BoundedSearchTest(1000000, RandomQuartic, 3.0, tolerance);
+   cout << "--------------------" << endl;
+   cout << "Bounded search - Parabola intersecting a tilted tube" << endl;
+   failures += BoundedSearchTest(1000000, TubeQuartic, 0.2, tolerance);
+   cout << "--------------------" << endl;
+   cout << "Bounded benchmark - Tube, boundary mostly out of reach of a 10ms step" << endl;
+   BoundedBenchMark(10000, 100, TubeQuartic, 0.01);
+   cout << "--------------------" << endl;
+   cout << "Bounded benchmark - Tube, boundary mostly within reach of a 200ms step" << endl;
+   BoundedBenchMark(10000, 100, TubeQuartic, 0.2);
+   cout << "--------------------" << endl;
+   if (failures > allowedFailures) {
+      cout << "FAILED: " << failures << " quartics disagree between solvers" << endl;
+      return 1;
+   }
+   cout << "PASSED: " << failures << " quartics disagree between solvers" << endl;
+   return 0;
+}
+
+//______________________________________________________________________________
+void RandomQuartic(Double_t* params)
+{
+   // -- Quartic with coefficients drawn uniformly from [-10,10]
+   for (int i = 0; i < 5; i++) {params[i] = gRandom->Uniform(-10.0, 10.0);}
+}
+
+//______________________________________________________________________________
+void TubeQuartic(Double_t* params)
+{
+   // -- Quartic met in Tube::InsideTimeToRBoundary, for a particle inside a tube of radius
+   // -- 0.25m, tilted so that gravity has a component across it
+   const Double_t field[2] = {gRandom->Uniform(-3.0, 3.0), gRandom->Uniform(-3.0, 3.0)};
+   const Double_t point[2] = {gRandom->Uniform(-0.17, 0.17), gRandom->Uniform(-0.17, 0.17)};
+   const Double_t velocity[2] = {gRandom->Uniform(-7.0, 7.0), gRandom->Uniform(-7.0, 7.0)};
+   const Double_t rBoundary = 0.25;
+   params[0] = 0.25*(field[0]*field[0] + field[1]*field[1]);
+   params[1] = velocity[0]*field[0] + velocity[1]*field[1];
+   params[2] = point[0]*field[0] + point[1]*field[1] + velocity[0]*velocity[0] + velocity[1]*velocity[1];
+   params[3] = 2.0*(point[0]*velocity[0] + point[1]*velocity[1]);
+   params[4] = point[0]*point[0] + point[1]*point[1] - rBoundary*rBoundary;
+}
+
+//______________________________________________________________________________
+int AccuracyTest(const int numQuartics, void (*generator)(Double_t*), const double tolerance)
+{
+   // -- Solve 'numQuartics' quartics with both solvers, and count those for which the two
+   // -- disagree on the number of real roots, or on any root beyond 'tolerance' (relative
+   // -- to the size of the root, or absolute for roots smaller than one)
+   Polynomial* polynomial = Polynomial::Instance();
+   int countMismatches = 0;
+   int rootMismatches = 0;
+   double maxDifference = 0.;
+   for (int iter = 0; iter < numQuartics; iter++) {
+      Double_t params[5];
+      generator(params);
+      Double_t roots[4] = {0.,0.,0.,0.};
+      Double_t gslRoots[4] = {0.,0.,0.,0.};
+      const int solutions = polynomial->QuarticRootFinder(params, roots);
+      const int gslSolutions = polynomial->ComplexQuarticRootFinder(params, gslRoots);
+      if (solutions != gslSolutions) {
+         countMismatches++;
+         #ifdef VERBOSE
+            cout << "Number of roots differs - Closed-form: " << solutions << "\t GSL: " << gslSolutions << endl;
+         #endif
+         continue;
+      }
+      sort(roots, roots + solutions);
+      sort(gslRoots, gslRoots + gslSolutions);
+      bool agree = true;
+      for (int i = 0; i < solutions; i++) {
+         const double difference = fabs(roots[i] - gslRoots[i])/max(1.0, fabs(gslRoots[i]));
+         maxDifference = max(maxDifference, difference);
+         if (difference > tolerance) agree = false;
+      }
+      if (agree == false) {
+         rootMismatches++;
+         #ifdef VERBOSE
+            cout << setprecision(17) << "Roots differ - a: " << params[0] << "  b: " << params[1];
+            cout << "  c: " << params[2] << "  d: " << params[3] << "  e: " << params[4] << endl;
+         #endif
+      }
+   }
+   cout << "Quartics solved: " << numQuartics << endl;
+   cout << "Number of real roots differs: " << countMismatches << endl;
+   cout << "Roots differ by more than " << tolerance << ": " << rootMismatches << endl;
+   cout << "Largest difference: " << maxDifference << endl;
+   return countMismatches + rootMismatches;
+}
+
+//______________________________________________________________________________
+void BenchMark(const int numQuartics, const int repetitions, void (*generator)(Double_t*))
+{
+   // -- Time how long each solver takes to solve the same set of quartics
+   vector<Double_t> params(5*numQuartics);
+   for (int iter = 0; iter < numQuartics; iter++) {generator(&params[5*iter]);}
+   Polynomial* polynomial = Polynomial::Instance();
+   Double_t roots[4];
+   int totalRoots = 0;
+   clock_t start, end;
+   // Closed-form solver
+   start = clock();
+   for (int rep = 0; rep < repetitions; rep++) {
+      for (int iter = 0; iter < numQuartics; iter++) {
+         totalRoots += polynomial->QuarticRootFinder(&params[5*iter], roots);
+      }
+   }
+   end = clock();
+   const double closedFormTime = (double)(end-start)/CLOCKS_PER_SEC;
+   // GSL's complex solver
+   start = clock();
+   for (int rep = 0; rep < repetitions; rep++) {
+      for (int iter = 0; iter < numQuartics; iter++) {
+         totalRoots -= polynomial->ComplexQuarticRootFinder(&params[5*iter], roots);
+      }
+   }
+   end = clock();
+   const double gslTime = (double)(end-start)/CLOCKS_PER_SEC;
+   const double calls = (double)numQuartics*repetitions;
+   cout << "Quartics solved: " << calls << endl;
+   cout << "Closed-form solver: " << 1.E9*closedFormTime/calls << " ns per call" << endl;
+   cout << "GSL complex solver: " << 1.E9*gslTime/calls << " ns per call" << endl;
+   cout << "Speed-up: " << (closedFormTime > 0. ? gslTime/closedFormTime : 0.) << endl;
+   // Keep the compiler from discarding the loops
+   if (totalRoots != 0) cout << "(Difference in total roots found: " << totalRoots << ")" << endl;
+}
+
+//______________________________________________________________________________
+int BoundedSearchTest(const int numQuartics, void (*generator)(Double_t*), const double maxInterval, const double tolerance)
+{
+   // -- Look for the first root in a random interval (0, tmax] with the bounded search, and
+   // -- count the quartics for which it disagrees with the smallest root in that interval found
+   // -- by the closed-form solver. Quartics with roots too close to the ends of the interval, or
+   // -- to each other, for the two to be expected to agree on whether they count, are skipped.
+   Polynomial* polynomial = Polynomial::Instance();
+   int presenceMismatches = 0;
+   int rootMismatches = 0;
+   int skipped = 0;
+   double maxDifference = 0.;
+   for (int iter = 0; iter < numQuartics; iter++) {
+      Double_t params[5];
+      generator(params);
+      const Double_t tmax = gRandom->Uniform(0.0, maxInterval);
+      Double_t roots[4] = {0.,0.,0.,0.};
+      const int solutions = polynomial->QuarticRootFinder(params, roots);
+      bool ambiguous = false;
+      Double_t expected = -1.0;
+      for (int i = 0; i < solutions; i++) {
+         if (fabs(roots[i]) < 1.E-7 || fabs(roots[i] - tmax) < 1.E-7) ambiguous = true;
+         for (int j = i+1; j < solutions; j++) {
+            if (fabs(roots[i] - roots[j]) < 1.E-6) ambiguous = true;
+         }
+         if (roots[i] > 0.0 && roots[i] <= tmax && (expected < 0.0 || roots[i] < expected)) {
+            expected = roots[i];
+         }
+      }
+      if (ambiguous) {
+         skipped++;
+         continue;
+      }
+      Double_t root = -1.0;
+      const bool found = polynomial->FirstRootInInterval(params, 4, 0.0, tmax, root);
+      const bool reachable = polynomial->HasRootInInterval(params, 4, 0.0, tmax);
+      if (found != (expected > 0.0) || reachable != found) {
+         presenceMismatches++;
+         #ifdef VERBOSE
+            cout << setprecision(17) << "Presence of root differs - tmax: " << tmax << "  a: " << params[0];
+            cout << "  b: " << params[1] << "  c: " << params[2] << "  d: " << params[3] << "  e: " << params[4] << endl;
+         #endif
+         continue;
+      }
+      if (found) {
+         const double difference = fabs(root - expected)/max(1.0, expected);
+         maxDifference = max(maxDifference, difference);
+         if (difference > tolerance) rootMismatches++;
+      }
+   }
+   cout << "Quartics searched: " << numQuartics << " (skipped " << skipped << ")" << endl;
+   cout << "Presence of a root differs: " << presenceMismatches << endl;
+   cout << "Roots differ by more than " << tolerance << ": " << rootMismatches << endl;
+   cout << "Largest difference: " << maxDifference << endl;
+   return presenceMismatches + rootMismatches;
+}
+
+//______________________________________________________________________________
+void BoundedBenchMark(const int numQuartics, const int repetitions, void (*generator)(Double_t*), const double interval)
+{
+   // -- Time how long it takes to decide whether a quartic has a root in (0, interval], by
+   // -- solving it fully and scanning the roots, and by the bounded search
+   vector<Double_t> params(5*numQuartics);
+   for (int iter = 0; iter < numQuartics; iter++) {generator(&params[5*iter]);}
+   Polynomial* polynomial = Polynomial::Instance();
+   Double_t roots[4];
+   int solvedHits = 0, searchedHits = 0, firstHits = 0;
+   clock_t start, end;
+   // Closed-form solver, then pick out any root in the interval
+   start = clock();
+   for (int rep = 0; rep < repetitions; rep++) {
+      for (int iter = 0; iter < numQuartics; iter++) {
+         const int solutions = polynomial->QuarticRootFinder(&params[5*iter], roots);
+         for (int i = 0; i < solutions; i++) {
+            if (roots[i] > 0.0 && roots[i] <= interval) {solvedHits++; break;}
+         }
+      }
+   }
+   end = clock();
+   const double solveTime = (double)(end-start)/CLOCKS_PER_SEC;
+   // Bounded search, only asking whether there is a root
+   start = clock();
+   for (int rep = 0; rep < repetitions; rep++) {
+      for (int iter = 0; iter < numQuartics; iter++) {
+         if (polynomial->HasRootInInterval(&params[5*iter], 4, 0.0, interval)) searchedHits++;
+      }
+   }
+   end = clock();
+   const double searchTime = (double)(end-start)/CLOCKS_PER_SEC;
+   // Bounded search, finding the first root
+   start = clock();
+   for (int rep = 0; rep < repetitions; rep++) {
+      for (int iter = 0; iter < numQuartics; iter++) {
+         Double_t root;
+         if (polynomial->FirstRootInInterval(&params[5*iter], 4, 0.0, interval, root)) firstHits++;
+      }
+   }
+   end = clock();
+   const double firstTime = (double)(end-start)/CLOCKS_PER_SEC;
+   const double calls = (double)numQuartics*repetitions;
+   cout << "Quartics searched: " << calls << ", with a root in reach: " << solvedHits/calls << endl;
+   cout << "Closed-form solver and scan: " << 1.E9*solveTime/calls << " ns per call" << endl;
+   cout << "HasRootInInterval: " << 1.E9*searchTime/calls << " ns per call" << endl;
+   cout << "FirstRootInInterval: " << 1.E9*firstTime/calls << " ns per call" << endl;
+   // Keep the compiler from discarding the loops
+   if (searchedHits != solvedHits || firstHits != solvedHits) {
+      cout << "(Quartics with a root in reach - Solved: " << solvedHits << "  HasRoot: " << searchedHits;
+      cout << "  FirstRoot: " << firstHits << ")" << endl;
+   }
+}
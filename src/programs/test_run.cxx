@@ -0,0 +1,346 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ConfigFile.h"
+#include "RunConfig.h"
+#include "Run.h"
+#include "Particle.h"
+#include "Box.h"
+#include "Volume.h"
+#include "UniformMagField.h"
+#include "MagFieldArray.h"
+#include "ParticleManifest.h"
+#include "PopulationData.h"
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TGeoManager.h"
+#include "TGeoMatrix.h"
+#include "TRandom.h"
+#include "TMath.h"
+
+#include "Materials.h"
+#include "Units.h"
+#include "ValidStates.h"
+#include "DataAnalysis.h"
+
+using namespace std;
+
+//#define VERBOSE
+
+// -- The final state of one particle, as read back from an output file
+struct FinalState {
+   unsigned int fId;
+   string fState;
+   Double_t fX, fY, fZ, fT;
+   Double_t fVx, fVy, fVz;
+};
+
+bool operator==(const FinalState& a, const FinalState& b);
+bool CompareIds(const FinalState& a, const FinalState& b) {return a.fId < b.fId;}
+
+Bool_t BuildGeometry(const string& fileName);
+Bool_t BuildFields(const string& fileName);
+Bool_t GenerateParticles(const string& fileName, const int numParticles, const int numWritten);
+Bool_t WriteConfigFiles(const string& folder);
+Bool_t RunInChild(const string& batchFileName, const int runNumber, const Bool_t resume);
+Bool_t ReadOutput(const string& fileName, vector<FinalState>& states, PopulationData& population);
+int CompareOutput(const string& name, const string& referenceFileName, const string& fileName);
+
+namespace {
+   const string kFolder = "temp/test_run/";
+   const int kNumParticles = 25;
+   const int kCheckpointParticles = 10;
+   const int kInterruptAfter = 15;
+   const Double_t kChamberHalfLength = 0.25*Units::m;
+   const Double_t kWallThickness = 0.05*Units::m;
+}
+
+//______________________________________________________________________________
+int main(int /*argc*/, char ** /*argv*/) {
+   // -- Propagate the same particles through a small chamber serially, then on several worker
+   // -- threads with the output written on a thread of its own, then in a run interrupted
+   // -- after a checkpoint and resumed, and check that every run writes exactly the same
+   // -- particles.
+   mkdir("temp", 0755);
+   mkdir(kFolder.c_str(), 0755);
+   if (BuildGeometry(kFolder + "geometry.root") == kFALSE) return 1;
+   if (BuildFields(kFolder + "fields.root") == kFALSE) return 1;
+   if (GenerateParticles(kFolder + "particles.root", kNumParticles, kNumParticles) == kFALSE) return 1;
+   if (GenerateParticles(kFolder + "truncated.root", kNumParticles, kInterruptAfter) == kFALSE) return 1;
+   if (WriteConfigFiles(kFolder) == kFALSE) return 1;
+   const string batchFileName = kFolder + "batch.cfg";
+   int failures = 0;
+   //-----------------------------------------------------------
+   // -- Run 1 is serial, and writes its output on the propagating thread. Run 2 propagates on
+   // -- 4 threads, and writes its output on another.
+   if (RunInChild(batchFileName, 1, kFALSE) == kFALSE) {
+      cout << "Serial run failed" << endl;
+      return 1;
+   }
+   if (RunInChild(batchFileName, 2, kFALSE) == kFALSE) {
+      cout << "Threaded run failed" << endl;
+      failures++;
+   } else {
+      failures += CompareOutput("Threaded", kFolder + "serial.root", kFolder + "threads.root");
+   }
+   //-----------------------------------------------------------
+   // -- Run 3 reads its particles from a file whose tree stops short of its manifest, so it
+   // -- fails part way through, after its first checkpoint, and exits without closing its
+   // -- output. Run 4 resumes it from that checkpoint on 2 threads, with the whole file.
+   if (RunInChild(batchFileName, 3, kFALSE) == kTRUE) {
+      cout << "Interrupted run was not interrupted" << endl;
+      failures++;
+   } else if (RunInChild(batchFileName, 4, kTRUE) == kFALSE) {
+      cout << "Resumed run failed" << endl;
+      failures++;
+   } else {
+      failures += CompareOutput("Resumed", kFolder + "serial.root", kFolder + "resumed.root");
+   }
+   cout << "--------------------" << endl;
+   cout << "Failures: " << failures << endl;
+   return (failures == 0 ? 0 : 1);
+}
+
+//______________________________________________________________________________
+bool operator==(const FinalState& a, const FinalState& b) {
+   return a.fId == b.fId && a.fState == b.fState && a.fX == b.fX && a.fY == b.fY && a.fZ == b.fZ &&
+          a.fT == b.fT && a.fVx == b.fVx && a.fVy == b.fVy && a.fVz == b.fVz;
+}
+
+//______________________________________________________________________________
+Bool_t BuildGeometry(const string& fileName) {
+   // -- A box of beryllium walls around a vacuum chamber, inside a black hole
+   TGeoManager* geoManager = new TGeoManager("GeoManager","Geometry Manager");
+   Materials::BuildMaterials(geoManager);
+   TGeoMedium* vacuum = geoManager->GetMedium("Vacuum");
+   TGeoMedium* beryllium = geoManager->GetMedium("Beryllium");
+   const Double_t wallHalfLength = kChamberHalfLength + kWallThickness;
+   Box* topShape = new Box("Top", 2.0*wallHalfLength, 2.0*wallHalfLength, 2.0*wallHalfLength);
+   BlackHole* top = new BlackHole("Top", topShape, vacuum);
+   geoManager->SetTopVolume(top);
+   Box* wallShape = new Box("Walls", wallHalfLength, wallHalfLength, wallHalfLength);
+   Boundary* walls = new Boundary("Walls", wallShape, beryllium, 0.);
+   top->AddNode(walls, 1);
+   Box* chamberShape = new Box("Chamber", kChamberHalfLength, kChamberHalfLength, kChamberHalfLength);
+   TrackingVolume* chamber = new TrackingVolume("Chamber", chamberShape, vacuum);
+   walls->AddNode(chamber, 1);
+   geoManager->CloseGeometry();
+   return (geoManager->Export(fileName.c_str()) > 0);
+}
+
+//______________________________________________________________________________
+Bool_t BuildFields(const string& fileName) {
+   // -- A uniform field filling the chamber, so that the workers share field lookups
+   TFile* file = Analysis::DataFile::OpenRootFile(fileName, "RECREATE");
+   if (file == NULL) return kFALSE;
+   MagFieldArray magFieldArray;
+   Box* fieldShape = new Box("FieldShape", kChamberHalfLength, kChamberHalfLength, kChamberHalfLength);
+   TGeoMatrix* fieldMatrix = new TGeoTranslation(0., 0., 0.);
+   magFieldArray.AddField(new UniformMagField("Uniform", TVector3(0., 0., 1.0*Units::uT), fieldShape, fieldMatrix));
+   magFieldArray.Write(magFieldArray.GetName());
+   file->Close();
+   delete file;
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t GenerateParticles(const string& fileName, const int numParticles, const int numWritten) {
+   // -- Particles at random positions in the chamber, moving in random directions, polarised
+   // -- perpendicular to the field. The manifest lists all of them, but only the first
+   // -- 'numWritten' are written to the tree.
+   TFile* file = Analysis::DataFile::OpenRootFile(fileName, "RECREATE");
+   if (file == NULL) return kFALSE;
+   TTree tree("Particles","Tree of Particle Data");
+   Particle* particle = new Particle(0, Point(), TVector3());
+   TBranch* initialBranch = tree.Branch(States::initial.c_str(), particle->ClassName(), &particle);
+   ParticleManifest manifest;
+   gRandom->SetSeed(4357);
+   const Double_t maxPosition = 0.8*kChamberHalfLength;
+   const Double_t maxVelocity = 4.0*Units::m/Units::s;
+   for (Int_t id = 1; id <= numParticles; id++) {
+      particle->SetId(id);
+      particle->SetPosition(gRandom->Uniform(-maxPosition, maxPosition), gRandom->Uniform(-maxPosition, maxPosition),
+                            gRandom->Uniform(-maxPosition, maxPosition), 0.);
+      Double_t vx, vy, vz;
+      gRandom->Sphere(vx, vy, vz, gRandom->Uniform(0.5*maxVelocity, maxVelocity));
+      particle->SetVelocity(vx, vy, vz);
+      particle->Polarise(TVector3(1., 0., 0.), kTRUE);
+      if (id <= numWritten) initialBranch->Fill();
+      manifest.AddEntry(States::initial, particle->Id(), id - 1);
+   }
+   manifest.Write();
+   tree.Write();
+   file->Close();
+   delete file;
+   delete particle;
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t WriteConfigFiles(const string& folder) {
+   // -- One run configuration, with each run of the batch overriding how it is propagated
+   ofstream run((folder + "run.cfg").c_str());
+   run << "[Name]" << endl;
+   run << "   RunName = TestRun" << endl;
+   run << "[Files]" << endl;
+   run << "   GeomFile = geometry.root" << endl;
+   run << "   GeomVisFile = " << endl;
+   run << "   InputDataFile = particles.root" << endl;
+   run << "   OutputDataFile = serial.root" << endl;
+   run << "   FieldsFile = fields.root" << endl;
+   run << "[Particles]" << endl;
+   run << "   InputParticleState = initial" << endl;
+   run << "   AllParticles = YES" << endl;
+   run << "   RunFromBeginning = YES" << endl;
+   run << "[Properties]" << endl;
+   run << "   GravField = ON" << endl;
+   run << "   WallLosses = ON" << endl;
+   run << "   BetaDecay = OFF" << endl;
+   run << "   MagFields = ON" << endl;
+   run << "   ElecFields = OFF" << endl;
+   run << "   RunTime(s) = 2.0" << endl;
+   run << "   MaxStepTime(s) = 0.01" << endl;
+   run << "   SpinStepTime(s) = 0.001" << endl;
+   run << "   Threads = 1" << endl;
+   run << "   OutputQueueSize = 0" << endl;
+   run << "   CheckpointParticles = 0" << endl;
+   run << "   RandomSeed = 4357" << endl;
+   run << "[Observables]" << endl;
+   run << "   RecordBounces = YES" << endl;
+   run << "   RecordTracks = YES" << endl;
+   run << "   TrackMeasureFrequency(Hz) = 10" << endl;
+   run << "   RecordSpin = YES" << endl;
+   run << "   SpinMeasureFrequency(Hz) = 10" << endl;
+   run << "   RecordField = NO" << endl;
+   run << "   RecordPopulation = YES" << endl;
+   run << "   PopulationMeasureFrequency(Hz) = 10" << endl;
+   run.close();
+   ofstream batch((folder + "batch.cfg").c_str());
+   batch << "[Folder]" << endl;
+   batch << "   Path = " << folder << endl;
+   batch << "[Runs]" << endl;
+   batch << "   NumberOfRuns = 4" << endl;
+   batch << "[Run1]" << endl;
+   batch << "   Config = run.cfg" << endl;
+   batch << "[Run2]" << endl;
+   batch << "   Config = run.cfg" << endl;
+   batch << "   OutputDataFile = threads.root" << endl;
+   batch << "   Threads = 4" << endl;
+   batch << "   OutputQueueSize = 8" << endl;
+   for (int runNumber = 3; runNumber <= 4; runNumber++) {
+      batch << "[Run" << runNumber << "]" << endl;
+      batch << "   Config = run.cfg" << endl;
+      batch << "   InputDataFile = " << (runNumber == 3 ? "truncated.root" : "particles.root") << endl;
+      batch << "   OutputDataFile = resumed.root" << endl;
+      batch << "   Threads = " << (runNumber == 3 ? 1 : 2) << endl;
+      batch << "   OutputQueueSize = 4" << endl;
+      batch << "   CheckpointParticles = " << kCheckpointParticles << endl;
+   }
+   batch.close();
+   return (run.fail() == false && batch.fail() == false);
+}
+
+//______________________________________________________________________________
+Bool_t RunInChild(const string& batchFileName, const int runNumber, const Bool_t resume) {
+   // -- Perform the run in a process of its own, as simulate_ucn would, so that every run
+   // -- starts from a fresh geometry and ROOT session. Should the run fail, the process exits
+   // -- at once, leaving its output as a crash would.
+   cout.flush();
+   const pid_t pid = fork();
+   if (pid < 0) return kFALSE;
+   if (pid == 0) {
+      Bool_t success = kFALSE;
+      {
+         ConfigFile configFile(batchFileName);
+         RunConfig runConfig(configFile, runNumber);
+         Run run(runConfig);
+         if (run.Initialise(resume) == kFALSE || run.Start() == kFALSE) _exit(EXIT_FAILURE);
+         success = run.Finish();
+      }
+      _exit(success == kTRUE ? EXIT_SUCCESS : EXIT_FAILURE);
+   }
+   int status = 0;
+   if (waitpid(pid, &status, 0) != pid) return kFALSE;
+   return (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+}
+
+//______________________________________________________________________________
+Bool_t ReadOutput(const string& fileName, vector<FinalState>& states, PopulationData& population) {
+   // -- Read every particle's final state from a run's output, ordered by Id, and the
+   // -- populations recorded over the run
+   TFile* file = Analysis::DataFile::OpenRootFile(fileName, "READ");
+   if (file == NULL) return kFALSE;
+   TTree* tree = NULL;
+   file->GetObject("Particles", tree);
+   TBranch* branch = (tree == NULL ? NULL : tree->GetBranch(States::final.c_str()));
+   if (branch == NULL) {
+      file->Close();
+      delete file;
+      return kFALSE;
+   }
+   Particle* particle = NULL;
+   tree->SetBranchAddress(branch->GetName(), &particle);
+   for (Long64_t entry = 0; entry < branch->GetEntries(); entry++) {
+      branch->GetEntry(entry);
+      FinalState state = {particle->Id(), particle->GetState().GetName(), particle->X(), particle->Y(),
+                          particle->Z(), particle->T(), particle->Vx(), particle->Vy(), particle->Vz()};
+      states.push_back(state);
+   }
+   sort(states.begin(), states.end(), CompareIds);
+   PopulationData* saved = NULL;
+   file->GetObject("PopulationData", saved);
+   if (saved != NULL) {
+      population.Add(*saved);
+      delete saved;
+   }
+   delete tree;
+   delete particle;
+   file->Close();
+   delete file;
+   return kTRUE;
+}
+
+//______________________________________________________________________________
+int CompareOutput(const string& name, const string& referenceFileName, const string& fileName) {
+   // -- Count the particles whose final state differs between two runs' outputs, and whether
+   // -- their populations differ
+   vector<FinalState> reference, states;
+   PopulationData referencePopulation, population;
+   if (ReadOutput(referenceFileName, reference, referencePopulation) == kFALSE ||
+       ReadOutput(fileName, states, population) == kFALSE) {
+      cout << name << ": Failed to read output" << endl;
+      return 1;
+   }
+   int failures = 0;
+   if (reference.size() != static_cast<size_t>(kNumParticles) || states.size() != reference.size()) {
+      cout << name << ": Wrote " << states.size() << " particles, the serial run " << reference.size();
+      cout << ", of " << kNumParticles << endl;
+      failures++;
+   }
+   for (size_t i = 0; i < reference.size() && i < states.size(); i++) {
+      if (states[i] == reference[i]) continue;
+      #ifdef VERBOSE
+         cout << name << ": Particle " << reference[i].fId << " differs" << endl;
+      #endif
+      failures++;
+   }
+   if (static_cast<const map<double, map<string, int> >&>(population) !=
+       static_cast<const map<double, map<string, int> >&>(referencePopulation)) {
+      cout << name << ": Populations differ" << endl;
+      failures++;
+   }
+   cout << "--------------------" << endl;
+   cout << name << ": Particles compared: " << reference.size() << ". Differences: " << failures << endl;
+   return failures;
+}
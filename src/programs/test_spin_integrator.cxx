@@ -0,0 +1,214 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "Spin.h"
+#include "SpinIntegrator.h"
+#include "SpinorBatch.h"
+#include "Constants.h"
+#include "Units.h"
+
+#include "TVector3.h"
+#include "TMath.h"
+#include "TRandom.h"
+
+using namespace std;
+
+//#define VERBOSE
+
+//______________________________________________________________________________
+// -- A field constant in time
+class UniformSource : public SpinIntegrator::FieldSource
+{
+private:
+   TVector3 fField;
+public:
+   UniformSource(const TVector3& field) : fField(field) {}
+   virtual TVector3 GetField(const Double_t /*time*/) {return fField;}
+};
+
+//______________________________________________________________________________
+// -- The field seen crossing a linear gradient in its longitudinal component, on top of a
+// -- small transverse field, so that the field passes close to zero half way through
+class GradientSource : public SpinIntegrator::FieldSource
+{
+private:
+   Double_t fTransverse, fRate, fCrossingTime;
+public:
+   GradientSource(const Double_t transverse, const Double_t rate, const Double_t crossingTime)
+      : fTransverse(transverse), fRate(rate), fCrossingTime(crossingTime) {}
+   virtual TVector3 GetField(const Double_t time) {
+      return TVector3(fTransverse, 0., fRate*(time - fCrossingTime));
+   }
+};
+
+TVector3 Polarisation(const Spin& spin);
+TVector3 FixedStep(SpinIntegrator::FieldSource& source, const Double_t duration, const Double_t interval, Int_t& evaluations);
+TVector3 Adaptive(SpinIntegrator::FieldSource& source, const Double_t duration, const Double_t tolerance, Int_t& evaluations, Int_t& rejections);
+void BenchMark(const string& name, SpinIntegrator::FieldSource& source, const Double_t duration, const TVector3& reference, ostream& out);
+int BatchBenchMark(const int numSpinors, const int repetitions);
+
+//______________________________________________________________________________
+int main(int /*argc*/, char ** /*argv*/) {
+   // -- Compare the accuracy and cost of precessing a spin in fixed steps, sampling the field
+   // -- at the middle of each, with the adaptive Magnus integrator, in a uniform field and
+   // -- through a near zero crossing of the field
+   ofstream out("temp/spin_benchmark_data.txt");
+   out << "Field" << "\t" << "Method" << "\t" << "Step Time / Tolerance" << "\t";
+   out << "Field Evaluations" << "\t" << "Rejected Steps" << "\t";
+   out << "Polarisation Error" << "\t" << "Time (s)" << endl;
+   const Double_t duration = 1.0;
+   //-----------------------------------------------------------
+   // -- Uniform field, perpendicular to the initial polarisation. Exact solution is known.
+   const TVector3 uniformField(0., 0., 1.0*Units::uT);
+   UniformSource uniform(uniformField);
+   const Double_t angle = Neutron::gyromag_ratio*uniformField.Mag()*duration;
+   Spin exact;
+   exact.Polarise(TVector3(1.,0.,0.), kTRUE);
+   exact.Rotate(TVector3(0., 0., angle));
+   BenchMark("Uniform", uniform, duration, Polarisation(exact), out);
+   //-----------------------------------------------------------
+   // -- Field sweeping from -1uT to +1uT past a transverse field of 0.1uT. Reference is found
+   // -- with very small fixed steps.
+   GradientSource gradient(0.1*Units::uT, 2.0*Units::uT/duration, duration/2.0);
+   Int_t referenceEvaluations = 0;
+   const TVector3 reference = FixedStep(gradient, duration, 1.0E-7, referenceEvaluations);
+   BenchMark("Gradient", gradient, duration, reference, out);
+   //-----------------------------------------------------------
+   // -- Precess spinors together in a batch, against one at a time
+   int failures = BatchBenchMark(1000, 1000);
+   failures += BatchBenchMark(100000, 10);
+   return (failures == 0 ? 0 : 1);
+}
+
+//______________________________________________________________________________
+void BenchMark(const string& name, SpinIntegrator::FieldSource& source, const Double_t duration, const TVector3& reference, ostream& out) {
+   // -- Integrate the spin with a range of fixed steps and of tolerances, writing the
+   // -- difference in the final polarisation from the reference against the cost of each
+   cout << "--------------------" << endl;
+   cout << name << " field. Reference polarisation: (" << reference.X() << ", ";
+   cout << reference.Y() << ", " << reference.Z() << ")" << endl;
+   cout << setw(10) << "Method" << setw(14) << "Step/Tol" << setw(14) << "Evaluations";
+   cout << setw(12) << "Rejected" << setw(14) << "Error" << setw(12) << "Time (s)" << endl;
+   const Double_t intervals[] = {1.0E-2, 1.0E-3, 1.0E-4, 1.0E-5};
+   for (unsigned int i = 0; i < sizeof(intervals)/sizeof(Double_t); i++) {
+      Int_t evaluations = 0;
+      const clock_t start = clock();
+      const TVector3 result = FixedStep(source, duration, intervals[i], evaluations);
+      const double time = (double)(clock() - start)/CLOCKS_PER_SEC;
+      const Double_t error = (result - reference).Mag();
+      cout << setw(10) << "Fixed" << setw(14) << intervals[i] << setw(14) << evaluations;
+      cout << setw(12) << 0 << setw(14) << error << setw(12) << time << endl;
+      out << name << "\t" << "Fixed" << "\t" << intervals[i] << "\t" << evaluations << "\t" << 0;
+      out << "\t" << error << "\t" << time << endl;
+   }
+   const Double_t tolerances[] = {1.0E-2, 1.0E-4, 1.0E-6, 1.0E-8};
+   for (unsigned int i = 0; i < sizeof(tolerances)/sizeof(Double_t); i++) {
+      Int_t evaluations = 0, rejections = 0;
+      const clock_t start = clock();
+      const TVector3 result = Adaptive(source, duration, tolerances[i], evaluations, rejections);
+      const double time = (double)(clock() - start)/CLOCKS_PER_SEC;
+      const Double_t error = (result - reference).Mag();
+      cout << setw(10) << "Magnus" << setw(14) << tolerances[i] << setw(14) << evaluations;
+      cout << setw(12) << rejections << setw(14) << error << setw(12) << time << endl;
+      out << name << "\t" << "Magnus" << "\t" << tolerances[i] << "\t" << evaluations << "\t";
+      out << rejections << "\t" << error << "\t" << time << endl;
+   }
+}
+
+//______________________________________________________________________________
+TVector3 Polarisation(const Spin& spin) {
+   // -- Expectation value of the spin along each axis
+   return TVector3(2.0*spin.CalculateProbSpinUp(TVector3(1.,0.,0.)) - 1.0,
+                   2.0*spin.CalculateProbSpinUp(TVector3(0.,1.,0.)) - 1.0,
+                   2.0*spin.CalculateProbSpinUp(TVector3(0.,0.,1.)) - 1.0);
+}
+
+//______________________________________________________________________________
+TVector3 FixedStep(SpinIntegrator::FieldSource& source, const Double_t duration, const Double_t interval, Int_t& evaluations) {
+   // -- Precess a spin, initially along x, in steps of 'interval' about the field at the middle
+   // -- of each step, as Particle::Move does without a spin tolerance
+   Spin spin;
+   spin.Polarise(TVector3(1.,0.,0.), kTRUE);
+   const Int_t numSteps = static_cast<Int_t>(ceil(duration/interval - 1.0E-9));
+   for (Int_t step = 0; step < numSteps; step++) {
+      const Double_t start = step*interval;
+      const Double_t length = TMath::Min(interval, duration - start);
+      spin.Precess(source.GetField(start + 0.5*length), length);
+      evaluations++;
+   }
+   #ifdef VERBOSE
+      spin.Print();
+   #endif
+   return Polarisation(spin);
+}
+
+//______________________________________________________________________________
+TVector3 Adaptive(SpinIntegrator::FieldSource& source, const Double_t duration, const Double_t tolerance, Int_t& evaluations, Int_t& rejections) {
+   // -- Precess a spin, initially along x, with the adaptive integrator over the whole duration
+   Spin spin;
+   spin.Polarise(TVector3(1.,0.,0.), kTRUE);
+   SpinIntegrator integrator(tolerance);
+   Double_t time = 0., trialStep = 0.;
+   while (time < duration) {
+      time += integrator.Step(spin, source, time, duration - time, trialStep);
+   }
+   evaluations = integrator.NumEvaluations();
+   rejections = integrator.NumRejections();
+   #ifdef VERBOSE
+      spin.Print();
+   #endif
+   return Polarisation(spin);
+}
+
+//______________________________________________________________________________
+int BatchBenchMark(const int numSpinors, const int repetitions) {
+   // -- Precess 'numSpinors' randomly polarised spins about their own random fields, some of
+   // -- them zero, 'repetitions' times, one at a time with Spin::Precess and together in a
+   // -- SpinorBatch. Time both, and return the number of spins on which they disagree.
+   vector<Spin> spins(numSpinors);
+   vector<Double_t> fieldX(numSpinors), fieldY(numSpinors), fieldZ(numSpinors);
+   for (int i = 0; i < numSpinors; i++) {
+      Double_t x, y, z;
+      gRandom->Sphere(x, y, z, 1.0);
+      spins[i].Polarise(TVector3(x, y, z), gRandom->Rndm() < 0.5);
+      const Double_t field = (i % 10 == 0 ? 0. : gRandom->Uniform(0., 2.0*Units::uT));
+      gRandom->Sphere(fieldX[i], fieldY[i], fieldZ[i], field);
+   }
+   const Double_t precessTime = 0.01;
+   SpinorBatch batch(numSpinors);
+   for (int i = 0; i < numSpinors; i++) {batch.Load(i, spins[i]);}
+   clock_t start = clock();
+   for (int iter = 0; iter < repetitions; iter++) {
+      for (int i = 0; i < numSpinors; i++) {
+         spins[i].Precess(TVector3(fieldX[i], fieldY[i], fieldZ[i]), precessTime);
+      }
+   }
+   const double singleTime = (double)(clock() - start)/CLOCKS_PER_SEC;
+   start = clock();
+   for (int iter = 0; iter < repetitions; iter++) {
+      batch.Precess(&fieldX[0], &fieldY[0], &fieldZ[0], precessTime);
+   }
+   const double batchTime = (double)(clock() - start)/CLOCKS_PER_SEC;
+   int failures = 0;
+   for (int i = 0; i < numSpinors; i++) {
+      Spin batchSpin;
+      batch.Store(i, batchSpin);
+      const Double_t difference = (Polarisation(batchSpin) - Polarisation(spins[i])).Mag();
+      if (difference > 1.0E-9) {
+         #ifdef VERBOSE
+            cout << "Spinor " << i << " differs by " << difference << endl;
+         #endif
+         failures++;
+      }
+   }
+   cout << "--------------------" << endl;
+   cout << "Precessed " << numSpinors << " spinors " << repetitions << " times" << endl;
+   cout << "One at a time: " << singleTime << " seconds. Batched: " << batchTime << " seconds." << endl;
+   cout << "Spinors that differ: " << failures << endl;
+   return failures;
+}